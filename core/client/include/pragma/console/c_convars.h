@@ -33,6 +33,7 @@ REGISTER_CONVAR_CL(debug_render_octree_static_draw, "0", ConVarFlags::Cheat, "Dr
 REGISTER_CONVAR_CL(debug_render_octree_dynamic_draw, "0", ConVarFlags::Cheat, "Draws the octree for dynamic objects.");
 REGISTER_CONVAR_CL(debug_ai_navigation, "0", ConVarFlags::Cheat, "Displays the current navigation path for all NPCs.");
 REGISTER_CONVAR_CL(debug_steam_audio_probe_boxes, "0", ConVarFlags::Cheat, "Displays the sound probe spheres for the current map.");
+REGISTER_CONVAR_CL(cl_physics_interpolation, "1", ConVarFlags::Archive, "If enabled, physically simulated entities are rendered at a pose interpolated between the last two physics states. Only has an effect if sv_physics_simulation_rate is set.");
 REGISTER_CONVAR_CL(cl_fps_decay_factor, "0.8", ConVarFlags::None, "How slowly to decay the previous fps.");
 
 REGISTER_CONVAR_CL(debug_particle_blob_show_neighbor_links, "0", ConVarFlags::Cheat, "Displays the links to adjacent neighbors for blob particles.");
@@ -72,6 +73,8 @@ REGISTER_CONVAR_CL(render_bloom_enabled, "1", ConVarFlags::Archive, "Enables or
 REGISTER_CONVAR_CL(render_bloom_amount, "9", ConVarFlags::Archive, "Number of render passes to use for bloom.");
 REGISTER_CONVAR_CL(render_bloom_resolution, "512", ConVarFlags::Archive, "The width for the bloom texture. The height will be calculated using the aspect ratio of the renderer.");
 
+REGISTER_CONVAR_CL(cl_bvh_animated_refit_threshold, "2", ConVarFlags::Archive, "Animated BVHs are refitted to the current pose instead of being rebuilt, until the SAH cost of the refitted hierarchy exceeds the cost of a fresh build by this factor. 0 = Never rebuild.");
+
 REGISTER_CONVAR_CL(debug_occlusion_culling_freeze_camera, "0", ConVarFlags::None, "Freezes the current camera position in place for occlusion culling.");
 
 #endif
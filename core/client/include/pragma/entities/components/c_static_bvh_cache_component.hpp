@@ -18,8 +18,8 @@ namespace pragma {
 		CStaticBvhCacheComponent(BaseEntity &ent) : BaseStaticBvhCacheComponent(ent) {}
 		virtual void Initialize() override;
 		virtual void InitializeLuaObject(lua_State *l) override;
-		virtual void TestRebuildBvh() override;
 	  private:
+		virtual void CollectEntityMeshes(BaseEntity &ent, std::vector<std::shared_ptr<ModelSubMesh>> &outMeshes) const override;
 		virtual void DoRebuildBvh() override;
 	};
 };
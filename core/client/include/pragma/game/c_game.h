@@ -23,6 +23,7 @@
 #include <pragma/input/inkeys.h>
 #include <mathutil/color.h>
 #include <pragma/util/bulletinfo.h>
+#include <pragma/networking/snapshot_baseline.hpp>
 #include <queue>
 #include <wgui/wihandle.h>
 #include <sharedutils/property/util_property.hpp>
@@ -267,6 +268,11 @@ class DLLCLIENT CGame : public Game {
 	void BuildVMF(const char *map);
 	double &ServerTime();
 	void SetServerTime(double t);
+	// Server time stamp of the most recent snapshot that has been received
+	double GetLastSnapshotTime() const { return m_tLastSnapshot; }
+	// Time between the last snapshot and the world state that is currently displayed. Snapshots are extrapolated
+	// by the latency when they're received, and entities keep being simulated locally after that.
+	double GetLastSnapshotViewOffset();
 	// Entities
 	CBaseEntity *CreateLuaEntity(std::string classname, bool bLoadIfNotExists = false);
 	CBaseEntity *CreateLuaEntity(std::string classname, unsigned int idx, bool bLoadIfNotExists = false);
@@ -496,6 +502,10 @@ class DLLCLIENT CGame : public Game {
 	};
 	MessagePacketTracker m_snapshotTracker;
 	MessagePacketTracker m_userInputTracker;
+	pragma::networking::SnapshotEntityHistory m_snapshotEntityHistory;
+	std::optional<uint8_t> m_acknowledgedSnapshotId {};
+	// Set if a delta base referenced by the server was missing; The server will resend the full entity states
+	bool m_requestFullSnapshot = false;
 	std::vector<double> m_lostPackets;
 	void UpdateLostPackets();
 
@@ -505,6 +515,9 @@ class DLLCLIENT CGame : public Game {
 	std::shared_ptr<pragma::LuaShaderManager> m_luaShaderManager = nullptr;
 	std::shared_ptr<pragma::LuaParticleModifierManager> m_luaParticleModifierManager = nullptr;
 	double m_tServer = 0.0;
+	double m_tLastSnapshot = 0.0;
+	double m_tLastSnapshotReceived = 0.0;
+	float m_lastSnapshotExtrapolation = 0.f;
 	LuaCallbackHandler m_inputCallbackHandler;
 
 	// Shaders
@@ -545,6 +558,8 @@ class DLLCLIENT CGame : public Game {
 
 	void CalcView();
 	void CalcLocalPlayerOrientation();
+	// Marks the render buffers of all entities with an interpolated physics pose as dirty
+	void UpdateInterpolatedPhysicsRenderPoses();
 	Quat m_curFrameRotationModifier = uquat::identity();
 	void UpdateShaderTimeData();
 
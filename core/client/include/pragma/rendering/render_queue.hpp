@@ -15,6 +15,7 @@
 #include <shader/prosper_shader.hpp>
 
 struct RenderPassStats;
+struct RenderQueueBuilderStats;
 namespace pragma {
 	class CCameraComponent;
 	using RenderMeshIndex = uint32_t;
@@ -77,7 +78,13 @@ namespace pragma::rendering {
 		void Add(const std::vector<RenderQueueItem> &items);
 		void Add(const RenderQueueItem &item);
 		void Add(CBaseEntity &ent, RenderMeshIndex meshIdx, CMaterial &mat, prosper::PipelineID pipelineId, const CCameraComponent *optCam = nullptr);
-		void Sort();
+		// Lock-free alternative to Add for worker jobs. The items are kept in a separate batch
+		// and only moved into the queue by MergeStaged (which is called automatically by Sort).
+		void AddStaged(std::vector<RenderQueueItem> &&items);
+		void MergeStaged();
+		// Sorts the items by their sorting keys. Time spent is added to the QueueSort timer of optStats, if specified.
+		void Sort(RenderQueueBuilderStats *optStats = nullptr);
+		std::chrono::nanoseconds GetLastSortDuration() const { return m_lastSortDuration; }
 		void Merge(const RenderQueue &other);
 		const std::string &GetName() const { return m_name; }
 		std::vector<RenderQueueItem> queue;
@@ -89,12 +96,22 @@ namespace pragma::rendering {
 		void WaitForCompletion(RenderPassStats *optStats = nullptr) const;
 		bool IsComplete() const;
 	  private:
+		struct StagedBatch {
+			std::vector<RenderQueueItem> items;
+			StagedBatch *next = nullptr;
+		};
 		RenderQueue(std::string name);
+		void ClearStaged();
+		bool ApplyPreviousSortOrder();
 
 		std::atomic<bool> m_locked = false;
 		mutable std::condition_variable m_threadWaitCondition {};
 		mutable std::mutex m_threadWaitMutex {};
 		std::mutex m_queueMutex {};
+		std::atomic<StagedBatch *> m_stagedBatches = nullptr;
+		// Item order of the last sort, used as a starting point if temporal coherence is enabled
+		std::vector<RenderQueueItemIndex> m_prevSortOrder;
+		std::chrono::nanoseconds m_lastSortDuration {0};
 		std::string m_name;
 	};
 
@@ -9,25 +9,24 @@
 #define __RENDER_QUEUE_WORKER_HPP__
 
 #include "pragma/clientdefinitions.h"
-#include <queue>
+#include <pragma/util/job_system.hpp>
 #include <vector>
-#include <mutex>
-#include <atomic>
-#include <thread>
+#include <memory>
+#include <functional>
 
 struct RenderQueueWorkerStats;
 namespace pragma::rendering {
 	class RenderQueueWorker;
+	// Schedules render queue jobs on the engine's job system. Jobs are submitted in batches to reduce the scheduling overhead.
 	class RenderQueueWorkerManager {
 	  public:
 		using Job = std::function<void(void)>;
-		RenderQueueWorkerManager(uint32_t numWorkers);
+		RenderQueueWorkerManager();
 		~RenderQueueWorkerManager();
 		void WaitForCompletion();
 		void FlushPendingJobs();
 		void AddJob(const Job &job);
 		uint32_t GetWorkerCount() const;
-		void SetWorkerCount(uint32_t numWorkers);
 
 		void SetJobsPerBatchCount(uint32_t numJobsPerBatch) { m_numJobsPerBatch = numJobsPerBatch; }
 		uint32_t GetJobsPerBatchCount() const { return m_numJobsPerBatch; }
@@ -35,33 +34,19 @@ namespace pragma::rendering {
 		RenderQueueWorker &GetWorker(uint32_t i);
 		const RenderQueueWorker &GetWorker(uint32_t i) const;
 	  private:
-		friend RenderQueueWorker;
+		JobSystem &m_jobSystem;
+		// One per job system worker, only used for collecting stats
 		std::vector<std::shared_ptr<RenderQueueWorker>> m_workers;
-		std::queue<Job> m_pendingJobs;
-
-		std::queue<Job> m_readyJobs;
-		std::condition_variable m_readyJobCondition;
-		std::atomic<bool> m_workAvailable = false;
-		std::atomic<uint32_t> m_numThreadsWorking = 0;
-		std::mutex m_readyJobMutex;
-
-		std::condition_variable m_workCompleteCondition;
-		std::mutex m_workCompleteMutex;
+		std::vector<Job> m_pendingJobs;
+		JobCounter m_jobCounter;
 		uint32_t m_numJobsPerBatch = 2;
 	};
 
 	class RenderQueueWorker {
 	  public:
-		RenderQueueWorker(RenderQueueWorkerManager &manager);
-		~RenderQueueWorker();
-
 		void SetStats(RenderQueueWorkerStats *stats);
-		void Stop();
+		RenderQueueWorkerStats *GetStats() { return m_stats; }
 	  private:
-		void StartThread();
-		std::thread m_thread;
-		RenderQueueWorkerManager &m_manager;
-		std::atomic<bool> m_running = true;
 		RenderQueueWorkerStats *m_stats = nullptr;
 	};
 };
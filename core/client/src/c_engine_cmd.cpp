@@ -248,9 +248,10 @@ void CEngine::RegisterConsoleCommands()
 
 	conVarMap.RegisterConVar<uint32_t>("render_instancing_threshold", 2, ConVarFlags::Archive, "The threshold at which to start instancing entities if instanced rendering is enabled (render_instancing_threshold). Must not be lower than 2!", "[2,inf]");
 	conVarMap.RegisterConVar<bool>("render_instancing_enabled", false, ConVarFlags::Archive, "Enables or disables instanced rendering.");
-	conVarMap.RegisterConVar<uint32_t>("render_queue_worker_thread_count", 3, ConVarFlags::Archive, "Number of threads to use for generating render queues.", "[1,10]");
+	conVarMap.RegisterConVar<uint32_t>("render_queue_worker_thread_count", 3, ConVarFlags::None, "Deprecated and has no effect. Render queues are generated by the engine's job system, whose worker count depends on the number of CPU cores.", "[1,10]");
 	conVarMap.RegisterConVar<uint32_t>("render_queue_entities_per_worker_job", 5, ConVarFlags::Archive, "Number of entities for each job processed by a worker thread.", "[1,50]");
 	conVarMap.RegisterConVar<uint32_t>("render_queue_worker_jobs_per_batch", 2, ConVarFlags::Archive, "Number of worker jobs to accumulate in a batch before assigning a worker.", "[0,10]");
+	conVarMap.RegisterConVar<bool>("render_queue_sort_temporal_coherence", false, ConVarFlags::Archive, "If enabled, render queues will start sorting from the item order of the previous frame, which is faster if the queue contents rarely change.");
 
 	conVarMap.RegisterConCommand(
 	  "debug_textures",
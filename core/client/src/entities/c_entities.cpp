@@ -78,6 +78,7 @@ void CGame::RemoveEntity(BaseEntity *ent)
 	debug::get_domain().EndTask();
 #endif
 	if(idx > 0) {
+		m_snapshotEntityHistory.RemoveEntity(idx);
 		m_shEnts[idx] = NULL;
 		m_shBaseEnts[idx] = NULL;
 		if(idx == m_shEnts.size() - 1) {
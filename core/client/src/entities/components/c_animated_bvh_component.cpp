@@ -79,7 +79,9 @@ void CAnimatedBvhComponent::RebuildTemporaryBvhData()
 		return;
 	auto &renderMeshes = mdlC->GetRenderMeshes();
 	Clear();
-	m_tmpBvhData = BaseBvhComponent::RebuildBvh(renderMeshes);
+	// Use the prebuilt hierarchy of the model if there is one
+	auto &mdl = GetEntity().GetModel();
+	m_tmpBvhData = mdl ? BaseBvhComponent::RebuildBvh(*mdl, renderMeshes) : BaseBvhComponent::RebuildBvh(renderMeshes);
 }
 
 void CAnimatedBvhComponent::SetUpdateLazily(bool updateLazily) { m_updateLazily = updateLazily; }
@@ -210,7 +212,8 @@ void CAnimatedBvhComponent::RebuildAnimatedBvh(bool force)
 	m_animatedBvhData.transformedTris.resize(numIndices / 3);
 
 	auto bvhC = GetEntity().GetComponent<CBvhComponent>();
-	auto finalize = [this, bvhC, &animBvhData, &renderMeshes]() mutable -> pragma::ThreadPool::ResultHandler {
+	auto refitThreshold = c_game->GetConVarFloat("cl_bvh_animated_refit_threshold");
+	auto finalize = [this, bvhC, &animBvhData, &renderMeshes, refitThreshold]() mutable -> pragma::ThreadPool::ResultHandler {
 		size_t indexOffset = 0;
 		uint32_t meshIdx = 0;
 		for(auto &renderMesh : renderMeshes) {
@@ -223,8 +226,8 @@ void CAnimatedBvhComponent::RebuildAnimatedBvh(bool force)
 			++meshIdx;
 		}
 
-		// Swap Bvh
-		CBvhComponent::SetVertexData(*m_tmpBvhData, m_animatedBvhData.transformedTris);
+		// Refit the back buffer to the new pose (or rebuild it if the hierarchy has degraded too much), then swap
+		CBvhComponent::RefitVertexData(*m_tmpBvhData, m_animatedBvhData.transformedTris, refitThreshold);
 		auto oldBvh = bvhC->SetBvhData(m_tmpBvhData);
 		m_tmpBvhData = oldBvh;
 
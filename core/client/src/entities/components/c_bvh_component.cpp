@@ -71,5 +71,7 @@ void CBvhComponent::DoRebuildBvh()
 	if(!mdlC)
 		return;
 	auto &renderMeshes = mdlC->GetRenderMeshes();
-	m_bvhData = BaseBvhComponent::RebuildBvh(renderMeshes);
+	// Use the prebuilt hierarchy of the model if there is one
+	auto &mdl = GetEntity().GetModel();
+	m_bvhData = mdl ? BaseBvhComponent::RebuildBvh(*mdl, renderMeshes) : BaseBvhComponent::RebuildBvh(renderMeshes);
 }
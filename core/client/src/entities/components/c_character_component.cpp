@@ -62,7 +62,7 @@ void CCharacterComponent::Initialize()
 			if(anim != nullptr && anim->HasFlag(FAnim::Loop) && (moveSpeed.x > 0.f || moveSpeed.y > 0.f)) //IsMoving())
 			{
 				auto anim = hMdl->GetAnimation(hMdl->SelectFirstAnimation(animComponent->TranslateActivity(Activity::Idle)));
-				auto frame = anim ? anim->GetFrame(0) : nullptr;
+				auto frame = anim ? anim->ReadFrame(0) : nullptr;
 				if(frame != nullptr) {
 					auto blendScale = GetMovementBlendScale();
 					auto &dstPoses = frame->GetBoneTransforms();
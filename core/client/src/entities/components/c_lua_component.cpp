@@ -19,10 +19,7 @@ void CLuaBaseEntityComponent::ReceiveData(NetPacket &packet)
 	if(m_networkedMemberInfo != nullptr) {
 		auto &members = GetMembers();
 		for(auto idx : m_networkedMemberInfo->networkedMembers) {
-			auto &member = members.at(idx);
-			std::any value;
-			Lua::ReadAny(packet, detail::member_type_to_util_type(member.type), value);
-			SetMemberValue(member, value);
+			ReadMemberValue(packet, members.at(idx));
 		}
 	}
 	CallLuaMethod<void, NetPacket>("ReceiveData", packet);
@@ -36,10 +33,7 @@ Bool CLuaBaseEntityComponent::ReceiveNetEvent(pragma::NetEventId eventId, NetPac
 			return true;
 		}
 		auto memberIdx = m_networkedMemberInfo->networkedMembers.at(nwIdx);
-		auto &member = GetMembers().at(memberIdx);
-		std::any value;
-		Lua::ReadAny(packet, detail::member_type_to_util_type(member.type), value);
-		SetMemberValue(member, value);
+		ReadMemberValue(packet, GetMembers().at(memberIdx));
 		return true;
 	}
 
@@ -57,10 +51,7 @@ void CLuaBaseEntityComponent::ReceiveSnapshotData(NetPacket &packet)
 	auto &members = GetMembers();
 	if(m_networkedMemberInfo != nullptr) {
 		for(auto idx : m_networkedMemberInfo->snapshotMembers) {
-			auto &member = members.at(idx);
-			std::any value;
-			Lua::ReadAny(packet, detail::member_type_to_util_type(member.type), value);
-			SetMemberValue(member, value);
+			ReadMemberValue(packet, members.at(idx));
 		}
 	}
 	CallLuaMethod<void, NetPacket>("ReceiveSnapshotData", packet);
@@ -24,6 +24,7 @@
 #include "pragma/lua/c_lentity_handles.hpp"
 #include "pragma/model/c_vertex_buffer_data.hpp"
 #include "pragma/model/c_modelmesh.h"
+#include "pragma/console/c_cvar.h"
 #include <pragma/debug/intel_vtune.hpp>
 #include <pragma/lua/classes/ldef_mat4.h>
 #include <pragma/model/model.h>
@@ -445,6 +446,7 @@ GameShaderSpecialization CRenderComponent::GetShaderPipelineSpecialization() con
 		return GameShaderSpecialization::Animated;
 	return GameShaderSpecialization::Generic;
 }
+static auto cvPhysicsInterpolation = GetClientConVar("cl_physics_interpolation");
 void CRenderComponent::UpdateMatrices()
 {
 	auto &ent = GetEntity();
@@ -453,8 +455,17 @@ void CRenderComponent::UpdateMatrices()
 	auto pPhysComponent = ent.GetPhysicsComponent();
 	umath::ScaledTransform pose {};
 	if(pPhysComponent == nullptr || pPhysComponent->GetPhysicsType() != PHYSICSTYPE::SOFTBODY) {
-		pose.SetOrigin(pPhysComponent != nullptr ? pPhysComponent->GetOrigin() : pTrComponent != nullptr ? pTrComponent->GetPosition() : Vector3 {});
-		pose.SetRotation(orientation);
+		std::optional<umath::Transform> interpolatedPose {};
+		if(pPhysComponent != nullptr && cvPhysicsInterpolation->GetBool() && c_game->IsPhysicsInterpolationEnabled())
+			interpolatedPose = pPhysComponent->GetInterpolatedPhysicsPose(c_game->GetPhysicsInterpolationFactor());
+		if(interpolatedPose.has_value()) {
+			pose.SetOrigin(interpolatedPose->GetOrigin());
+			pose.SetRotation(interpolatedPose->GetRotation());
+		}
+		else {
+			pose.SetOrigin(pPhysComponent != nullptr ? pPhysComponent->GetOrigin() : pTrComponent != nullptr ? pTrComponent->GetPosition() : Vector3 {});
+			pose.SetRotation(orientation);
+		}
 	}
 	if(pTrComponent != nullptr)
 		pose.SetScale(pTrComponent->GetScale());
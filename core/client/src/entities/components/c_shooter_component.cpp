@@ -30,8 +30,12 @@ void CShooterComponent::FireBullets(const BulletInfo &bulletInfo, const Vector3
 
 	auto numBullets = destPositions.size();
 	NetPacket p {};
-	if(bTransmitToServer == true)
+	if(bTransmitToServer == true) {
+		// Used by the server to rewind the hitboxes to the state we're currently seeing
+		p->Write<double>(c_game->GetLastSnapshotTime());
+		p->Write<float>(static_cast<float>(c_game->GetLastSnapshotViewOffset()));
 		p->Write<uint32_t>(static_cast<uint32_t>(numBullets));
+	}
 	TraceData data;
 	GetBulletTraceData(bulletInfo, data);
 	outHitTargets.reserve(numBullets);
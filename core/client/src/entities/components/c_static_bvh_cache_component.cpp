@@ -24,29 +24,13 @@ void CStaticBvhCacheComponent::Initialize() { BaseBvhComponent::Initialize(); }
 
 void CStaticBvhCacheComponent::DoRebuildBvh() {}
 
-void CStaticBvhCacheComponent::TestRebuildBvh()
+void CStaticBvhCacheComponent::CollectEntityMeshes(BaseEntity &ent, std::vector<std::shared_ptr<ModelSubMesh>> &outMeshes) const
 {
-	std::vector<std::shared_ptr<ModelSubMesh>> meshes;
-	std::vector<BaseEntity *> meshToEntity;
-	std::vector<umath::ScaledTransform> meshPoses;
-	for(auto *c : m_entities) {
-		auto &ent = c->GetEntity();
-		auto *mdlC = static_cast<CModelComponent *>(ent.GetModelComponent());
-		if(!mdlC)
-			continue;
-		auto &renderMeshes = mdlC->GetRenderMeshes();
-		if(meshes.size() == meshes.capacity()) {
-			meshes.reserve(meshes.size() * 1.5 + renderMeshes.size() + 100);
-			meshToEntity.reserve(meshes.size());
-			meshPoses.reserve(meshes.size());
-		}
-		auto &pose = ent.GetPose();
-		for(auto &mesh : renderMeshes) {
-			meshes.push_back(mesh);
-			meshToEntity.push_back(&ent);
-			meshPoses.push_back(pose);
-		}
-	}
-
-	Build(std::move(meshes), std::move(meshToEntity), std::move(meshPoses));
+	auto *mdlC = static_cast<CModelComponent *>(ent.GetModelComponent());
+	if(!mdlC)
+		return;
+	auto &renderMeshes = mdlC->GetRenderMeshes();
+	outMeshes.reserve(outMeshes.size() + renderMeshes.size());
+	for(auto &mesh : renderMeshes)
+		outMeshes.push_back(mesh);
 }
@@ -384,7 +384,7 @@ bool CDecalComponent::ApplyDecal()
 			return;
 		}
 		for(auto idx : bvhIntersectInfo.primitives) {
-			auto *meshInfo = bvhC.FindPrimitiveMeshInfo(idx);
+			auto *meshInfo = bvhC.FindPrimitiveMeshInfo(bvhIntersectInfo, idx);
 			if(!meshInfo)
 				continue;
 			if(coveredMeshes.find(meshInfo->mesh.get()) != coveredMeshes.end())
@@ -158,7 +158,6 @@ namespace pragma::rendering {
 	class LightingStageRenderProcessor;
 	class DepthStageRenderProcessor;
 };
-static auto cvWorkerThreadCount = GetClientConVar("render_queue_worker_thread_count");
 CGame::CGame(NetworkState *state)
     : Game(state), m_tServer(0), m_renderScene(util::TWeakSharedHandle<pragma::CSceneComponent> {}), m_matOverride(NULL), m_colScale(1, 1, 1, 1),
       //m_shaderOverride(NULL), // prosper TODO
@@ -271,7 +270,7 @@ CGame::CGame(NetworkState *state)
 	});
 
 	m_renderQueueBuilder = std::make_unique<pragma::rendering::RenderQueueBuilder>();
-	m_renderQueueWorkerManager = std::make_unique<pragma::rendering::RenderQueueWorkerManager>(umath::clamp(cvWorkerThreadCount->GetInt(), 1, 20));
+	m_renderQueueWorkerManager = std::make_unique<pragma::rendering::RenderQueueWorkerManager>();
 
 	auto &texManager = static_cast<msys::CMaterialManager &>(static_cast<ClientState *>(GetNetworkState())->GetMaterialManager()).GetTextureManager();
 	for(auto &tex : g_requiredGameTextures) {
@@ -381,10 +380,7 @@ REGISTER_CONVAR_CALLBACK_CL(render_dynamic_shadows_enabled, cmd_render_ibl_enabl
 
 static void cmd_render_queue_worker_thread_count(NetworkState *, ConVar *, int, int val)
 {
-	if(c_game == nullptr)
-		return;
-	val = umath::clamp(val, 1, 20);
-	c_game->GetRenderQueueWorkerManager().SetWorkerCount(val);
+	Con::cwar << "render_queue_worker_thread_count is deprecated and has no effect. Render queues are generated by the engine's job system, which uses " << c_engine->GetJobSystem().GetWorkerCount() << " worker threads." << Con::endl;
 }
 REGISTER_CONVAR_CALLBACK_CL(render_queue_worker_thread_count, cmd_render_queue_worker_thread_count);
 
@@ -999,9 +995,25 @@ void CGame::ReloadRenderFrameBuffer()
 		m_scene->ReloadRenderTarget(m_scene->GetWidth(), m_scene->GetHeight());
 }
 
+static CVar cvPhysicsInterpolation = GetClientConVar("cl_physics_interpolation");
+void CGame::UpdateInterpolatedPhysicsRenderPoses()
+{
+	if(!cvPhysicsInterpolation->GetBool() || !IsPhysicsInterpolationEnabled())
+		return;
+	// The interpolated pose changes every frame, even if no physics step has occurred
+	for(auto &hPhysC : GetAwakePhysicsComponents()) {
+		if(hPhysC.expired())
+			continue;
+		auto *renderC = static_cast<CBaseEntity &>(hPhysC->GetEntity()).GetRenderComponent();
+		if(renderC)
+			renderC->SetRenderBufferDirty();
+	}
+}
+
 void CGame::Think()
 {
 	Game::Think();
+	UpdateInterpolatedPhysicsRenderPoses();
 	auto *scene = GetRenderScene();
 	auto *cam = GetPrimaryCamera();
 
@@ -1355,6 +1367,10 @@ void CGame::SendUserInput()
 		for(auto v : actionValues)
 			p->Write<float>(pl->GetActionInputAxisMagnitude(static_cast<Action>(v)));
 	}
+	p->Write<bool>(m_acknowledgedSnapshotId.has_value());
+	if(m_acknowledgedSnapshotId.has_value())
+		p->Write<uint8_t>(*m_acknowledgedSnapshotId);
+	p->Write<bool>(m_requestFullSnapshot);
 	client->SendPacket("userinput", p, pragma::networking::Protocol::FastUnreliable);
 }
 
@@ -1376,6 +1392,8 @@ uint32_t CGame::GetLostPacketCount()
 	return static_cast<uint32_t>(m_lostPackets.size());
 }
 
+double CGame::GetLastSnapshotViewOffset() { return m_lastSnapshotExtrapolation + umath::max(RealTime() - m_tLastSnapshotReceived, 0.0); }
+
 #include <pragma/physics/controller.hpp>
 void CGame::ReceiveSnapshot(NetPacket &packet)
 {
@@ -1393,19 +1411,67 @@ void CGame::ReceiveSnapshot(NetPacket &packet)
 	m_snapshotTracker.messageTimestamps[snapshotId] = m_tServer;
 	if(m_snapshotTracker.IsMessageInOrder(snapshotId) == false)
 		return; // Old snapshot; Just skip it (We're already received a newer snapshot, this one's out of order)
+	m_tLastSnapshot = m_tServer;
+	m_tLastSnapshotReceived = t;
+	m_lastSnapshotExtrapolation = tDelta;
+
+	auto useDeltaCompression = packet->Read<bool>();
+	// States decoded from this snapshot. They're added to the history once the snapshot has been
+	// processed, since the states of the history may still be referenced as delta base until then.
+	std::vector<std::pair<uint32_t, pragma::networking::SnapshotEntityState>> receivedStates;
+	if(useDeltaCompression == false) {
+		m_snapshotEntityHistory.Clear();
+		m_acknowledgedSnapshotId = {};
+		m_requestFullSnapshot = false;
+	}
+	auto missingDeltaBase = false;
 	m_snapshotTracker.CheckMessages(snapshotId, m_lostPackets, t);
 
 	//std::cout<<"Received snapshot with "<<(m_tServer -tOld)<<" time difference to last snapshot"<<std::endl;
 	const auto maxCorrectionDistance = umath::pow2(10.f);
 	unsigned int numEnts = packet->Read<unsigned int>();
 	for(unsigned int i = 0; i < numEnts; i++) {
-		CBaseEntity *ent = static_cast<CBaseEntity *>(nwm::read_entity(packet));
-		Vector3 pos = nwm::read_vector(packet);
-		Vector3 vel = nwm::read_vector(packet);
-		Vector3 angVel = nwm::read_vector(packet);
-		auto orientation = nwm::read_quat(packet);
+		Vector3 pos;
+		Vector3 vel;
+		Vector3 angVel;
+		Quat orientation;
+		pragma::networking::SnapshotEntityState *entState = nullptr;
+		const pragma::networking::SnapshotEntityState *baseEntState = nullptr;
+		CBaseEntity *ent = nullptr;
+		// If the base state isn't in the history anymore, the delta still has to be read, but the decoded state is invalid
+		auto baseMissing = false;
+		if(useDeltaCompression) {
+			auto entIdx = packet->Read<uint32_t>();
+			packet->SetOffset(packet->GetOffset() - sizeof(entIdx));
+			ent = static_cast<CBaseEntity *>(nwm::read_entity(packet));
+			receivedStates.push_back({entIdx, {}});
+			entState = &receivedStates.back().second;
+			// The server references the last state of the entity we've acknowledged, or none if the full state is transmitted
+			auto baseAge = packet->Read<uint8_t>();
+			if(baseAge > 0) {
+				baseEntState = m_snapshotEntityHistory.Find(entIdx, static_cast<uint8_t>(snapshotId - baseAge));
+				baseMissing = (baseEntState == nullptr);
+			}
+		}
+		else
+			ent = static_cast<CBaseEntity *>(nwm::read_entity(packet));
+		if(entState) {
+			entState->state = pragma::networking::SnapshotObjectState::ReadDelta(packet, baseEntState ? &baseEntState->state : nullptr);
+			pos = entState->state.GetPosition();
+			vel = entState->state.GetVelocity();
+			angVel = entState->state.GetAngularVelocity();
+			orientation = entState->state.GetRotation();
+		}
+		else {
+			pos = nwm::read_vector(packet);
+			vel = nwm::read_vector(packet);
+			angVel = nwm::read_vector(packet);
+			orientation = nwm::read_quat(packet);
+		}
 		auto entDataSize = packet->Read<UInt8>();
-		if(ent != NULL) {
+		if(ent != NULL && baseMissing)
+			ent->ReceiveSnapshotData(packet);
+		else if(ent != NULL) {
 			pos += vel * tDelta;
 			if(uvec::length_sqr(angVel) > 0.0)
 				orientation = uquat::create(EulerAngles(umath::rad_to_deg(angVel.x), umath::rad_to_deg(angVel.y), umath::rad_to_deg(angVel.z)) * tDelta) * orientation; // TODO: Check if this is correct
@@ -1448,17 +1514,36 @@ void CGame::ReceiveSnapshot(NetPacket &packet)
 		auto flags = packet->Read<pragma::SnapshotFlags>();
 		if((flags & pragma::SnapshotFlags::PhysicsData) != pragma::SnapshotFlags::None) {
 			auto numObjs = packet->Read<uint8_t>();
-			if(ent != NULL) {
+			struct PhysObjState {
+				Vector3 pos;
+				Quat rot;
+				Vector3 vel;
+				Vector3 angVel;
+			};
+			std::vector<PhysObjState> objStates;
+			objStates.reserve(numObjs);
+			for(auto i = decltype(numObjs) {0}; i < numObjs; ++i) {
+				objStates.push_back({});
+				auto &objState = objStates.back();
+				if(entState) {
+					auto state = pragma::networking::SnapshotObjectState::ReadDelta(packet, baseEntState ? baseEntState->FindPhysicsObject(i) : nullptr);
+					entState->physicsObjects.push_back(state);
+					objState = {state.GetPosition(), state.GetRotation(), state.GetVelocity(), state.GetAngularVelocity()};
+					continue;
+				}
+				objState.pos = packet->Read<Vector3>();
+				objState.rot = packet->Read<Quat>();
+				objState.vel = packet->Read<Vector3>();
+				objState.angVel = packet->Read<Vector3>();
+			}
+			if(ent != NULL && !baseMissing) {
 				auto pPhysComponent = ent->GetPhysicsComponent();
 				PhysObj *physObj = pPhysComponent != nullptr ? pPhysComponent->GetPhysicsObject() : nullptr;
 				if(physObj != NULL && !physObj->IsStatic()) {
 					auto colObjs = physObj->GetCollisionObjects();
 					auto numActualObjs = colObjs.size();
 					for(auto i = decltype(numObjs) {0}; i < numObjs; ++i) {
-						auto pos = packet->Read<Vector3>();
-						auto rot = packet->Read<Quat>();
-						auto vel = packet->Read<Vector3>();
-						auto angVel = packet->Read<Vector3>();
+						auto [pos, rot, vel, angVel] = objStates[i];
 						if(physObj->IsController()) {
 							auto *physController = static_cast<ControllerPhysObj *>(physObj);
 							//physController->SetPosition(pos);
@@ -1494,11 +1579,7 @@ void CGame::ReceiveSnapshot(NetPacket &packet)
 						}
 					}
 				}
-				else
-					packet->SetOffset(packet->GetOffset() + numObjs * (sizeof(Vector3) * 3 + sizeof(Quat)));
 			}
-			else
-				packet->SetOffset(packet->GetOffset() + numObjs * (sizeof(Vector3) * 3 + sizeof(Quat)));
 		}
 
 		if((flags & pragma::SnapshotFlags::ComponentData) != pragma::SnapshotFlags::None) {
@@ -1525,6 +1606,12 @@ void CGame::ReceiveSnapshot(NetPacket &packet)
 				packet->SetOffset(componentEndOffset);
 			}
 		}
+
+		if(baseMissing) {
+			// Keep the entity's current state until the server has sent its full state
+			receivedStates.pop_back();
+			missingDeltaBase = true;
+		}
 	}
 
 	unsigned char numPlayers = packet->Read<unsigned char>();
@@ -1554,6 +1641,15 @@ void CGame::ReceiveSnapshot(NetPacket &packet)
 			charComponent->SetViewOrientation(orientation);
 		}
 	}
+	if(useDeltaCompression) {
+		for(auto &[entIdx, entState] : receivedStates)
+			m_snapshotEntityHistory.Store(entIdx, snapshotId, std::move(entState));
+		// A snapshot with missing delta bases is not acknowledged, since the server would use the states we've
+		// discarded as the next delta base
+		if(missingDeltaBase == false)
+			m_acknowledgedSnapshotId = snapshotId;
+		m_requestFullSnapshot = missingDeltaBase;
+	}
 }
 
 static void set_action_input(Action action, bool b, bool bKeepMagnitude, const float *inMagnitude = nullptr)
@@ -11,6 +11,7 @@
 #include "pragma/rendering/shaders/world/c_shader_textured.hpp"
 #include "pragma/entities/components/c_render_component.hpp"
 #include "pragma/entities/environment/c_env_camera.h"
+#include "pragma/console/c_cvar.h"
 #include <cmaterial.h>
 
 using namespace pragma::rendering;
@@ -75,7 +76,7 @@ std::shared_ptr<RenderQueue> RenderQueue::Create(std::string name) { return std:
 
 RenderQueue::RenderQueue(std::string name) : m_name {std::move(name)} {}
 
-RenderQueue::~RenderQueue() {}
+RenderQueue::~RenderQueue() { ClearStaged(); }
 
 void RenderQueue::Reserve()
 {
@@ -87,6 +88,7 @@ void RenderQueue::Reserve()
 }
 void RenderQueue::Clear()
 {
+	ClearStaged();
 	queue.clear();
 	sortedItemIndices.clear();
 }
@@ -111,12 +113,154 @@ void RenderQueue::Add(const std::vector<RenderQueueItem> &items)
 	}
 	m_queueMutex.unlock();
 }
-void RenderQueue::Sort()
+void RenderQueue::AddStaged(std::vector<RenderQueueItem> &&items)
 {
-	std::sort(sortedItemIndices.begin(), sortedItemIndices.end(), [](const RenderQueueItemSortPair &a, const RenderQueueItemSortPair &b) {
-		static_assert(sizeof(decltype(a.second)) == sizeof(uint64_t));
-		return *reinterpret_cast<const uint64_t *>(&a.second) < *reinterpret_cast<const uint64_t *>(&b.second);
-	});
+	if(items.empty())
+		return;
+	auto *batch = new StagedBatch {std::move(items)};
+	batch->next = m_stagedBatches.load(std::memory_order_relaxed);
+	while(!m_stagedBatches.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed))
+		;
+}
+void RenderQueue::MergeStaged()
+{
+	auto *head = m_stagedBatches.exchange(nullptr, std::memory_order_acquire);
+	if(!head)
+		return;
+	size_t numItems = 0;
+	for(auto *batch = head; batch; batch = batch->next)
+		numItems += batch->items.size();
+	auto offset = queue.size();
+	queue.resize(offset + numItems);
+	sortedItemIndices.resize(offset + numItems);
+	while(head) {
+		for(auto &item : head->items) {
+			queue[offset] = item;
+			sortedItemIndices[offset] = {static_cast<RenderQueueItemIndex>(offset), item.sortingKey};
+			++offset;
+		}
+		auto *next = head->next;
+		delete head;
+		head = next;
+	}
+}
+void RenderQueue::ClearStaged()
+{
+	auto *head = m_stagedBatches.exchange(nullptr, std::memory_order_acquire);
+	while(head) {
+		auto *next = head->next;
+		delete head;
+		head = next;
+	}
+}
+static auto cvSortTemporalCoherence = GetClientConVar("render_queue_sort_temporal_coherence");
+// Below this item count a comparison sort is faster than the radix sort passes
+static constexpr size_t RADIX_SORT_THRESHOLD = 256;
+static uint64_t get_sort_key(const RenderQueueItemSortPair &pair)
+{
+	static_assert(sizeof(decltype(pair.second)) == sizeof(uint64_t));
+	return *reinterpret_cast<const uint64_t *>(&pair.second);
+}
+static void radix_sort(RenderQueueSortList &items)
+{
+	// LSD radix sort with 8-bit digits. All histograms are generated in a single pass and
+	// passes where all keys share the same digit (e.g. the unused distance bits of opaque keys) are skipped.
+	constexpr uint32_t NUM_PASSES = sizeof(uint64_t);
+	constexpr uint32_t NUM_BUCKETS = 256;
+	std::array<std::array<uint32_t, NUM_BUCKETS>, NUM_PASSES> histograms {};
+	for(auto &item : items) {
+		auto key = get_sort_key(item);
+		for(auto pass = decltype(NUM_PASSES) {0u}; pass < NUM_PASSES; ++pass)
+			++histograms[pass][(key >> (pass * 8)) & 0xFF];
+	}
+	thread_local RenderQueueSortList tmp;
+	tmp.resize(items.size());
+	auto *src = &items;
+	auto *dst = &tmp;
+	for(auto pass = decltype(NUM_PASSES) {0u}; pass < NUM_PASSES; ++pass) {
+		auto &histogram = histograms[pass];
+		auto firstDigit = (get_sort_key(src->front()) >> (pass * 8)) & 0xFF;
+		if(histogram[firstDigit] == src->size())
+			continue;
+		std::array<uint32_t, NUM_BUCKETS> offsets;
+		uint32_t offset = 0;
+		for(auto i = decltype(NUM_BUCKETS) {0u}; i < NUM_BUCKETS; ++i) {
+			offsets[i] = offset;
+			offset += histogram[i];
+		}
+		for(auto &item : *src)
+			(*dst)[offsets[(get_sort_key(item) >> (pass * 8)) & 0xFF]++] = item;
+		std::swap(src, dst);
+	}
+	if(src != &items)
+		items.swap(tmp);
+}
+// Insertion sort that gives up once the number of moved items exceeds the budget. Returns false in that case,
+// the items are still a valid permutation, but not sorted.
+static bool insertion_sort(RenderQueueSortList &items, size_t maxMoves)
+{
+	size_t numMoves = 0;
+	for(auto i = static_cast<size_t>(1); i < items.size(); ++i) {
+		auto key = get_sort_key(items[i]);
+		if(get_sort_key(items[i - 1]) <= key)
+			continue;
+		auto item = items[i];
+		auto j = i;
+		while(j > 0 && get_sort_key(items[j - 1]) > key) {
+			items[j] = items[j - 1];
+			--j;
+			if(++numMoves > maxMoves) {
+				items[j] = item;
+				return false;
+			}
+		}
+		items[j] = item;
+	}
+	return true;
+}
+bool RenderQueue::ApplyPreviousSortOrder()
+{
+	auto n = sortedItemIndices.size();
+	if(m_prevSortOrder.size() != n)
+		return false;
+	// The previous order is only meaningful if the items were added in the same order as last frame,
+	// which is usually the case for queues that are built on a single thread. If the order has changed too much, the fix-up
+	// pass will bail out early.
+	thread_local RenderQueueSortList tmp;
+	tmp.resize(n);
+	for(auto i = decltype(n) {0u}; i < n; ++i) {
+		auto idx = m_prevSortOrder[i];
+		if(idx >= n)
+			return false;
+		tmp[i] = sortedItemIndices[idx];
+	}
+	sortedItemIndices.swap(tmp);
+	return true;
+}
+void RenderQueue::Sort(RenderQueueBuilderStats *optStats)
+{
+	auto t = std::chrono::steady_clock::now();
+	MergeStaged();
+	auto n = sortedItemIndices.size();
+	auto sorted = false;
+	if(cvSortTemporalCoherence->GetBool() && ApplyPreviousSortOrder())
+		sorted = insertion_sort(sortedItemIndices, n / 8);
+	if(!sorted) {
+		if(n < RADIX_SORT_THRESHOLD)
+			std::sort(sortedItemIndices.begin(), sortedItemIndices.end(), [](const RenderQueueItemSortPair &a, const RenderQueueItemSortPair &b) { return get_sort_key(a) < get_sort_key(b); });
+		else
+			radix_sort(sortedItemIndices);
+	}
+	if(cvSortTemporalCoherence->GetBool()) {
+		m_prevSortOrder.resize(n);
+		for(auto i = decltype(n) {0u}; i < n; ++i)
+			m_prevSortOrder[i] = sortedItemIndices[i].first;
+	}
+	else
+		m_prevSortOrder.clear();
+	m_lastSortDuration = std::chrono::steady_clock::now() - t;
+	if(optStats)
+		(*optStats)->AddTime(RenderQueueBuilderStats::Timer::QueueSort, m_lastSortDuration);
 }
 
 void RenderQueue::Merge(const RenderQueue &other)
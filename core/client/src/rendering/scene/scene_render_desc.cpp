@@ -255,6 +255,145 @@ bool SceneRenderDesc::ShouldCull(pragma::CRenderComponent &renderC, pragma::Rend
 bool SceneRenderDesc::ShouldCull(const Vector3 &min, const Vector3 &max, const std::vector<umath::Plane> &frustumPlanes) { return umath::intersection::aabb_in_plane_mesh(min, max, frustumPlanes) == umath::intersection::Intersect::Outside; }
 
 static auto cvEntitiesPerJob = GetClientConVar("render_queue_entities_per_worker_job");
+namespace {
+	// Parameters shared by all octree jobs of a single collection pass. Everything that may go out of
+	// scope before the jobs have completed is held by value.
+	struct OctreeCollectInfo {
+		pragma::CRasterizationRendererComponent *optRasterizationRenderer = nullptr;
+		RenderFlags renderFlags;
+		const pragma::CSceneComponent *scene = nullptr;
+		const pragma::CCameraComponent *cam = nullptr;
+		Mat4 vp;
+		pragma::rendering::RenderMask renderMask;
+		std::function<pragma::rendering::RenderQueue *(pragma::rendering::SceneRenderPass, bool)> getRenderQueue;
+		std::function<bool(const Vector3 &, const Vector3 &)> fShouldCull;
+		std::vector<util::BSPTree *> bspTrees;
+		std::vector<util::BSPTree::Node *> bspLeafNodes;
+		int32_t lodBias = 0;
+		std::function<bool(CBaseEntity &, const pragma::CSceneComponent &, RenderFlags)> shouldConsiderEntity;
+		pragma::GameShaderSpecializationConstantFlag baseSpecializationFlags;
+	};
+	// Items collected by a single job, grouped by target queue. The number of target queues per job is
+	// very small, so a linear lookup is cheaper than a map.
+	using RenderQueueItemBuffer = std::vector<std::pair<pragma::rendering::RenderQueue *, std::vector<pragma::rendering::RenderQueueItem>>>;
+};
+static bool is_octree_node_visible(const OctreeCollectInfo &info, const OcclusionOctree<CBaseEntity *>::Node &node)
+{
+	auto &nodeBounds = node.GetWorldBounds();
+	if(info.fShouldCull && info.fShouldCull(nodeBounds.first, nodeBounds.second))
+		return false;
+	if(info.bspLeafNodes.empty())
+		return true;
+	for(auto i = decltype(info.bspLeafNodes.size()) {0u}; i < info.bspLeafNodes.size(); ++i) {
+		auto *leafNode = info.bspLeafNodes[i];
+		if(umath::intersection::aabb_aabb(nodeBounds.first, nodeBounds.second, leafNode->minVisible, leafNode->maxVisible) == umath::intersection::Intersect::Outside)
+			continue;
+		if(info.bspTrees[i]->IsAabbVisibleInCluster(nodeBounds.first, nodeBounds.second, leafNode->cluster) == false)
+			continue;
+		return true;
+	}
+	return false;
+}
+static void collect_octree_node_objects(const OctreeCollectInfo &info, const std::vector<CBaseEntity *> &objs, size_t iStart, size_t iEnd, RenderQueueItemBuffer &items)
+{
+	pragma::rendering::RenderQueue *lastQueue = nullptr;
+	std::vector<pragma::rendering::RenderQueueItem> *lastItems = nullptr;
+	std::function<void(pragma::rendering::RenderQueue &, const pragma::rendering::RenderQueueItem &)> fInsertItem = [&items, &lastQueue, &lastItems](pragma::rendering::RenderQueue &renderQueue, const pragma::rendering::RenderQueueItem &item) {
+		if(&renderQueue != lastQueue) {
+			auto it = std::find_if(items.begin(), items.end(), [&renderQueue](const RenderQueueItemBuffer::value_type &pair) { return pair.first == &renderQueue; });
+			if(it == items.end()) {
+				items.push_back({&renderQueue, {}});
+				it = items.end() - 1;
+			}
+			lastQueue = &renderQueue;
+			lastItems = &it->second;
+		}
+		if(lastItems->size() == lastItems->capacity())
+			lastItems->reserve(lastItems->size() * 1.1f + 50);
+		lastItems->push_back(item);
+	};
+	for(auto i = iStart; i < iEnd; ++i) {
+		auto *ent = objs[i];
+		assert(ent);
+		if(ent == nullptr) {
+			// This should NEVER occur, but seems to anyway in some rare cases
+			Con::cerr << "NULL Entity in dynamic scene occlusion octree! Ignoring..." << Con::endl;
+			continue;
+		}
+
+		if(ent->IsWorld()) {
+			auto worldC = ent->GetComponent<pragma::CWorldComponent>();
+			if(worldC.valid() && worldC->GetBSPTree())
+				continue; // World entities with BSP trees are handled separately
+		}
+		auto *renderC = ent->GetRenderComponent();
+		if(!renderC || renderC->IsExemptFromOcclusionCulling() || SceneRenderDesc::ShouldConsiderEntity(*ent, *info.scene, info.renderFlags, info.renderMask) == false
+		  || (info.shouldConsiderEntity && info.shouldConsiderEntity(*ent, *info.scene, info.renderFlags) == false))
+			continue;
+		if(info.fShouldCull && SceneRenderDesc::ShouldCull(*renderC, info.fShouldCull))
+			continue;
+		SceneRenderDesc::AddRenderMeshesToRenderQueue(info.optRasterizationRenderer, info.renderFlags, *renderC, info.getRenderQueue, *info.scene, *info.cam, info.vp, info.fShouldCull, info.lodBias, fInsertItem, info.baseSpecializationFlags);
+	}
+}
+// Collects the objects of the node and all of its visible descendants. The node itself is assumed to be visible.
+static void collect_octree_subtree(const OctreeCollectInfo &info, const OcclusionOctree<CBaseEntity *>::Node &node, RenderQueueItemBuffer &items)
+{
+	auto &objs = node.GetObjects();
+	collect_octree_node_objects(info, objs, 0, objs.size(), items);
+	auto *children = node.GetChildren();
+	if(children == nullptr)
+		return;
+	for(auto &c : *children) {
+		if(!c || c->IsEmpty())
+			continue;
+		auto &child = static_cast<OcclusionOctree<CBaseEntity *>::Node &>(*c);
+		if(is_octree_node_visible(info, child))
+			collect_octree_subtree(info, child, items);
+	}
+}
+static void submit_render_queue_items(RenderQueueItemBuffer &items)
+{
+	// Note: We don't add individual items directly to the render queue, because that would invoke
+	// a mutex lock which can stall all of the worker threads.
+	// Instead each job hands its batch over to the queue without locking, the batches are merged
+	// into the queue when it is sorted.
+	for(auto &pair : items)
+		pair.first->AddStaged(std::move(pair.second));
+}
+static void dispatch_octree_node(const std::shared_ptr<const OctreeCollectInfo> &info, const OcclusionOctree<CBaseEntity *>::Node &node, size_t numEntitiesPerWorkerJob)
+{
+	if(node.IsEmpty() || is_octree_node_visible(*info, node) == false)
+		return;
+	auto &workerManager = c_game->GetRenderQueueWorkerManager();
+	// Small subtrees are traversed and culled entirely within a single job, larger ones are split up
+	// so that the work is distributed evenly across all workers.
+	if(node.GetTotalObjectCount() <= numEntitiesPerWorkerJob * 4) {
+		workerManager.AddJob([info, &node]() {
+			RenderQueueItemBuffer items;
+			collect_octree_subtree(*info, node, items);
+			submit_render_queue_items(items);
+		});
+		return;
+	}
+	auto &objs = node.GetObjects();
+	auto numObjects = objs.size();
+	for(size_t iStart = 0; iStart < numObjects; iStart += numEntitiesPerWorkerJob) {
+		auto iEnd = umath::min(iStart + numEntitiesPerWorkerJob, numObjects);
+		workerManager.AddJob([info, &objs, iStart, iEnd]() {
+			RenderQueueItemBuffer items;
+			collect_octree_node_objects(*info, objs, iStart, iEnd, items);
+			submit_render_queue_items(items);
+		});
+	}
+	auto *children = node.GetChildren();
+	if(children == nullptr)
+		return;
+	for(auto &c : *children) {
+		if(!c)
+			continue;
+		dispatch_octree_node(info, static_cast<OcclusionOctree<CBaseEntity *>::Node &>(*c), numEntitiesPerWorkerJob);
+	}
+}
 void SceneRenderDesc::CollectRenderMeshesFromOctree(pragma::CRasterizationRendererComponent *optRasterizationRenderer, RenderFlags renderFlags, bool enableClipping, const OcclusionOctree<CBaseEntity *> &tree, const pragma::CSceneComponent &scene, const pragma::CCameraComponent &cam,
   const Mat4 &vp, pragma::rendering::RenderMask renderMask, const std::function<pragma::rendering::RenderQueue *(pragma::rendering::SceneRenderPass, bool)> &getRenderQueue, const std::function<bool(const Vector3 &, const Vector3 &)> &fShouldCull,
   const std::vector<util::BSPTree *> *bspTrees, const std::vector<util::BSPTree::Node *> *bspLeafNodes, int32_t lodBias, const std::function<bool(CBaseEntity &, const pragma::CSceneComponent &, RenderFlags)> &shouldConsiderEntity,
@@ -262,83 +401,25 @@ void SceneRenderDesc::CollectRenderMeshesFromOctree(pragma::CRasterizationRender
 {
 	if(enableClipping)
 		baseSpecializationFlags |= pragma::GameShaderSpecializationConstantFlag::EnableClippingBit;
-	auto numEntitiesPerWorkerJob = umath::max(cvEntitiesPerJob->GetInt(), 1);
-	std::function<void(const OcclusionOctree<CBaseEntity *>::Node &node)> iterateTree = nullptr;
-	iterateTree = [&iterateTree, &shouldConsiderEntity, &scene, &cam, renderFlags, fShouldCull, optRasterizationRenderer, renderMask, &getRenderQueue, &vp, bspLeafNodes, bspTrees, lodBias, numEntitiesPerWorkerJob, baseSpecializationFlags](const OcclusionOctree<CBaseEntity *>::Node &node) {
-		auto &nodeBounds = node.GetWorldBounds();
-		if(fShouldCull && fShouldCull(nodeBounds.first, nodeBounds.second))
-			return;
-		if(bspLeafNodes && bspLeafNodes->empty() == false) {
-			auto hasIntersection = false;
-			for(auto i = decltype(bspLeafNodes->size()) {0u}; i < bspLeafNodes->size(); ++i) {
-				auto *node = (*bspLeafNodes)[i];
-				if(umath::intersection::aabb_aabb(nodeBounds.first, nodeBounds.second, node->minVisible, node->maxVisible) == umath::intersection::Intersect::Outside)
-					continue;
-				if((*bspTrees)[i]->IsAabbVisibleInCluster(nodeBounds.first, nodeBounds.second, node->cluster) == false)
-					continue;
-				hasIntersection = true;
-				break;
-			}
-			if(hasIntersection == false)
-				return;
-		}
-		auto &objs = node.GetObjects();
-		auto numObjects = objs.size();
-		auto numBatches = (numObjects / numEntitiesPerWorkerJob) + (((numObjects % numEntitiesPerWorkerJob) > 0) ? 1 : 0);
-		for(auto i = decltype(numBatches) {0u}; i < numBatches; ++i) {
-			auto iStart = i * numEntitiesPerWorkerJob;
-			auto iEnd = umath::min(static_cast<size_t>(iStart + numEntitiesPerWorkerJob), numObjects);
-			c_game->GetRenderQueueWorkerManager().AddJob([iStart, iEnd, shouldConsiderEntity, renderMask, optRasterizationRenderer, &objs, renderFlags, getRenderQueue, &scene, &cam, vp, fShouldCull, lodBias, baseSpecializationFlags]() {
-				// Note: We don't add individual items directly to the render queue, because that would invoke
-				// a mutex lock which can stall all of the worker threads.
-				// Instead we'll collect the entire batch of items, then add all of them to the render queue at once.
-				std::unordered_map<pragma::rendering::RenderQueue *, std::vector<pragma::rendering::RenderQueueItem>> items;
-				for(auto i = iStart; i < iEnd; ++i) {
-					auto *ent = objs[i];
-					assert(ent);
-					if(ent == nullptr) {
-						// This should NEVER occur, but seems to anyway in some rare cases
-						Con::cerr << "NULL Entity in dynamic scene occlusion octree! Ignoring..." << Con::endl;
-						continue;
-					}
-
-					if(ent->IsWorld()) {
-						auto worldC = ent->GetComponent<pragma::CWorldComponent>();
-						if(worldC.valid() && worldC->GetBSPTree())
-							continue; // World entities with BSP trees are handled separately
-					}
-					auto *renderC = static_cast<CBaseEntity *>(ent)->GetRenderComponent();
-					if(!renderC || renderC->IsExemptFromOcclusionCulling() || ShouldConsiderEntity(*static_cast<CBaseEntity *>(ent), scene, renderFlags, renderMask) == false
-					  || (shouldConsiderEntity && shouldConsiderEntity(*static_cast<CBaseEntity *>(ent), scene, renderFlags) == false) //||
-					                                                                                                                   //(camClusterIdx.has_value() && renderC->IsVisibleInCluster(*camClusterIdx) == false)
-					)
-						continue;
-					if(fShouldCull && ShouldCull(*renderC, fShouldCull))
-						continue;
-					AddRenderMeshesToRenderQueue(
-					  optRasterizationRenderer, renderFlags, *renderC, getRenderQueue, scene, cam, vp, fShouldCull, lodBias,
-					  [&items](pragma::rendering::RenderQueue &renderQueue, const pragma::rendering::RenderQueueItem &item) {
-						  auto &v = items[&renderQueue];
-						  if(v.size() == v.capacity())
-							  v.reserve(v.size() * 1.1f + 50);
-						  v.push_back(item);
-					  },
-					  baseSpecializationFlags);
-				}
-				for(auto &pair : items)
-					pair.first->Add(pair.second);
-			});
-		}
-		auto *children = node.GetChildren();
-		if(children == nullptr)
-			return;
-		for(auto &c : *children) {
-			if(!c)
-				continue;
-			iterateTree(static_cast<OcclusionOctree<CBaseEntity *>::Node &>(*c));
-		}
-	};
-	iterateTree(tree.GetRootNode());
+	auto info = std::make_shared<OctreeCollectInfo>();
+	info->optRasterizationRenderer = optRasterizationRenderer;
+	info->renderFlags = renderFlags;
+	info->scene = &scene;
+	info->cam = &cam;
+	info->vp = vp;
+	info->renderMask = renderMask;
+	info->getRenderQueue = getRenderQueue;
+	info->fShouldCull = fShouldCull;
+	// The BSP vectors are usually owned by the caller's stack frame, so they have to be copied for the jobs
+	if(bspTrees && bspLeafNodes && bspLeafNodes->empty() == false) {
+		info->bspTrees = *bspTrees;
+		info->bspLeafNodes = *bspLeafNodes;
+	}
+	info->lodBias = lodBias;
+	info->shouldConsiderEntity = shouldConsiderEntity;
+	info->baseSpecializationFlags = baseSpecializationFlags;
+	auto numEntitiesPerWorkerJob = static_cast<size_t>(umath::max(cvEntitiesPerJob->GetInt(), 1));
+	dispatch_octree_node(info, tree.GetRootNode(), numEntitiesPerWorkerJob);
 }
 void SceneRenderDesc::CollectRenderMeshesFromOctree(pragma::CRasterizationRendererComponent *optRasterizationRenderer, RenderFlags renderFlags, bool enableClipping, const OcclusionOctree<CBaseEntity *> &tree, const pragma::CSceneComponent &scene, const pragma::CCameraComponent &cam,
   const Mat4 &vp, pragma::rendering::RenderMask renderMask, const std::vector<umath::Plane> &frustumPlanes, const std::vector<util::BSPTree *> *bspTrees, const std::vector<util::BSPTree::Node *> *bspLeafNodes)
@@ -762,11 +843,7 @@ void SceneRenderDesc::BuildRenderQueues(const util::DrawSceneInfo &drawSceneInfo
 
 		  // All render queues (aside from world render queues) need to be sorted
 		  for(auto &renderQueue : m_renderQueues) {
-			  if(stats)
-				  t = std::chrono::steady_clock::now();
-			  renderQueue->Sort();
-			  if(stats)
-				  (*stats)->AddTime(RenderQueueBuilderStats::Timer::QueueSort, std::chrono::steady_clock::now() - t);
+			  renderQueue->Sort(stats);
 
 			  if(stats)
 				  t = std::chrono::steady_clock::now();
@@ -38,9 +38,20 @@ REGISTER_SHARED_CONVAR(sv_servername, engine_info::get_name(), ConVarFlags::Arch
 REGISTER_SHARED_CONVAR(sv_timeout_duration, "90", ConVarFlags::Archive | ConVarFlags::Replicated, "Amount of time until a client is forcibly dropped if no data has been received.");
 REGISTER_SHARED_CONVAR(sv_tickrate, STRING(ENGINE_DEFAULT_TICK_RATE), ConVarFlags::Archive | ConVarFlags::Replicated,
   "Specifies the tickrate. A higher tickrate means smoother and more reliable physics, but also more data to transmit to clients. Higher values can result in more lag for clients.");
+REGISTER_SHARED_CONVAR(sv_physics_simulation_rate, "0", ConVarFlags::Archive | ConVarFlags::Replicated,
+  "The rate (in steps per second) at which the physics simulation is stepped. If set to 0, the physics simulation is stepped once per tick. Any other value decouples the physics simulation from the tickrate and enables interpolation between physics states.");
+REGISTER_SHARED_CONVAR(sv_physics_max_substeps, "4", ConVarFlags::Archive | ConVarFlags::Replicated, "The maximum number of physics steps per tick. If the simulation falls further behind, the remaining time is dropped.");
 REGISTER_SHARED_CONVAR(sv_acceleration, "33", ConVarFlags::Archive | ConVarFlags::Replicated, "Player acceleration. If this is too low, the player will be unable to reach full movement speed due to friction forces.");
 
 REGISTER_CONVAR_SV(sv_allowdownload, "1", ConVarFlags::Archive, "Specifies whether clients are allowed to download resources from the server.");
+REGISTER_CONVAR_SV(sv_snapshot_delta_compression, "1", ConVarFlags::Archive, "If enabled, entity snapshots are quantized and only transmitted as the difference to the last snapshot the client has acknowledged.");
+REGISTER_CONVAR_SV(sv_snapshot_relevance_enabled, "1", ConVarFlags::Archive, "If enabled, entities are only included in a client's snapshot if they are relevant to the client, and distant entities are updated at a reduced rate.");
+REGISTER_CONVAR_SV(sv_snapshot_relevance_pvs, "1", ConVarFlags::Archive, "If enabled, entities outside of the potentially visible set of the client (as determined by the BSP tree of the map) are excluded from snapshots.");
+REGISTER_CONVAR_SV(sv_snapshot_relevance_near_distance, "2048", ConVarFlags::Archive, "Entities closer to the client than this distance are updated with every snapshot.");
+REGISTER_CONVAR_SV(sv_snapshot_relevance_far_distance, "6144", ConVarFlags::Archive, "Entities closer to the client than this distance are updated with every second snapshot, entities further away with every fourth snapshot.");
+REGISTER_CONVAR_SV(sv_snapshot_relevance_max_distance, "0", ConVarFlags::Archive, "Entities further away from the client than this distance are excluded from snapshots. 0 = No limit.");
+REGISTER_CONVAR_SV(sv_lag_compensation_enabled, "1", ConVarFlags::Archive, "If enabled, bullets fired by clients are traced against the hitboxes as they were at the time of the last snapshot the client had received.");
+REGISTER_CONVAR_SV(sv_lag_compensation_max_time, "0.5", ConVarFlags::Archive, "Maximum amount of time (in seconds) the hitboxes may be rewound for lag compensation.");
 REGISTER_CONVAR_SV(sv_allowupload, "1", ConVarFlags::Archive, "Specifies whether clients are allowed to upload resources to the server (e.g. spraylogos).");
 #endif
 #endif
@@ -9,6 +9,7 @@
 #include <pragma/game/game.h>
 #include "pragma/serverdefinitions.h"
 #include "pragma/entities/world.h"
+#include "pragma/networking/snapshot_relevance.hpp"
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -52,6 +53,8 @@ class DLLSERVER SGame : public Game {
 	std::unordered_map<std::string, udm::PProperty> m_preTransitionWorldState {};
 	// Delta landmark offset between this level and the previous level (in case there was a level change)
 	Vector3 m_deltaTransitionLandmarkOffset {};
+	pragma::networking::SnapshotRelevanceManager m_snapshotRelevanceManager;
+	uint32_t m_snapshotIndex = 0;
   public:
 	enum class CPUProfilingPhase : uint32_t {
 		Snapshot = 0u,
@@ -78,6 +81,7 @@ class DLLSERVER SGame : public Game {
 	virtual void RegisterLuaEntityComponents(luabind::module_ &gameMod) override;
 	virtual void RegisterLuaEntityComponent(luabind::class_<pragma::BaseEntityComponent> &classDef) override;
 	virtual bool InitializeGameMode() override;
+	virtual void InitializeWorldData(pragma::asset::WorldData &worldData) override;
 
 	const pragma::NetEventManager &GetEntityNetEventManager() const;
 	pragma::NetEventManager &GetEntityNetEventManager();
@@ -110,6 +114,7 @@ class DLLSERVER SGame : public Game {
 	virtual void RegisterLuaClasses() override;
 	void SendSnapshot();
 	void SendSnapshot(pragma::SPlayerComponent *pl);
+	const pragma::networking::SnapshotRelevanceManager &GetSnapshotRelevanceManager() const;
 	virtual std::shared_ptr<ModelMesh> CreateModelMesh() const override;
 	virtual std::shared_ptr<ModelSubMesh> CreateModelSubMesh() const override;
 	virtual void GetRegisteredEntities(std::vector<std::string> &classes, std::vector<std::string> &luaClasses) const override;
@@ -0,0 +1,34 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#ifndef __S_LAG_COMPENSATION_HPP__
+#define __S_LAG_COMPENSATION_HPP__
+
+#include "pragma/serverdefinitions.h"
+#include <pragma/types.hpp>
+#include <vector>
+
+class SGame;
+class BaseEntity;
+namespace pragma {
+	class BaseCharacterComponent;
+	// Moves the hitboxes of all characters back to where they were at the specified server time, so that traces
+	// can be evaluated against the world as a client saw it. The hitboxes are moved back to their current state
+	// once the scope ends. No physics are re-simulated, only the hitbox collision objects are moved.
+	class DLLSERVER LagCompensationScope {
+	  public:
+		// Clamps the time to the maximum rewind time specified by sv_lag_compensation_max_time
+		static double ClampRewindTime(SGame &game, double t);
+		LagCompensationScope(SGame &game, double t, const BaseEntity *exclude = nullptr);
+		~LagCompensationScope();
+		LagCompensationScope(const LagCompensationScope &) = delete;
+		LagCompensationScope &operator=(const LagCompensationScope &) = delete;
+	  private:
+		std::vector<pragma::ComponentHandle<pragma::BaseCharacterComponent>> m_rewoundCharacters;
+	};
+};
+
+#endif
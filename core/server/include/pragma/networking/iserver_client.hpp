@@ -10,7 +10,9 @@
 #include "pragma/serverdefinitions.h"
 #include "pragma/networking/enums.hpp"
 #include "pragma/networking/ip_address.hpp"
+#include <pragma/networking/snapshot_baseline.hpp>
 #include <cinttypes>
+#include <unordered_set>
 
 class Resource;
 class NetPacket;
@@ -50,6 +52,18 @@ namespace pragma::networking {
 		bool IsTransferring() const;
 
 		uint8_t SwapSnapshotId();
+		// Monotonic index of the snapshot id that was last returned by SwapSnapshotId
+		uint64_t GetSnapshotIndex() const;
+		// Entity states of the most recent snapshots sent to this client, which haven't been acknowledged yet
+		SnapshotBaselineRing &GetSnapshotBaselines();
+		// Last entity states acknowledged by this client, used as delta base
+		const SnapshotAcknowledgedStates &GetAcknowledgedSnapshotStates() const;
+		void AcknowledgeSnapshot(uint8_t snapshotId);
+		void ResetSnapshotBaselines();
+		// Has to be called when an entity is removed, so its index can be re-used without referencing stale states
+		void RemoveSnapshotEntity(uint32_t entIdx);
+		// Entities with pending snapshot updates that were not relevant to this client when they changed
+		std::unordered_set<uint32_t> &GetDeferredSnapshotEntities();
 		void Reset();
 		void ScheduleResource(const std::string &fileName);
 		std::vector<std::string> &GetScheduledResources();
@@ -66,6 +80,10 @@ namespace pragma::networking {
 		TransferState m_initialResourceTransferState = TransferState::Initial;
 
 		uint8_t m_snapshotId = 0;
+		uint64_t m_snapshotIndex = 0;
+		SnapshotBaselineRing m_snapshotBaselines {};
+		SnapshotAcknowledgedStates m_acknowledgedSnapshotStates {};
+		std::unordered_set<uint32_t> m_deferredSnapshotEntities;
 		std::vector<std::string> m_scheduledResources; // Scheduled resource files for download
 
 		// TODO: Move this somewhere else?
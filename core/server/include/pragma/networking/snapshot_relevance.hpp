@@ -0,0 +1,66 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#ifndef __PRAGMA_SNAPSHOT_RELEVANCE_HPP__
+#define __PRAGMA_SNAPSHOT_RELEVANCE_HPP__
+
+#include "pragma/serverdefinitions.h"
+#include <pragma/util/util_bsp_tree.hpp>
+#include <mathutil/uvec.h>
+#include <optional>
+#include <memory>
+#include <vector>
+
+class BaseEntity;
+namespace pragma {
+	class SPlayerComponent;
+};
+namespace pragma::networking {
+	// Determines how often an entity is included in a client's snapshot
+	enum class SnapshotRelevance : uint8_t {
+		None = 0u, // Not relevant to the client, the entity is not transmitted
+		Low,       // Transmitted every fourth snapshot
+		Medium,    // Transmitted every second snapshot
+		High,      // Transmitted every snapshot
+	};
+
+	// Area-of-interest culling for snapshots. Relevance of an entity for a client is determined by the
+	// potentially visible set of the world BSP tree (if the map has one) and by distance bands around the client's view position.
+	class DLLSERVER SnapshotRelevanceManager {
+	  public:
+		struct DLLSERVER ClientView {
+			Vector3 origin {};
+			const BaseEntity *viewEntity = nullptr;
+			std::optional<util::BSPTree::ClusterIndex> cluster {};
+		};
+		struct DLLSERVER EntityInfo {
+			const BaseEntity *entity = nullptr;
+			const BaseEntity *owner = nullptr;
+			Vector3 origin {};
+			// Entities without a position (e.g. game or gamemode entities) are always transmitted
+			bool alwaysRelevant = false;
+			// BSP clusters the entity's bounds overlap
+			std::vector<util::BSPTree::ClusterIndex> clusters;
+		};
+
+		static uint32_t GetUpdateInterval(SnapshotRelevance relevance);
+
+		void SetBSPTree(const std::shared_ptr<util::BSPTree> &bspTree);
+		const std::shared_ptr<util::BSPTree> &GetBSPTree() const;
+		bool IsEnabled() const;
+
+		ClientView GetClientView(const pragma::SPlayerComponent &pl) const;
+		void InitializeEntityInfo(EntityInfo &info, const BaseEntity &ent, const Vector3 &origin, const BaseEntity *owner) const;
+		SnapshotRelevance GetRelevance(const ClientView &view, const EntityInfo &info) const;
+		// Returns true if the entity should be transmitted in the snapshot with the specified index.
+		// Updates of entities with a reduced rate are staggered by entity index to spread them out evenly.
+		bool ShouldTransmit(const ClientView &view, const EntityInfo &info, uint32_t snapshotIndex) const;
+	  private:
+		std::shared_ptr<util::BSPTree> m_bspTree = nullptr;
+	};
+};
+
+#endif
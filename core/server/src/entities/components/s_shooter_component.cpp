@@ -10,6 +10,8 @@
 #include "pragma/entities/components/s_player_component.hpp"
 #include "pragma/lua/s_lentity_handles.hpp"
 #include "pragma/networking/recipient_filter.hpp"
+#include "pragma/game/s_lag_compensation.hpp"
+#include "pragma/console/s_cvar.h"
 #include <pragma/lua/converters/game_type_converters_t.hpp>
 #include <pragma/networking/enums.hpp>
 #include <pragma/entities/components/damageable_component.hpp>
@@ -18,16 +20,24 @@
 #include <sharedutils/scope_guard.h>
 #include <servermanager/interface/sv_nwm_manager.hpp>
 #include <pragma/physics/raytraces.h>
+#include <pragma/physics/trace_batch.hpp>
 
 using namespace pragma;
 
 extern DLLSERVER ServerState *server;
 extern DLLSERVER SGame *s_game;
 
+static CVar cvLagCompensation = GetServerConVar("sv_lag_compensation_enabled");
+
 Bool SShooterComponent::ReceiveNetEvent(pragma::BasePlayerComponent &pl, pragma::NetEventId eventId, NetPacket &packet)
 {
-	if(eventId == m_netEvFireBullets)
+	if(eventId == m_netEvFireBullets) {
+		// Only the clients' bullet events contain the view time, the events relayed by the server don't
+		auto snapshotTime = packet->Read<double>();
+		auto viewOffset = umath::max(packet->Read<float>(), 0.f);
 		ReceiveBulletEvent(packet, &pl);
+		m_nextBullet->clientViewTime = snapshotTime + viewOffset;
+	}
 	else
 		return false;
 	return true;
@@ -98,7 +108,14 @@ void SShooterComponent::FireBullets(const BulletInfo &bulletInfo, DamageInfo &dm
 
 	TraceData data;
 	GetBulletTraceData(bulletInfo, data);
-	outHitTargets.reserve(bulletInfo.bulletCount);
+	// Bullets fired by a client are traced against the hitboxes as they were on the client's screen
+	std::optional<pragma::LagCompensationScope> lagCompensation {};
+	if(bMaster == false && m_nextBullet->clientViewTime.has_value() && cvLagCompensation->GetBool())
+		lagCompensation.emplace(*s_game, *m_nextBullet->clientViewTime, m_nextBullet->source.get());
+	// All bullets are traced in one batch. The storage of the batch is re-used between calls.
+	static thread_local pragma::physics::TraceBatch traceBatch {};
+	traceBatch.Clear();
+	traceBatch.Reserve(bulletInfo.bulletCount);
 	for(auto i = decltype(bulletInfo.bulletCount) {0}; i < bulletInfo.bulletCount; ++i) {
 		auto &bulletDst = m_nextBullet->destinations[i];
 		auto bulletDir = bulletDst - origin;
@@ -108,28 +125,43 @@ void SShooterComponent::FireBullets(const BulletInfo &bulletInfo, DamageInfo &dm
 		data.SetSource(origin);
 		data.SetTarget(dst);
 		dstPositions.push_back(dst);
-
+		traceBatch.AddQuery(data);
+	}
+	// Note: The bullet filters may call into Lua, so the batch must not be executed in parallel
+	s_game->RayCastBatch(traceBatch);
+	// The results have to be moved out of the batch before any damage is dealt, since damage callbacks
+	// may fire bullets themselves
+	std::vector<std::pair<size_t, size_t>> bulletResultRanges;
+	bulletResultRanges.reserve(bulletInfo.bulletCount);
+	outHitTargets.reserve(bulletInfo.bulletCount);
+	for(auto i = decltype(bulletInfo.bulletCount) {0}; i < bulletInfo.bulletCount; ++i) {
 		auto offset = outHitTargets.size();
-		auto hit = s_game->RayCast(data, &outHitTargets);
-		if(hit) {
-			for(auto i = offset; i < outHitTargets.size(); ++i) {
-				auto &result = outHitTargets.at(i);
-				if(result.entity.valid() == false)
-					continue;
-				auto pDamageableComponent = result.entity->GetComponent<pragma::DamageableComponent>();
-				if(pDamageableComponent.valid()) {
-					auto hitGroup = HitGroup::Generic;
-					if(result.collisionObj.IsValid()) {
-						auto charComponent = result.entity.get()->GetCharacterComponent();
-						if(charComponent.valid())
-							charComponent->FindHitgroup(*result.collisionObj.Get(), hitGroup);
-					}
-					dmgInfo.SetHitGroup(hitGroup);
-					dmgInfo.SetForce(bulletDir * dmgInfo.GetForce().x);
-					dmgInfo.SetHitPosition(result.position);
-					if((fCallback == nullptr || fCallback(dmgInfo, result.entity.get()) == true) && pDamageableComponent.valid())
-						pDamageableComponent->TakeDamage(dmgInfo);
+		auto &results = traceBatch.GetResults(i);
+		outHitTargets.insert(outHitTargets.end(), std::make_move_iterator(results.begin()), std::make_move_iterator(results.end()));
+		// Only hits deal damage
+		bulletResultRanges.push_back({traceBatch.HasHit(i) ? offset : outHitTargets.size(), outHitTargets.size()});
+	}
+	for(auto i = decltype(bulletInfo.bulletCount) {0}; i < bulletInfo.bulletCount; ++i) {
+		auto bulletDir = dstPositions[i] - origin;
+		uvec::normalize(&bulletDir);
+		auto &range = bulletResultRanges[i];
+		for(auto j = range.first; j < range.second; ++j) {
+			auto &result = outHitTargets.at(j);
+			if(result.entity.valid() == false)
+				continue;
+			auto pDamageableComponent = result.entity->GetComponent<pragma::DamageableComponent>();
+			if(pDamageableComponent.valid()) {
+				auto hitGroup = HitGroup::Generic;
+				if(result.collisionObj.IsValid()) {
+					auto charComponent = result.entity.get()->GetCharacterComponent();
+					if(charComponent.valid())
+						charComponent->FindHitgroup(*result.collisionObj.Get(), hitGroup);
 				}
+				dmgInfo.SetHitGroup(hitGroup);
+				dmgInfo.SetForce(bulletDir * dmgInfo.GetForce().x);
+				dmgInfo.SetHitPosition(result.position);
+				if((fCallback == nullptr || fCallback(dmgInfo, result.entity.get()) == true) && pDamageableComponent.valid())
+					pDamageableComponent->TakeDamage(dmgInfo);
 			}
 		}
 	}
@@ -16,6 +16,7 @@
 #include <sharedutils/util_string.h>
 #include <pragma/networking/nwm_util.h>
 #include "pragma/networking/iserver_client.hpp"
+#include "pragma/networking/iserver.hpp"
 #include "pragma/networking/recipient_filter.hpp"
 #include "pragma/entities/components/s_player_component.hpp"
 #include "pragma/entities/components/s_ai_component.hpp"
@@ -81,6 +82,12 @@ void SGame::RemoveEntity(BaseEntity *ent)
 	if(ent->IsPlayer())
 		m_numPlayers--;
 	unsigned int idx = ent->GetIndex();
+	// Snapshot states of this entity mustn't be used as delta base for an entity that re-uses the index
+	auto *sv = server->GetServer();
+	if(sv) {
+		for(auto &cl : sv->GetClients())
+			cl->RemoveSnapshotEntity(idx);
+	}
 #ifdef PRAGMA_ENABLE_VTUNE_PROFILING
 	debug::get_domain().BeginTask("remove_entity");
 #endif
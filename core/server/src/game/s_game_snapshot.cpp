@@ -12,6 +12,9 @@
 #include "pragma/entities/player.h"
 #include <pragma/entities/baseplayer.hpp>
 #include <pragma/networking/snapshot_flags.hpp>
+#include <pragma/networking/snapshot_baseline.hpp>
+#include "pragma/networking/snapshot_relevance.hpp"
+#include <pragma/entities/components/base_ownable_component.hpp>
 #include <pragma/entities/components/velocity_component.hpp>
 #include <pragma/entities/components/base_transform_component.hpp>
 #include <pragma/entities/components/base_physics_component.hpp>
@@ -19,153 +22,340 @@
 #include <pragma/entities/entity_component_system_t.hpp>
 #include <pragma/networking/nwm_util.h>
 #include <pragma/networking/enums.hpp>
+#include "pragma/console/s_cvar.h"
+#include <pragma/asset_types/world.hpp>
+#include <pragma/util/job_system.hpp>
 
 extern DLLSERVER ServerState *server;
 
-void SGame::SendSnapshot(pragma::SPlayerComponent *pl)
-{
-	auto *session = pl ? pl->GetClientSession() : nullptr;
-	if(session == nullptr)
-		return;
-	NetPacket packet;
-	packet->Write<uint8_t>(session->SwapSnapshotId());
-	packet->Write<double>(CurTime());
+namespace {
+	struct SnapshotPhysicsObject {
+		Vector3 pos;
+		Quat rot;
+		Vector3 vel;
+		Vector3 angVel;
+		pragma::networking::SnapshotObjectState quantized {};
+	};
+	// Player-independent state of an entity, gathered once per snapshot
+	struct SnapshotFrameEntity {
+		SBaseEntity *entity = nullptr;
+		// False if the entity is only part of the frame because its update was deferred for some clients
+		bool markedForSnapshot = true;
+		pragma::networking::SnapshotRelevanceManager::EntityInfo relevanceInfo {};
+		Vector3 pos;
+		Vector3 vel;
+		Vector3 angVel;
+		Quat rot;
+		pragma::networking::SnapshotObjectState quantized {};
+		bool hasPhysicsData = false;
+		std::vector<SnapshotPhysicsObject> physicsObjects;
+		std::vector<std::pair<pragma::ComponentId, pragma::SBaseSnapshotComponent *>> snapshotComponents;
+	};
+	// Immutable state of all snapshot entities for the current tick, shared by all clients
+	struct SnapshotFrame {
+		double time = 0.0;
+		uint32_t snapshotIndex = 0;
+		bool useDeltaCompression = false;
+		std::vector<SnapshotFrameEntity> entities;
+	};
+	// Player-dependent data, which has to be written on the main thread, since it may call into Lua
+	struct ClientSnapshotData {
+		struct EntityDataRange {
+			bool transmit = false;
+			size_t entityDataOffset = 0;
+			size_t entityDataSize = 0;
+			size_t componentDataOffset = 0;
+			size_t componentDataSize = 0;
+			uint8_t numComponents = 0;
+		};
+		pragma::SPlayerComponent *player = nullptr;
+		pragma::networking::IServerClient *session = nullptr;
+		NetPacket playerData;
+		std::vector<EntityDataRange> entityRanges;
+		NetPacket playerStates;
+		uint8_t numPlayerStates = 0;
+	};
+};
 
+static CVar cvDeltaCompression = GetServerConVar("sv_snapshot_delta_compression");
+static void gather_snapshot_frame(SGame &game, SnapshotFrame &frame, const std::unordered_set<uint32_t> &deferredEntities, uint32_t snapshotIndex)
+{
+	frame.time = game.CurTime();
+	frame.snapshotIndex = snapshotIndex;
+	frame.useDeltaCompression = cvDeltaCompression->GetBool();
+	auto &relevanceManager = game.GetSnapshotRelevanceManager();
+	pragma::ComponentId ownableComponentId;
+	if(game.GetEntityComponentManager().GetComponentTypeId("ownable", ownableComponentId) == false)
+		ownableComponentId = pragma::INVALID_COMPONENT_ID;
 	std::vector<SBaseEntity *> *entities;
-	GetEntities(&entities);
-	auto numEntities = entities->size();
-	auto posNumEnts = packet->GetSize();
-	packet->Write<unsigned int>((unsigned int)(0));
-	size_t numEntitiesValid = 0;
-	for(size_t i = 0; i < numEntities; i++) {
-		SBaseEntity *ent = (*entities)[i];
-		if(ent != NULL && ent->IsShared() && ent->IsSynchronized() && ent->IsMarkedForSnapshot()) {
-			numEntitiesValid++;
-			auto pTrComponent = ent->GetTransformComponent();
-			auto pVelComponent = ent->GetComponent<pragma::VelocityComponent>();
-			nwm::write_entity(packet, ent);
-			nwm::write_vector(packet, pTrComponent != nullptr ? pTrComponent->GetPosition() : Vector3 {});
-			nwm::write_vector(packet, pVelComponent.valid() ? pVelComponent->GetVelocity() : Vector3 {});
-			nwm::write_vector(packet, pVelComponent.valid() ? pVelComponent->GetAngularVelocity() : Vector3 {});
-			nwm::write_quat(packet, pTrComponent != nullptr ? pTrComponent->GetRotation() : uquat::identity());
-
-			auto offsetEntData = packet->GetSize();
-			packet->Write<UInt8>(UInt8(0));
-			auto offset = packet->GetSize();
-			ent->SendSnapshotData(packet, *pl);
-			auto entDataSize = packet->GetSize() - offset;
-#ifdef _DEBUG
-			assert(entDataSize <= std::numeric_limits<UInt8>::max());
-#endif
-			packet->Write<UInt8>(CUInt8(entDataSize), &offsetEntData);
-
-			auto flags = pragma::SnapshotFlags::None;
-			auto offsetSnapshotFlags = packet->GetOffset();
-			packet->Write<decltype(flags)>(flags);
-
-			auto pPhysComponent = ent->GetPhysicsComponent();
-			PhysObj *physObj = pPhysComponent != nullptr ? pPhysComponent->GetPhysicsObject() : nullptr;
-			if(physObj != NULL && !physObj->IsStatic()) {
-				flags |= pragma::SnapshotFlags::PhysicsData;
-				if(physObj->IsController()) {
-					packet->Write<uint8_t>(1u);
-					auto *physController = static_cast<ControllerPhysObj *>(physObj);
-					packet->Write<Vector3>(physController->GetPosition());
-					packet->Write<Quat>(physController->GetOrientation());
-					packet->Write<Vector3>(physController->GetLinearVelocity());
-					packet->Write<Vector3>(physController->GetAngularVelocity());
-				}
-				else {
-					auto colObjs = physObj->GetCollisionObjects();
-					packet->Write<uint8_t>(static_cast<uint8_t>(colObjs.size()));
-					//auto i = 0;
-					for(auto &hObj : colObjs) {
-						Vector3 pos {0.f, 0.f, 0.f};
-						auto rot = uquat::identity();
-						Vector3 vel {0.f, 0.f, 0.f};
-						Vector3 angVel {0.f, 0.f, 0.f};
-						if(hObj.IsValid()) {
-							auto *o = hObj.Get();
-							pos = o->GetPos();
-							rot = o->GetRotation();
-							if(o->IsRigid()) {
-								auto *rigid = o->GetRigidBody();
-								vel = rigid->GetLinearVelocity();
-								angVel = rigid->GetAngularVelocity();
-							}
+	game.GetEntities(&entities);
+	frame.entities.reserve(entities->size());
+	for(auto *ent : *entities) {
+		if(ent == nullptr || !ent->IsShared() || !ent->IsSynchronized())
+			continue;
+		auto markedForSnapshot = ent->IsMarkedForSnapshot();
+		if(markedForSnapshot == false && deferredEntities.find(ent->GetIndex()) == deferredEntities.end())
+			continue;
+		frame.entities.push_back({});
+		auto &frameEnt = frame.entities.back();
+		frameEnt.entity = ent;
+		frameEnt.markedForSnapshot = markedForSnapshot;
+		auto pTrComponent = ent->GetTransformComponent();
+		auto pVelComponent = ent->GetComponent<pragma::VelocityComponent>();
+		frameEnt.pos = pTrComponent != nullptr ? pTrComponent->GetPosition() : Vector3 {};
+		frameEnt.vel = pVelComponent.valid() ? pVelComponent->GetVelocity() : Vector3 {};
+		frameEnt.angVel = pVelComponent.valid() ? pVelComponent->GetAngularVelocity() : Vector3 {};
+		frameEnt.rot = pTrComponent != nullptr ? pTrComponent->GetRotation() : uquat::identity();
+		if(frame.useDeltaCompression)
+			frameEnt.quantized = pragma::networking::SnapshotObjectState::Quantize(frameEnt.pos, frameEnt.vel, frameEnt.angVel, frameEnt.rot);
+
+		const BaseEntity *owner = nullptr;
+		if(ownableComponentId != pragma::INVALID_COMPONENT_ID) {
+			auto *ownableC = static_cast<pragma::BaseOwnableComponent *>(ent->FindComponent(ownableComponentId).get());
+			owner = ownableC ? ownableC->GetOwner() : nullptr;
+		}
+		relevanceManager.InitializeEntityInfo(frameEnt.relevanceInfo, *ent, frameEnt.pos, owner);
+
+		auto pPhysComponent = ent->GetPhysicsComponent();
+		PhysObj *physObj = pPhysComponent != nullptr ? pPhysComponent->GetPhysicsObject() : nullptr;
+		if(physObj != NULL && !physObj->IsStatic()) {
+			frameEnt.hasPhysicsData = true;
+			if(physObj->IsController()) {
+				auto *physController = static_cast<ControllerPhysObj *>(physObj);
+				frameEnt.physicsObjects.push_back({physController->GetPosition(), physController->GetOrientation(), physController->GetLinearVelocity(), physController->GetAngularVelocity()});
+			}
+			else {
+				auto colObjs = physObj->GetCollisionObjects();
+				frameEnt.physicsObjects.reserve(colObjs.size());
+				for(auto &hObj : colObjs) {
+					frameEnt.physicsObjects.push_back({Vector3 {0.f, 0.f, 0.f}, uquat::identity(), Vector3 {0.f, 0.f, 0.f}, Vector3 {0.f, 0.f, 0.f}});
+					auto &obj = frameEnt.physicsObjects.back();
+					if(hObj.IsValid()) {
+						auto *o = hObj.Get();
+						obj.pos = o->GetPos();
+						obj.rot = o->GetRotation();
+						if(o->IsRigid()) {
+							auto *rigid = o->GetRigidBody();
+							obj.vel = rigid->GetLinearVelocity();
+							obj.angVel = rigid->GetAngularVelocity();
 						}
-						packet->Write<Vector3>(pos);
-						packet->Write<Quat>(rot);
-						packet->Write<Vector3>(vel);
-						packet->Write<Vector3>(angVel);
 					}
 				}
 			}
+			if(frame.useDeltaCompression) {
+				for(auto &obj : frameEnt.physicsObjects)
+					obj.quantized = pragma::networking::SnapshotObjectState::Quantize(obj.pos, obj.vel, obj.angVel, obj.rot);
+			}
+		}
 
-			auto offsetNumComponents = 0u;
-			auto numComponents = 0u;
-			auto bFirst = true;
-			for(auto &pComponent : ent->GetComponents()) {
-				if(pComponent.expired() || pComponent->ShouldTransmitSnapshotData() == false)
-					continue;
-				auto *pSnapshotComponent = dynamic_cast<pragma::SBaseSnapshotComponent *>(pComponent.get());
-				if(pSnapshotComponent == nullptr)
-					throw std::logic_error("Component must be derived from SBaseSnapshotComponent if snapshot data is enabled!");
-				if(bFirst) {
-					bFirst = false;
-					flags |= pragma::SnapshotFlags::ComponentData;
-					offsetNumComponents = packet->GetOffset();
-					packet->Write<uint8_t>(static_cast<uint8_t>(0u));
-				}
-				packet->Write<pragma::ComponentId>(pComponent->GetComponentId());
-				auto offsetComponentSize = packet->GetOffset();
-				packet->Write<uint8_t>(static_cast<uint8_t>(0u));
-
-				auto offsetComponentDataStart = packet->GetOffset();
-				pSnapshotComponent->SendSnapshotData(packet, *pl);
-				auto szComponent = packet->GetOffset() - offsetComponentDataStart;
-				if(szComponent > std::numeric_limits<uint8_t>::max())
-					throw std::runtime_error("Component size mustn't exceed " + std::to_string(std::numeric_limits<uint8_t>::max()) + " bytes!");
-				packet->Write<uint8_t>(szComponent, &offsetComponentSize);
-
-				if(++numComponents == std::numeric_limits<uint8_t>::max()) {
-					Con::cwar << Con::PREFIX_SERVER << "Attempted to send data for more than " << std::numeric_limits<uint8_t>::max() << " components for a single entity! This is not allowed!" << Con::endl;
-					break;
-				}
+		for(auto &pComponent : ent->GetComponents()) {
+			if(pComponent.expired() || pComponent->ShouldTransmitSnapshotData() == false)
+				continue;
+			auto *pSnapshotComponent = dynamic_cast<pragma::SBaseSnapshotComponent *>(pComponent.get());
+			if(pSnapshotComponent == nullptr)
+				throw std::logic_error("Component must be derived from SBaseSnapshotComponent if snapshot data is enabled!");
+			if(frameEnt.snapshotComponents.size() == std::numeric_limits<uint8_t>::max()) {
+				Con::cwar << Con::PREFIX_SERVER << "Attempted to send data for more than " << std::numeric_limits<uint8_t>::max() << " components for a single entity! This is not allowed!" << Con::endl;
+				break;
 			}
-			packet->Write<decltype(flags)>(flags, &offsetSnapshotFlags);
-			if((flags & pragma::SnapshotFlags::ComponentData) != pragma::SnapshotFlags::None)
-				packet->Write<uint8_t>(numComponents, &offsetNumComponents);
+			frameEnt.snapshotComponents.push_back({pComponent->GetComponentId(), pSnapshotComponent});
 		}
 	}
-	packet->Write<UInt32>(CUInt32(numEntitiesValid), &posNumEnts);
+}
+
+static void write_client_snapshot_data(const SGame &game, const SnapshotFrame &frame, ClientSnapshotData &clData)
+{
+	auto &pl = *clData.player;
+	auto &packet = clData.playerData;
+	auto &relevanceManager = game.GetSnapshotRelevanceManager();
+	auto view = relevanceManager.GetClientView(pl);
+	auto &deferredEntities = clData.session->GetDeferredSnapshotEntities();
+	clData.entityRanges.resize(frame.entities.size());
+	for(auto i = decltype(frame.entities.size()) {0u}; i < frame.entities.size(); ++i) {
+		auto &frameEnt = frame.entities[i];
+		auto &range = clData.entityRanges[i];
+		auto entIdx = frameEnt.entity->GetIndex();
+		auto itDeferred = deferredEntities.find(entIdx);
+		if(frameEnt.markedForSnapshot == false && itDeferred == deferredEntities.end())
+			continue; // Nothing has changed for this client
+		if(relevanceManager.ShouldTransmit(view, frameEnt.relevanceInfo, frame.snapshotIndex) == false) {
+			// Entity isn't relevant to the client right now, we'll transmit its state once it is
+			if(itDeferred == deferredEntities.end())
+				deferredEntities.insert(entIdx);
+			continue;
+		}
+		if(itDeferred != deferredEntities.end())
+			deferredEntities.erase(itDeferred);
+		range.transmit = true;
+		range.entityDataOffset = packet->GetSize();
+		frameEnt.entity->SendSnapshotData(packet, pl);
+		range.entityDataSize = packet->GetSize() - range.entityDataOffset;
+#ifdef _DEBUG
+		assert(range.entityDataSize <= std::numeric_limits<UInt8>::max());
+#endif
+
+		range.componentDataOffset = packet->GetSize();
+		for(auto &[componentId, pSnapshotComponent] : frameEnt.snapshotComponents) {
+			packet->Write<pragma::ComponentId>(componentId);
+			auto offsetComponentSize = packet->GetOffset();
+			packet->Write<uint8_t>(static_cast<uint8_t>(0u));
+
+			auto offsetComponentDataStart = packet->GetOffset();
+			pSnapshotComponent->SendSnapshotData(packet, pl);
+			auto szComponent = packet->GetOffset() - offsetComponentDataStart;
+			if(szComponent > std::numeric_limits<uint8_t>::max())
+				throw std::runtime_error("Component size mustn't exceed " + std::to_string(std::numeric_limits<uint8_t>::max()) + " bytes!");
+			packet->Write<uint8_t>(szComponent, &offsetComponentSize);
+		}
+		range.componentDataSize = packet->GetSize() - range.componentDataOffset;
+		range.numComponents = static_cast<uint8_t>(frameEnt.snapshotComponents.size());
+	}
 
-	//unsigned int numPlayers = Player::GetPlayerCount();
-	auto posNumPls = packet->GetSize();
-	packet->Write<unsigned char>((unsigned char)(0));
 	auto &players = pragma::SPlayerComponent::GetAll();
-	unsigned char numPlayersValid = 0;
 	for(auto *plComponent : players) {
-		if(plComponent != NULL && plComponent != pl) {
+		if(plComponent != NULL && plComponent != &pl) {
 			auto *ent = static_cast<Player *>(plComponent->GetBasePlayer());
 			if(ent != nullptr) {
-				numPlayersValid++;
-				nwm::write_player(packet, plComponent);
+				++clData.numPlayerStates;
+				nwm::write_player(clData.playerStates, plComponent);
 				auto charComponent = ent->GetCharacterComponent();
-				nwm::write_quat(packet, charComponent.valid() ? charComponent->GetViewOrientation() : uquat::identity());
-				std::vector<InputAction> &keyStack = pl->GetKeyStack();
+				nwm::write_quat(clData.playerStates, charComponent.valid() ? charComponent->GetViewOrientation() : uquat::identity());
+				std::vector<InputAction> &keyStack = pl.GetKeyStack();
 				auto sz = CUChar(keyStack.size());
-				packet->Write<UChar>(sz);
+				clData.playerStates->Write<UChar>(sz);
 				for(UChar k = 0; k < sz; k++) // TODO: Same as above
 				{
 					InputAction &ka = keyStack[k];
-					packet->Write<unsigned short>(CUInt16(ka.action));
-					packet->Write<char>(ka.task == GLFW_PRESS);
+					clData.playerStates->Write<unsigned short>(CUInt16(ka.action));
+					clData.playerStates->Write<char>(ka.task == GLFW_PRESS);
 				}
 			}
 		}
 	}
-	packet->Write<unsigned char>(numPlayersValid, &posNumPls);
+}
+
+static void write_physics_object_state(NetPacket &packet, const SnapshotPhysicsObject &obj, pragma::networking::SnapshotEntityState *entState, const pragma::networking::SnapshotEntityState *baseEntState, size_t objIdx)
+{
+	if(entState == nullptr) {
+		packet->Write<Vector3>(obj.pos);
+		packet->Write<Quat>(obj.rot);
+		packet->Write<Vector3>(obj.vel);
+		packet->Write<Vector3>(obj.angVel);
+		return;
+	}
+	obj.quantized.WriteDelta(packet, baseEntState ? baseEntState->FindPhysicsObject(objIdx) : nullptr);
+	entState->physicsObjects.push_back(obj.quantized);
+}
+
+// Assembles the final snapshot packet for a client. This only reads the frame and the client's own data
+// and baselines, which means it can safely be executed on a worker thread.
+static NetPacket encode_client_snapshot(const SnapshotFrame &frame, ClientSnapshotData &clData)
+{
+	auto *session = clData.session;
+	NetPacket packet;
+	auto snapshotId = session->SwapSnapshotId();
+	packet->Write<uint8_t>(snapshotId);
+	packet->Write<double>(frame.time);
+
+	// In delta mode all transform and physics states are quantized and only transmitted as
+	// the difference to the last state of the entity the client has acknowledged.
+	auto useDeltaCompression = frame.useDeltaCompression;
+	packet->Write<bool>(useDeltaCompression);
+	auto &ackedStates = session->GetAcknowledgedSnapshotStates();
+	pragma::networking::SnapshotBaseline newBaseline {};
+	if(useDeltaCompression) {
+		newBaseline.snapshotId = snapshotId;
+		newBaseline.snapshotIndex = session->GetSnapshotIndex();
+	}
+	else
+		session->ResetSnapshotBaselines();
+
+	auto *playerData = clData.playerData->GetData();
+	auto offsetNumEntities = packet->GetOffset();
+	packet->Write<unsigned int>(static_cast<unsigned int>(0));
+	unsigned int numEntities = 0;
+	for(auto i = decltype(frame.entities.size()) {0u}; i < frame.entities.size(); ++i) {
+		auto &range = clData.entityRanges[i];
+		if(range.transmit == false)
+			continue;
+		++numEntities;
+		auto &frameEnt = frame.entities[i];
+		auto *ent = frameEnt.entity;
+		nwm::write_entity(packet, ent);
+		pragma::networking::SnapshotEntityState *entState = nullptr;
+		const pragma::networking::SnapshotEntityState *baseEntState = nullptr;
+		if(useDeltaCompression) {
+			// The age of the base state in snapshots, or 0 if the full state is transmitted
+			uint8_t baseAge = 0;
+			entState = &newBaseline.entities[ent->GetIndex()];
+			baseEntState = ackedStates.FindBase(ent->GetIndex(), newBaseline.snapshotIndex, baseAge);
+			packet->Write<uint8_t>(baseAge);
+			entState->state = frameEnt.quantized;
+			entState->state.WriteDelta(packet, baseEntState ? &baseEntState->state : nullptr);
+		}
+		else {
+			nwm::write_vector(packet, frameEnt.pos);
+			nwm::write_vector(packet, frameEnt.vel);
+			nwm::write_vector(packet, frameEnt.angVel);
+			nwm::write_quat(packet, frameEnt.rot);
+		}
+
+		packet->Write<UInt8>(CUInt8(range.entityDataSize));
+		if(range.entityDataSize > 0)
+			packet->Write(playerData + range.entityDataOffset, range.entityDataSize);
+
+		auto flags = pragma::SnapshotFlags::None;
+		if(frameEnt.hasPhysicsData)
+			flags |= pragma::SnapshotFlags::PhysicsData;
+		if(range.numComponents > 0)
+			flags |= pragma::SnapshotFlags::ComponentData;
+		packet->Write<decltype(flags)>(flags);
+
+		if(frameEnt.hasPhysicsData) {
+			packet->Write<uint8_t>(static_cast<uint8_t>(frameEnt.physicsObjects.size()));
+			for(auto j = decltype(frameEnt.physicsObjects.size()) {0u}; j < frameEnt.physicsObjects.size(); ++j)
+				write_physics_object_state(packet, frameEnt.physicsObjects[j], entState, baseEntState, j);
+		}
+
+		if(range.numComponents > 0) {
+			packet->Write<uint8_t>(range.numComponents);
+			packet->Write(playerData + range.componentDataOffset, range.componentDataSize);
+		}
+	}
+
+	packet->Write<unsigned int>(numEntities, &offsetNumEntities);
+
+	packet->Write<unsigned char>(clData.numPlayerStates);
+	if(clData.playerStates->GetSize() > 0)
+		packet->Write(clData.playerStates->GetData(), clData.playerStates->GetSize());
+	if(useDeltaCompression)
+		session->GetSnapshotBaselines().Store(std::move(newBaseline));
+	return packet;
+}
+
+const pragma::networking::SnapshotRelevanceManager &SGame::GetSnapshotRelevanceManager() const { return m_snapshotRelevanceManager; }
+
+void SGame::InitializeWorldData(pragma::asset::WorldData &worldData)
+{
+	Game::InitializeWorldData(worldData);
+	auto *bspTree = worldData.GetBSPTree();
+	m_snapshotRelevanceManager.SetBSPTree(bspTree ? bspTree->shared_from_this() : nullptr);
+}
+
+void SGame::SendSnapshot(pragma::SPlayerComponent *pl)
+{
+	auto *session = pl ? pl->GetClientSession() : nullptr;
+	if(session == nullptr)
+		return;
+	SnapshotFrame frame {};
+	gather_snapshot_frame(*this, frame, session->GetDeferredSnapshotEntities(), m_snapshotIndex);
+	ClientSnapshotData clData {};
+	clData.player = pl;
+	clData.session = session;
+	write_client_snapshot_data(*this, frame, clData);
+	// Every gathered frame needs its own index, otherwise the next broadcast snapshot would be stamped with the same one
+	++m_snapshotIndex;
+	auto packet = encode_client_snapshot(frame, clData);
 	server->SendPacket("snapshot", packet, pragma::networking::Protocol::FastUnreliable, *session);
 }
 
@@ -173,11 +363,48 @@ void SGame::SendSnapshot()
 {
 	//Con::csv<<"Sending snapshot.."<<Con::endl;
 	auto &players = pragma::SPlayerComponent::GetAll();
-	//unsigned char numPlayersValid = 0;
+
+	// The player-independent entity state is only gathered once for all clients
+	std::vector<ClientSnapshotData> clientData;
+	clientData.reserve(players.size());
+	std::unordered_set<uint32_t> deferredEntities;
 	for(auto *plComponent : players) {
-		if(plComponent != nullptr && plComponent->IsGameReady())
-			SendSnapshot(plComponent);
+		if(plComponent == nullptr || plComponent->IsGameReady() == false)
+			continue;
+		auto *session = plComponent->GetClientSession();
+		if(session == nullptr)
+			continue;
+		clientData.push_back({});
+		auto &clData = clientData.back();
+		clData.player = plComponent;
+		clData.session = session;
+		auto &clDeferredEntities = session->GetDeferredSnapshotEntities();
+		deferredEntities.insert(clDeferredEntities.begin(), clDeferredEntities.end());
 	}
+	SnapshotFrame frame {};
+	if(clientData.empty() == false)
+		gather_snapshot_frame(*this, frame, deferredEntities, m_snapshotIndex);
+	for(auto &clData : clientData)
+		write_client_snapshot_data(*this, frame, clData);
+	++m_snapshotIndex;
+
+	// Packet encoding only depends on the frame and the client's own baselines, so each client can be
+	// encoded on a separate worker thread. The packets themselves are sent from the main thread.
+	std::vector<NetPacket> packets;
+	packets.resize(clientData.size());
+	if(clientData.size() > 1) {
+		auto &jobSystem = pragma::get_engine()->GetJobSystem();
+		pragma::JobCounter counter {};
+		for(auto i = decltype(clientData.size()) {0u}; i < clientData.size(); ++i)
+			jobSystem.Schedule([&frame, &clientData, &packets, i]() { packets[i] = encode_client_snapshot(frame, clientData[i]); }, &counter);
+		jobSystem.Wait(counter);
+	}
+	else if(clientData.size() == 1)
+		packets.front() = encode_client_snapshot(frame, clientData.front());
+
+	for(auto i = decltype(clientData.size()) {0u}; i < clientData.size(); ++i)
+		server->SendPacket("snapshot", packets[i], pragma::networking::Protocol::FastUnreliable, *clientData[i].session);
+
 	std::vector<SBaseEntity *> *entities;
 	GetEntities(&entities);
 	for(unsigned int i = 0; i < entities->size(); i++) {
@@ -0,0 +1,44 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#include "stdafx_server.h"
+#include "pragma/game/s_lag_compensation.hpp"
+#include "pragma/game/s_game.h"
+#include "pragma/entities/components/s_character_component.hpp"
+#include "pragma/console/s_cvar.h"
+#include <pragma/entities/entity_iterator.hpp>
+
+static CVar cvMaxRewindTime = GetServerConVar("sv_lag_compensation_max_time");
+
+double pragma::LagCompensationScope::ClampRewindTime(SGame &game, double t)
+{
+	auto curTime = game.CurTime();
+	auto maxRewindTime = static_cast<double>(umath::max(cvMaxRewindTime->GetFloat(), 0.f));
+	return umath::clamp(t, curTime - maxRewindTime, curTime);
+}
+
+pragma::LagCompensationScope::LagCompensationScope(SGame &game, double t, const BaseEntity *exclude)
+{
+	t = ClampRewindTime(game, t);
+	EntityIterator entIt {game};
+	entIt.AttachFilter<TEntityIteratorFilterComponent<pragma::SCharacterComponent>>();
+	for(auto *ent : entIt) {
+		if(ent == exclude)
+			continue;
+		auto charC = ent->GetCharacterComponent();
+		if(charC.valid() && charC->RewindHitboxes(t))
+			m_rewoundCharacters.push_back(charC);
+	}
+}
+
+pragma::LagCompensationScope::~LagCompensationScope()
+{
+	for(auto &hCharC : m_rewoundCharacters) {
+		if(hCharC.valid())
+			hCharC->RestoreHitboxes();
+	}
+}
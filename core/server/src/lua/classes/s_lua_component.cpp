@@ -42,10 +42,9 @@ void SLuaBaseEntityComponent::OnMemberValueChanged(uint32_t memberIdx)
 		return;
 	}
 
-	auto value = GetMemberValue(member);
 	NetPacket p {};
 	p->Write<uint8_t>(nwIndex);
-	Lua::WriteAny(p, detail::member_type_to_util_type(member.type), value);
+	WriteMemberValue(p, member);
 	static_cast<SBaseEntity &>(GetEntity()).SendNetEvent(m_networkedMemberInfo->netEvSetMember, p, pragma::networking::Protocol::SlowReliable);
 }
 void SLuaBaseEntityComponent::SendData(NetPacket &packet, networking::ClientRecipientFilter &rp)
@@ -53,9 +52,7 @@ void SLuaBaseEntityComponent::SendData(NetPacket &packet, networking::ClientReci
 	if(m_networkedMemberInfo != nullptr) {
 		auto &members = GetMembers();
 		for(auto idx : m_networkedMemberInfo->networkedMembers) {
-			auto &member = members.at(idx);
-			auto value = GetMemberValue(member);
-			Lua::WriteAny(packet, detail::member_type_to_util_type(member.type), value);
+			WriteMemberValue(packet, members.at(idx));
 		}
 	}
 
@@ -78,9 +75,7 @@ void SLuaBaseEntityComponent::SendSnapshotData(NetPacket &packet, pragma::BasePl
 	auto &members = GetMembers();
 	if(m_networkedMemberInfo != nullptr) {
 		for(auto idx : m_networkedMemberInfo->snapshotMembers) {
-			auto &member = members.at(idx);
-			auto value = GetMemberValue(member);
-			Lua::WriteAny(packet, detail::member_type_to_util_type(member.type), value);
+			WriteMemberValue(packet, members.at(idx));
 		}
 	}
 	CallLuaMethod<void, NetPacket, luabind::object>("SendSnapshotData", packet, pl.GetLuaObject());
@@ -59,8 +59,32 @@ void pragma::networking::IServerClient::ClearResourceTransfer() { m_resourceTran
 
 uint8_t pragma::networking::IServerClient::SwapSnapshotId()
 {
+	++m_snapshotIndex;
 	return m_snapshotId++; // Overflow doesn't matter
 }
+uint64_t pragma::networking::IServerClient::GetSnapshotIndex() const { return m_snapshotIndex; }
+pragma::networking::SnapshotBaselineRing &pragma::networking::IServerClient::GetSnapshotBaselines() { return m_snapshotBaselines; }
+const pragma::networking::SnapshotAcknowledgedStates &pragma::networking::IServerClient::GetAcknowledgedSnapshotStates() const { return m_acknowledgedSnapshotStates; }
+void pragma::networking::IServerClient::AcknowledgeSnapshot(uint8_t snapshotId)
+{
+	// We'll only accept the acknowledgement if we still have the baseline
+	auto *baseline = m_snapshotBaselines.Find(snapshotId);
+	if(baseline == nullptr)
+		return;
+	m_acknowledgedSnapshotStates.Acknowledge(*baseline);
+}
+void pragma::networking::IServerClient::ResetSnapshotBaselines()
+{
+	m_snapshotBaselines.Clear();
+	m_acknowledgedSnapshotStates.Clear();
+}
+void pragma::networking::IServerClient::RemoveSnapshotEntity(uint32_t entIdx)
+{
+	m_snapshotBaselines.RemoveEntity(entIdx);
+	m_acknowledgedSnapshotStates.RemoveEntity(entIdx);
+	m_deferredSnapshotEntities.erase(entIdx);
+}
+std::unordered_set<uint32_t> &pragma::networking::IServerClient::GetDeferredSnapshotEntities() { return m_deferredSnapshotEntities; }
 
 void pragma::networking::IServerClient::ScheduleResource(const std::string &fileName)
 {
@@ -266,6 +266,13 @@ void ServerState::ReceiveUserInput(pragma::networking::IServerClient &client, Ne
 		}
 	}
 	pl->SetActionInputs(actions, bController);
+
+	// Last snapshot the client has received and decoded; Used as delta baseline for the next snapshots
+	if(packet->Read<bool>())
+		client.AcknowledgeSnapshot(packet->Read<uint8_t>());
+	// The client was unable to decode a delta, the next snapshot will contain the full entity states
+	if(packet->Read<bool>())
+		client.ResetSnapshotBaselines();
 	//Con::csv<<"Action inputs "<<actions<<" for player "<<pl<<" ("<<pl->GetClientSession()->GetIP()<<")"<<Con::endl;
 
 	SendPacket("playerinput", pOut, pragma::networking::Protocol::FastUnreliable, {client, pragma::networking::ClientRecipientFilter::FilterType::Exclude});
@@ -0,0 +1,100 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#include "stdafx_server.h"
+#include "pragma/networking/snapshot_relevance.hpp"
+#include "pragma/entities/components/s_player_component.hpp"
+#include "pragma/console/s_cvar.h"
+#include <pragma/entities/components/base_physics_component.hpp>
+#include <pragma/entities/components/base_transform_component.hpp>
+
+static CVar cvRelevanceEnabled = GetServerConVar("sv_snapshot_relevance_enabled");
+static CVar cvRelevancePvs = GetServerConVar("sv_snapshot_relevance_pvs");
+static CVar cvNearDistance = GetServerConVar("sv_snapshot_relevance_near_distance");
+static CVar cvFarDistance = GetServerConVar("sv_snapshot_relevance_far_distance");
+static CVar cvMaxDistance = GetServerConVar("sv_snapshot_relevance_max_distance");
+
+uint32_t pragma::networking::SnapshotRelevanceManager::GetUpdateInterval(SnapshotRelevance relevance)
+{
+	switch(relevance) {
+	case SnapshotRelevance::High:
+		return 1;
+	case SnapshotRelevance::Medium:
+		return 2;
+	case SnapshotRelevance::Low:
+		return 4;
+	}
+	return 0;
+}
+
+void pragma::networking::SnapshotRelevanceManager::SetBSPTree(const std::shared_ptr<util::BSPTree> &bspTree) { m_bspTree = (bspTree && bspTree->IsValid()) ? bspTree : nullptr; }
+const std::shared_ptr<util::BSPTree> &pragma::networking::SnapshotRelevanceManager::GetBSPTree() const { return m_bspTree; }
+bool pragma::networking::SnapshotRelevanceManager::IsEnabled() const { return cvRelevanceEnabled->GetBool(); }
+
+pragma::networking::SnapshotRelevanceManager::ClientView pragma::networking::SnapshotRelevanceManager::GetClientView(const pragma::SPlayerComponent &pl) const
+{
+	ClientView view {};
+	view.origin = pl.GetViewPos();
+	view.viewEntity = &pl.GetEntity();
+	if(m_bspTree && cvRelevancePvs->GetBool()) {
+		auto *leafNode = m_bspTree->FindLeafNode(view.origin);
+		if(leafNode && leafNode->cluster != std::numeric_limits<util::BSPTree::ClusterIndex>::max())
+			view.cluster = leafNode->cluster;
+	}
+	return view;
+}
+
+void pragma::networking::SnapshotRelevanceManager::InitializeEntityInfo(EntityInfo &info, const BaseEntity &ent, const Vector3 &origin, const BaseEntity *owner) const
+{
+	info.entity = &ent;
+	info.owner = owner;
+	info.origin = origin;
+	info.alwaysRelevant = (ent.GetTransformComponent() == nullptr);
+	info.clusters.clear();
+	if(info.alwaysRelevant || m_bspTree == nullptr || cvRelevancePvs->GetBool() == false)
+		return;
+	// Use the bounding sphere of the entity, so the result is independent of its rotation
+	auto *physC = ent.GetPhysicsComponent();
+	auto radius = physC ? physC->GetCollisionRadius() : 0.f;
+	Vector3 extents {radius, radius, radius};
+	for(auto *node : m_bspTree->FindLeafNodesInAabb(origin - extents, origin + extents)) {
+		if(node->cluster == std::numeric_limits<util::BSPTree::ClusterIndex>::max())
+			continue;
+		if(std::find(info.clusters.begin(), info.clusters.end(), node->cluster) == info.clusters.end())
+			info.clusters.push_back(node->cluster);
+	}
+}
+
+pragma::networking::SnapshotRelevance pragma::networking::SnapshotRelevanceManager::GetRelevance(const ClientView &view, const EntityInfo &info) const
+{
+	if(info.alwaysRelevant || IsEnabled() == false)
+		return SnapshotRelevance::High;
+	// The client's own entity and everything it owns (e.g. weapons) is always relevant
+	if(info.entity == view.viewEntity || (info.owner != nullptr && info.owner == view.viewEntity))
+		return SnapshotRelevance::High;
+	if(view.cluster.has_value() && info.clusters.empty() == false) {
+		auto isVisible = std::find_if(info.clusters.begin(), info.clusters.end(), [this, &view](util::BSPTree::ClusterIndex cluster) { return m_bspTree->IsClusterVisible(*view.cluster, cluster); }) != info.clusters.end();
+		if(isVisible == false)
+			return SnapshotRelevance::None;
+	}
+	auto distSqr = uvec::length_sqr(info.origin - view.origin);
+	auto maxDist = cvMaxDistance->GetFloat();
+	if(maxDist > 0.f && distSqr > umath::pow2(maxDist))
+		return SnapshotRelevance::None;
+	if(distSqr <= umath::pow2(cvNearDistance->GetFloat()))
+		return SnapshotRelevance::High;
+	if(distSqr <= umath::pow2(cvFarDistance->GetFloat()))
+		return SnapshotRelevance::Medium;
+	return SnapshotRelevance::Low;
+}
+
+bool pragma::networking::SnapshotRelevanceManager::ShouldTransmit(const ClientView &view, const EntityInfo &info, uint32_t snapshotIndex) const
+{
+	auto interval = GetUpdateInterval(GetRelevance(view, info));
+	if(interval == 0)
+		return false;
+	return ((snapshotIndex + info.entity->GetIndex()) % interval) == 0;
+}
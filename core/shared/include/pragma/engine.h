@@ -54,6 +54,9 @@ namespace util {
 namespace pragma::asset {
 	class AssetManager;
 };
+namespace pragma {
+	class JobSystem;
+};
 class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
   public:
 	static const uint32_t DEFAULT_TICK_RATE;
@@ -156,6 +159,19 @@ class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
 	long long GetDeltaTick() const;
 	UInt32 GetTickRate() const;
 	void SetTickRate(UInt32 tickRate);
+	// Timing statistics of the main loop ticks
+	struct DLLNETWORK TickStats {
+		uint64_t tickCount = 0;
+		// Number of ticks that took longer than the tick interval
+		uint64_t overrunCount = 0;
+		// Number of ticks that were skipped because the main loop fell too far behind
+		uint64_t droppedTickCount = 0;
+		std::chrono::nanoseconds lastTickDuration {0};
+		std::chrono::nanoseconds maxTickDuration {0};
+		std::chrono::nanoseconds totalTickDuration {0};
+	};
+	const TickStats &GetTickStats() const;
+	void ResetTickStats();
 	bool IsGameActive();
 	virtual bool IsServerOnly();
 	virtual bool IsClientConnected();
@@ -229,6 +245,8 @@ class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
 
 	pragma::asset::AssetManager &GetAssetManager();
 	const pragma::asset::AssetManager &GetAssetManager() const;
+	// Job system shared by all multi-threaded engine systems (animation, render queues, etc.)
+	pragma::JobSystem &GetJobSystem();
 
 	// For internal use only
 	void SetReplicatedConVar(const std::string &cvar, const std::string &val);
@@ -271,8 +289,10 @@ class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
 	ChronoTime m_ctTick;
 	long long m_lastTick;
 	uint64_t m_tickCount = 0;
+	TickStats m_tickStats {};
 	std::shared_ptr<VFilePtrInternalReal> m_logFile;
 	std::unique_ptr<pragma::asset::AssetManager> m_assetManager;
+	std::unique_ptr<pragma::JobSystem> m_jobSystem;
 
 	struct JobInfo {
 		util::ParallelJobWrapper job = {};
@@ -11,6 +11,8 @@
 #include "pragma/entities/entity_component_event.hpp"
 #include "pragma/physics/physobj.h"
 #include <sharedutils/property/util_property.hpp>
+#include <mathutil/transform.hpp>
+#include <array>
 
 namespace pragma {
 	namespace physics {
@@ -39,6 +41,15 @@ namespace pragma {
 		bool FindHitgroup(const physics::ICollisionObject &phys, HitGroup &hitgroup) const;
 		PhysObjHandle GetHitboxPhysicsObject() const;
 
+		// Number of ticks for which the hitbox transforms are kept (server only), used for lag compensation
+		static constexpr uint32_t HITBOX_HISTORY_SIZE = 64;
+		// Moves the hitboxes back to where they were at time t (interpolated between the recorded ticks).
+		// RestoreHitboxes has to be called afterwards to move them back to their current state.
+		bool RewindHitboxes(double t);
+		void RestoreHitboxes();
+		// Time of the oldest recorded hitbox state
+		std::optional<double> GetHitboxHistoryStartTime() const;
+
 		const util::PBoolProperty &GetFrozenProperty() const;
 
 		void SetMoveController(const std::string &moveController);
@@ -65,6 +76,22 @@ namespace pragma {
 		pragma::NetEventId m_netEvSetFrozen = pragma::INVALID_NET_EVENT;
 		std::vector<HitboxData> m_hitboxData;
 		std::unique_ptr<PhysObj> m_physHitboxes;
+
+		struct DLLNETWORK HitboxHistoryEntry {
+			double time = 0.0;
+			std::vector<umath::Transform> transforms;
+		};
+		// Ring buffer, m_hitboxHistoryHead is the index of the next entry to be written
+		std::array<HitboxHistoryEntry, HITBOX_HISTORY_SIZE> m_hitboxHistory {};
+		uint32_t m_hitboxHistoryHead = 0;
+		uint32_t m_hitboxHistoryCount = 0;
+		std::vector<umath::Transform> m_hitboxRestoreTransforms;
+		bool m_hitboxHistoryEnabled = false;
+		bool m_hitboxesRewound = false;
+		const HitboxHistoryEntry &GetHitboxHistoryEntry(uint32_t age) const;
+		void RecordHitboxHistory(double t);
+		void ClearHitboxHistory();
+		void ApplyHitboxTransforms(const std::vector<umath::Transform> &transforms);
 		virtual void OnPhysicsInitialized();
 		virtual void OnPhysicsDestroyed();
 		virtual void PhysicsUpdate(double tDelta);
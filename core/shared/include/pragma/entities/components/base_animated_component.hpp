@@ -12,6 +12,7 @@
 #include "pragma/model/animation/play_animation_flags.hpp"
 #include "pragma/model/animation/activities.h"
 #include "pragma/model/animation/animation_event.h"
+#include "pragma/model/animation/bone_pose_blend.hpp"
 #include <sharedutils/property/util_property.hpp>
 #include <pragma/math/orientation.h>
 #include <mathutil/transform.hpp>
@@ -56,7 +57,7 @@ namespace pragma {
 		static ComponentEventId EVENT_ON_ANIMATIONS_UPDATED;
 		static void RegisterEvents(pragma::EntityComponentManager &componentManager, TRegisterComponentEvent registerEvent);
 
-		enum class StateFlags : uint8_t { None = 0u, AbsolutePosesDirty = 1u, BaseAnimationDirty = AbsolutePosesDirty << 1u, IsAnimated = BaseAnimationDirty << 1u };
+		enum class StateFlags : uint8_t { None = 0u, AbsolutePosesDirty = 1u, BaseAnimationDirty = AbsolutePosesDirty << 1u, IsAnimated = BaseAnimationDirty << 1u, DeferMainThreadEvents = IsAnimated << 1u };
 
 		struct DLLNETWORK AnimationSlotInfo {
 		  public:
@@ -220,7 +221,10 @@ namespace pragma {
 
 		bool PreMaintainAnimations(double dt);
 		virtual bool MaintainAnimations(double dt);
+		// May be called from a job system worker. Bone transform events and random animation selections are deferred
+		// until FlushDeferredAnimationEvents is called on the main thread.
 		void UpdateAnimations(double dt);
+		void FlushDeferredAnimationEvents();
 		bool MaintainGestures(double dt);
 
 		virtual bool GetVertexTransformMatrix(const ModelSubMesh &subMesh, uint32_t vertexId, umath::ScaledTransform &outPose) const;
@@ -281,7 +285,10 @@ namespace pragma {
 		void HandleAnimationEvent(const AnimationEvent &ev);
 		void PlayLayeredAnimation(int slot, int animation, FPlayAnim flags, AnimationSlotInfo **animInfo);
 		void GetAnimationBlendController(pragma::animation::Animation *anim, float cycle, std::array<AnimationBlendInfo, 2> &bcFrames, float *blendScale) const;
-		Frame *GetPreviousAnimationBlendFrame(AnimationSlotInfo &animInfo, double tDelta, float &blendScale);
+		bool GetPreviousAnimationBlendFrame(AnimationSlotInfo &animInfo, double tDelta, float &blendScale, std::shared_ptr<pragma::animation::Animation> &outAnim, uint32_t &outFrame);
+		// Samples the interpolated bone poses at the specified cycle. Compressed animations are sampled directly, without decompressing their frames.
+		bool SampleAnimation(pragma::animation::Animation &anim, float cycle, std::vector<umath::Transform> &outPoses, std::vector<Vector3> &outScales, pragma::animation::Animation *optWeightAnim = nullptr) const;
+		static bool SampleAnimationFrame(pragma::animation::Animation &anim, uint32_t frameIdx, std::vector<umath::Transform> &outPoses, std::vector<Vector3> &outScales);
 
 		// Animations
 		void TransformBoneFrames(std::vector<umath::Transform> &bonePoses, std::vector<Vector3> *boneScales, pragma::animation::Animation &anim, Frame *frameBlend, bool bAdd = true);
@@ -295,6 +302,7 @@ namespace pragma {
 		Vector3 m_animDisplacement = {};
 		std::vector<umath::ScaledTransform> m_bones = {};
 		std::vector<umath::ScaledTransform> m_processedBones = {}; // Bone positions / rotations in entity space
+		pragma::animation::FlatBoneHierarchy m_flatBoneHierarchy {};
 	  protected:
 		// We have to collect the animation events for the current frame and execute them after ALL animations have been completed (In case some events need to access animation data)
 		std::queue<AnimationEventQueueItem> m_animEventQueue = std::queue<AnimationEventQueueItem> {};
@@ -314,6 +322,20 @@ namespace pragma {
 		};
 		std::queue<ComponentEventQueueInfo> m_queuedEvents;
 
+		// Main-thread work collected while StateFlags::DeferMainThreadEvents is set
+		struct DeferredBoneTransformEvent {
+			uint32_t boneId;
+			bool scale;
+		};
+		struct DeferredAnimationSelection {
+			int32_t layeredSlot;
+			Activity activity;
+			int32_t animAvoid;
+		};
+		std::vector<DeferredBoneTransformEvent> m_deferredBoneTransformEvents;
+		std::vector<DeferredAnimationSelection> m_deferredAnimationSelections;
+		void InvokeBoneTransformChanged(uint32_t boneId, const Vector3 *pos, const Quat *rot, const Vector3 *scale);
+
 		StateFlags m_stateFlags = StateFlags::AbsolutePosesDirty;
 		std::shared_ptr<const Frame> m_bindPose = nullptr;
 		std::unordered_map<unsigned int, float> m_blendControllers = {};
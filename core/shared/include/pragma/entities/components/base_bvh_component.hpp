@@ -20,10 +20,20 @@ namespace pragma {
 		float v;
 	};
 
+	struct DLLNETWORK BvhRay {
+		Vector3 origin;
+		Vector3 dir;
+		float minDist = 0.f;
+		float maxDist = std::numeric_limits<float>::max();
+	};
+
 	struct BvhMeshIntersectionInfo;
 	struct DLLNETWORK BvhIntersectionInfo {
 		void Clear();
 		std::vector<size_t> primitives;
+		// Data the primitive indices refer to, if the BVH can be replaced in the background (e.g. the static BVH cache).
+		// Keeps the data alive, so the primitives can still be resolved after a newer build has been published.
+		std::shared_ptr<const void> source = nullptr;
 
 		BvhMeshIntersectionInfo *GetMeshIntersectionInfo();
 	  protected:
@@ -56,7 +66,10 @@ namespace pragma {
 		BvhTriangle(const Vector3 &p0, const Vector3 &p1, const Vector3 &p2) : p0(p0), e1(p0 - p1), e2(p2 - p0) { n = cross(e1, e2); }
 	};
 
+	enum class BvhUpdateResult : uint8_t { Failed = 0, Refitted, Rebuilt };
+
 	struct BvhData;
+	struct BvhHierarchy;
 	class BaseStaticBvhCacheComponent;
 	DLLNETWORK std::vector<BvhMeshRange> &get_bvh_mesh_ranges(BvhData &bvhData);
 	class DLLNETWORK BaseBvhComponent : public BaseEntityComponent {
@@ -71,23 +84,38 @@ namespace pragma {
 		virtual ~BaseBvhComponent() override;
 		std::optional<BvhHitInfo> IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist) const;
 		virtual bool IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist, BvhHitInfo &outHitInfo) const;
-		bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max) const;
-		bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max, BvhIntersectionInfo &outIntersectionInfo) const;
-		bool IntersectionTestKDop(const std::vector<umath::Plane> &planes) const;
-		bool IntersectionTestKDop(const std::vector<umath::Plane> &planes, BvhIntersectionInfo &outIntersectionInfo) const;
+		// Tests multiple rays at once. The rays are traversed in packets, which is considerably faster than testing them individually if
+		// they are coherent (e.g. rays for picking or with similar origins). outHits receives the closest hit for each ray, the number of rays with a hit is returned.
+		virtual uint32_t IntersectionTestBatch(const std::vector<BvhRay> &rays, std::vector<std::optional<BvhHitInfo>> &outHits) const;
+		virtual bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max) const;
+		virtual bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max, BvhIntersectionInfo &outIntersectionInfo) const;
+		virtual bool IntersectionTestKDop(const std::vector<umath::Plane> &planes) const;
+		virtual bool IntersectionTestKDop(const std::vector<umath::Plane> &planes, BvhIntersectionInfo &outIntersectionInfo) const;
 		void SetStaticCache(BaseStaticBvhCacheComponent *staticCache);
 		virtual bool IsStaticBvh() const { return false; }
-		const BvhMeshRange *FindPrimitiveMeshInfo(size_t primIdx) const;
+		virtual const BvhMeshRange *FindPrimitiveMeshInfo(size_t primIdx) const;
+		// Same as above, but resolves the primitive index against the data the intersection test was performed on
+		virtual const BvhMeshRange *FindPrimitiveMeshInfo(const BvhIntersectionInfo &intersectionInfo, size_t primIdx) const;
 
 		void SendBvhUpdateRequestOnInteraction();
 		static bool SetVertexData(pragma::BvhData &bvhData, const std::vector<BvhTriangle> &data);
 		bool SetVertexData(const std::vector<BvhTriangle> &data);
+		// Same as SetVertexData, but rebuilds the hierarchy if the SAH cost of the refitted hierarchy exceeds the cost after the last
+		// full build by more than maxSahCostRatio. A ratio <= 0 disables rebuilds.
+		static BvhUpdateResult RefitVertexData(pragma::BvhData &bvhData, const std::vector<BvhTriangle> &data, float maxSahCostRatio);
 		void RebuildBvh();
 		void ClearBvh();
-		std::optional<Vector3> GetVertex(size_t idx) const;
+		virtual std::optional<Vector3> GetVertex(size_t idx) const;
+		virtual std::optional<Vector3> GetVertex(const BvhIntersectionInfo &intersectionInfo, size_t idx) const;
 
 		// For internal use only
-		static std::shared_ptr<pragma::BvhData> RebuildBvh(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes, const std::vector<umath::ScaledTransform> *optPoses = nullptr, const std::function<bool()> &fIsCancelled = nullptr, std::vector<size_t> *optOutMeshIndices = nullptr);
+		// If optHierarchy is specified and matches the primitive count, its topology is used instead of building a new hierarchy
+		static std::shared_ptr<pragma::BvhData> RebuildBvh(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes, const std::vector<umath::ScaledTransform> *optPoses = nullptr, const std::function<bool()> &fIsCancelled = nullptr,
+		  std::vector<size_t> *optOutMeshIndices = nullptr, const BvhHierarchy *optHierarchy = nullptr);
+		// Same as above, but uses the prebuilt hierarchy stored in the model if it is up to date with the meshes.
+		// If storeIfMissing is true, a newly built hierarchy is stored in the model, so it is written to disk the next time
+		// the model is saved. This should only be used by tools (e.g. bvh_generate_model_data), not for models in use at runtime.
+		static std::shared_ptr<pragma::BvhData> RebuildBvh(Model &mdl, const std::vector<std::shared_ptr<ModelSubMesh>> &meshes, bool storeIfMissing = false);
 		std::shared_ptr<BvhData> SetBvhData(std::shared_ptr<BvhData> &bvhData);
 		bool HasBvhData() const;
 	  protected:
@@ -8,6 +8,7 @@
 #define __BASE_ENTITY_COMPONENT_HPP__
 
 #include "pragma/entities/components/base_entity_component_handle_wrapper.hpp"
+#include "pragma/entities/components/component_event_dispatch_table.hpp"
 #include "pragma/entities/entity_component_event.hpp"
 #include "pragma/entities/entity_component_event_info.hpp"
 #include "pragma/entities/entity_component_info.hpp"
@@ -48,6 +49,7 @@ namespace pragma {
 	struct ComponentEvent;
 	class BaseEntityComponentSystem;
 	class EntityComponentManager;
+	class EntityTickScheduler;
 	struct ComponentMemberInfo;
 	using ComponentMemberIndex = uint32_t;
 
@@ -60,6 +62,8 @@ namespace pragma {
 		TickPolicy tickPolicy = TickPolicy::Never;
 		double lastTick = 0.0;
 		double nextTick = 0.0;
+		// Index of the component within the EntityTickScheduler, for internal use only
+		uint32_t schedulerSlot = std::numeric_limits<uint32_t>::max();
 	};
 
 	class DLLNETWORK BaseEntityComponent : public pragma::BaseLuaHandle, public std::enable_shared_from_this<BaseEntityComponent> {
@@ -205,6 +209,7 @@ namespace pragma {
 	  protected:
 		friend EntityComponentManager;
 		friend BaseEntityComponentSystem;
+		friend EntityTickScheduler;
 		BaseEntityComponent(BaseEntity &ent);
 		void UpdateTickPolicy();
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData);
@@ -229,10 +234,13 @@ namespace pragma {
 			BaseEntityComponent *pComponent = nullptr;
 		};
 		ComponentId m_componentId = std::numeric_limits<ComponentId>::max();
+		// Slot index in the component pool of the component type, if the component was allocated from one
+		static constexpr uint32_t INVALID_POOL_INDEX = std::numeric_limits<uint32_t>::max();
+		uint32_t m_poolIndex = INVALID_POOL_INDEX;
 
 		std::vector<CallbackInfo> &GetCallbackInfos() const;
-		std::unordered_map<ComponentEventId, std::vector<CallbackHandle>> &GetEventCallbacks() const;
-		std::unordered_map<ComponentEventId, std::vector<CallbackHandle>> &GetBoundEvents() const;
+		ComponentEventDispatchTable &GetEventCallbacks() const;
+		ComponentEventDispatchTable &GetBoundEvents() const;
 	  protected:
 		void OnEntityComponentAdded(BaseEntityComponent &component, bool bSkipEventBinding);
 		BaseEntity &m_entity;
@@ -243,8 +251,8 @@ namespace pragma {
 		friend BaseEntityComponentSystem;
 
 		mutable std::unique_ptr<std::vector<CallbackInfo>> m_callbackInfos;
-		mutable std::unique_ptr<std::unordered_map<ComponentEventId, std::vector<CallbackHandle>>> m_eventCallbacks;
-		mutable std::unique_ptr<std::unordered_map<ComponentEventId, std::vector<CallbackHandle>>> m_boundEvents;
+		mutable std::unique_ptr<ComponentEventDispatchTable> m_eventCallbacks;
+		mutable std::unique_ptr<ComponentEventDispatchTable> m_boundEvents;
 	};
 };
 REGISTER_BASIC_BITWISE_OPERATORS(pragma::BaseEntityComponent::StateFlags)
@@ -126,6 +126,11 @@ namespace pragma {
 #endif
 		virtual void PrePhysicsSimulate();
 		virtual bool PostPhysicsSimulate();
+		// Stores the current pose of the physics object as the pose prior to the specified physics step. For internal use only.
+		void StorePreviousPhysicsPose(uint64_t physicsStepIndex);
+		// Returns the pose interpolated between the pose before the most recent physics step and the current pose, or
+		// an empty optional if the physics object wasn't simulated in the most recent physics step.
+		std::optional<umath::Transform> GetInterpolatedPhysicsPose(float factor) const;
 		virtual void SetKinematic(bool b);
 		bool IsKinematic() const;
 		virtual void OnPhysicsWake(PhysObj *phys);
@@ -251,6 +256,8 @@ namespace pragma {
 		float m_colRadius = 0.f;
 		Vector3 m_colMin = {};
 		Vector3 m_colMax = {};
+		umath::Transform m_prevPhysicsPose {};
+		uint64_t m_prevPhysicsPoseStepIndex = std::numeric_limits<uint64_t>::max();
 	  private:
 		void ClearAwakeStatus();
 	};
@@ -266,6 +273,8 @@ namespace pragma {
 		virtual uint32_t GetReturnCount() override;
 		virtual void HandleReturnValues(lua_State *l) override;
 		bool keepAwake = true;
+		// See Game::GetPhysicsInterpolationFactor
+		float interpolationFactor = 1.f;
 	};
 };
 REGISTER_BASIC_BITWISE_OPERATORS(pragma::BasePhysicsComponent::StateFlags);
@@ -11,6 +11,7 @@
 #include "pragma/entities/baseentity_handle.h"
 #include "pragma/entities/baseentity_net_event_manager.hpp"
 #include <typeindex>
+#include <optional>
 #include <mathutil/uvec.h>
 
 struct BulletInfo;
@@ -58,6 +59,8 @@ namespace pragma {
 		struct DLLNETWORK NextBulletInfo {
 			std::vector<Vector3> destinations;
 			EntityHandle source;
+			// Server time of the world state the shooting client was seeing when it fired, used for lag compensation
+			std::optional<double> clientViewTime {};
 		};
 		mutable std::unique_ptr<NextBulletInfo> m_nextBullet = nullptr;
 		void ReceiveBulletEvent(NetPacket &packet, pragma::BasePlayerComponent *pl = nullptr);
@@ -10,10 +10,18 @@
 #include "pragma/entities/components/base_bvh_component.hpp"
 #include "pragma/util/util_thread_pool.hpp"
 #include <unordered_set>
+#include <unordered_map>
+#include <atomic>
 
 class FunctionalParallelWorker;
 namespace pragma {
 	class BaseStaticBvhUserComponent;
+	struct StaticBvhEntityData;
+	struct StaticBvhSnapshot;
+	// Two-level BVH over all static entities. Each entity has its own sub-BVH (in world space), which are combined
+	// by a small top-level BVH over the entity bounds. If an entity changes, only its sub-BVH and the top-level BVH
+	// are rebuilt. Rebuilds run in the background, queries use the last completed snapshot until the new one
+	// has been published.
 	class DLLNETWORK BaseStaticBvhCacheComponent : public BaseBvhComponent {
 	  public:
 		virtual void Initialize() override;
@@ -29,18 +37,44 @@ namespace pragma {
 
 		virtual bool IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist, BvhHitInfo &outHitInfo) const override;
 		using BaseBvhComponent::IntersectionTest;
+		virtual uint32_t IntersectionTestBatch(const std::vector<BvhRay> &rays, std::vector<std::optional<BvhHitInfo>> &outHits) const override;
+		virtual bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max) const override;
+		virtual bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max, BvhIntersectionInfo &outIntersectionInfo) const override;
+		virtual bool IntersectionTestKDop(const std::vector<umath::Plane> &planes) const override;
+		virtual bool IntersectionTestKDop(const std::vector<umath::Plane> &planes, BvhIntersectionInfo &outIntersectionInfo) const override;
+		virtual const BvhMeshRange *FindPrimitiveMeshInfo(size_t primIdx) const override;
+		virtual const BvhMeshRange *FindPrimitiveMeshInfo(const BvhIntersectionInfo &intersectionInfo, size_t primIdx) const override;
+		virtual std::optional<Vector3> GetVertex(size_t idx) const override;
+		virtual std::optional<Vector3> GetVertex(const BvhIntersectionInfo &intersectionInfo, size_t idx) const override;
+
+		// Publishes the result of a completed background build and starts a new build if the cache is dirty.
+		// Called every tick while the cache is dirty; Queries never start or publish builds themselves.
+		void UpdateBuild();
+		// Blocks until the current background build has completed and publishes the result
+		void WaitForBuild();
+		bool IsBuildInProgress() const;
 
 		virtual bool IsStaticBvh() const override { return true; }
 	  protected:
 		BaseStaticBvhCacheComponent(BaseEntity &ent);
-		void UpdateBuild();
+		void StartBuild();
+		bool PublishBuildResult();
+		std::shared_ptr<const StaticBvhSnapshot> GetSnapshot() const;
 
-		void Build(std::vector<std::shared_ptr<ModelSubMesh>> &&meshes, std::vector<BaseEntity *> &&meshToEntity, std::vector<umath::ScaledTransform> &&meshPoses);
-
-		virtual void TestRebuildBvh() = 0;
+		virtual void CollectEntityMeshes(BaseEntity &ent, std::vector<std::shared_ptr<ModelSubMesh>> &outMeshes) const = 0;
 		bool m_staticBvhDirty = true;
 		std::shared_ptr<FunctionalParallelWorker> m_buildWorker = nullptr;
 		std::unordered_set<BaseStaticBvhUserComponent *> m_entities;
+
+		// Entities whose sub-BVH has to be rebuilt with the next build
+		std::unordered_set<BaseEntity *> m_dirtyEntities;
+		// Most recent sub-BVH of every entity in the cache (nullptr if it hasn't been built yet)
+		std::unordered_map<BaseEntity *, std::shared_ptr<const StaticBvhEntityData>> m_entityBvhData;
+		// Snapshot used for queries and the result of the last background build that hasn't been published yet.
+		// Both are protected by m_bvhDataMutex.
+		std::shared_ptr<const StaticBvhSnapshot> m_snapshot = nullptr;
+		std::shared_ptr<StaticBvhSnapshot> m_pendingSnapshot = nullptr;
+		std::atomic<bool> m_buildInProgress = false;
 	};
 };
 
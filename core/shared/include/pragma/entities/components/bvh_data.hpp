@@ -0,0 +1,222 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#ifndef __BVH_DATA_HPP__
+#define __BVH_DATA_HPP__
+
+// Internal header, only to be included by source files of the shared library
+#include "pragma/entities/components/base_bvh_component.hpp"
+#include <bvh/bvh.hpp>
+#include <bvh/triangle.hpp>
+#include <bvh/sweep_sah_builder.hpp>
+#include <bvh/single_ray_traverser.hpp>
+#include <bvh/primitive_intersectors.hpp>
+#include <array>
+
+class Model;
+namespace pragma {
+	using BvhPrimitive = bvh::Triangle<float>;
+
+	// Node of the flattened hierarchy. The layout matches the nodes of bvh::Bvh (the children of an inner node are stored next to each other),
+	// but the bounds are stored as min/max vectors and each node is packed into 32 bytes, so two nodes share a cache line.
+	struct alignas(32) BvhFlatNode {
+		Vector3 min;
+		uint32_t firstChildOrPrimitive;
+		Vector3 max;
+		uint32_t primitiveCount;
+		bool IsLeaf() const { return primitiveCount != 0; }
+	};
+	static_assert(sizeof(BvhFlatNode) == 32);
+	void build_flat_bvh_nodes(const bvh::Bvh<float> &bvh, std::vector<BvhFlatNode> &outNodes);
+
+	// Computes the distances at which a ray enters and leaves the slab between two box planes. If the ray is parallel to the planes
+	// and its origin lies on one of them, the distance is 0 * inf = NaN; The ray lies within the closed slab in that case, so the
+	// axis doesn't constrain it. Branch-free, so it can be used in vectorized loops.
+	inline void get_slab_interval(float planeMin, float planeMax, float origin, float invDir, float &outNear, float &outFar)
+	{
+		auto t0 = (planeMin - origin) * invDir;
+		auto t1 = (planeMax - origin) * invDir;
+		auto isUnconstrained = (t0 != t0) || (t1 != t1);
+		outNear = isUnconstrained ? -std::numeric_limits<float>::infinity() : std::min(t0, t1);
+		outFar = isUnconstrained ? std::numeric_limits<float>::infinity() : std::max(t0, t1);
+	}
+
+	struct BvhRayPacket {
+		static constexpr uint32_t SIZE = 8;
+		void Initialize(const BvhRay *rays, uint32_t count);
+		uint32_t GetCount() const { return m_count; }
+		uint32_t GetActiveMask() const { return (m_count == SIZE) ? ((1u << SIZE) - 1u) : ((1u << m_count) - 1u); }
+		// Returns the mask of the rays in rayMask which intersect the box
+		uint32_t IntersectAabb(const Vector3 &min, const Vector3 &max, uint32_t rayMask) const;
+		bvh::Ray<float> GetRay(uint32_t idx) const;
+		void SetMaxDistance(uint32_t idx, float maxDist) { m_maxDist[idx] = maxDist; }
+	  private:
+		// Structure of arrays with a fixed size, so the box tests can be vectorized by the compiler
+		alignas(32) std::array<float, SIZE> m_originX;
+		alignas(32) std::array<float, SIZE> m_originY;
+		alignas(32) std::array<float, SIZE> m_originZ;
+		alignas(32) std::array<float, SIZE> m_dirX;
+		alignas(32) std::array<float, SIZE> m_dirY;
+		alignas(32) std::array<float, SIZE> m_dirZ;
+		alignas(32) std::array<float, SIZE> m_invDirX;
+		alignas(32) std::array<float, SIZE> m_invDirY;
+		alignas(32) std::array<float, SIZE> m_invDirZ;
+		alignas(32) std::array<float, SIZE> m_minDist;
+		alignas(32) std::array<float, SIZE> m_maxDist;
+		uint32_t m_count = 0;
+	};
+	struct BvhPacketHit {
+		size_t primitiveIndex;
+		BvhPrimitive::IntersectionType intersection;
+		// Index of the hierarchy the hit belongs to, as specified by the caller of intersect_bvh_packet
+		size_t sourceIndex;
+	};
+	using BvhPacketHits = std::array<std::optional<BvhPacketHit>, BvhRayPacket::SIZE>;
+
+	constexpr size_t BVH_TRAVERSAL_STACK_SIZE = 128;
+	// Iterative depth-first traversal of a flattened hierarchy. testAabb(const Vector3 &min, const Vector3 &max) decides
+	// whether a node is entered, visitLeaf(const BvhFlatNode &leaf) is called for every leaf that passes the test and
+	// can return false to end the traversal.
+	template<typename TTestAabb, typename TVisitLeaf>
+	void traverse_bvh(const std::vector<BvhFlatNode> &nodes, const TTestAabb &testAabb, const TVisitLeaf &visitLeaf, uint32_t startNodeIdx = 0)
+	{
+		if(startNodeIdx >= nodes.size())
+			return;
+		std::array<uint32_t, BVH_TRAVERSAL_STACK_SIZE> stack;
+		size_t stackSize = 0;
+		stack[stackSize++] = startNodeIdx;
+		while(stackSize > 0) {
+			auto &node = nodes[stack[--stackSize]];
+			if(!testAabb(node.min, node.max))
+				continue;
+			if(node.IsLeaf()) {
+				if(!visitLeaf(node))
+					return;
+				continue;
+			}
+			assert(stackSize + 2 <= stack.size());
+			stack[stackSize++] = node.firstChildOrPrimitive + 1;
+			stack[stackSize++] = node.firstChildOrPrimitive;
+		}
+	}
+	// Same as traverse_bvh, but for all rays of a packet at once. visitLeaf(const BvhFlatNode &leaf, uint32_t rayMask) is called
+	// with the mask of the rays which intersect the leaf bounds.
+	template<typename TVisitLeaf>
+	void traverse_bvh_packet(const std::vector<BvhFlatNode> &nodes, const BvhRayPacket &packet, uint32_t rayMask, const TVisitLeaf &visitLeaf)
+	{
+		if(nodes.empty() || rayMask == 0)
+			return;
+		struct StackItem {
+			uint32_t nodeIdx;
+			uint32_t rayMask;
+		};
+		std::array<StackItem, BVH_TRAVERSAL_STACK_SIZE> stack;
+		size_t stackSize = 0;
+		stack[stackSize++] = {0, rayMask};
+		while(stackSize > 0) {
+			auto item = stack[--stackSize];
+			auto &node = nodes[item.nodeIdx];
+			// The maximum distances may have been reduced by hits since the node was pushed, so the test has to be repeated
+			auto nodeRayMask = packet.IntersectAabb(node.min, node.max, item.rayMask);
+			if(nodeRayMask == 0)
+				continue;
+			if(node.IsLeaf()) {
+				visitLeaf(node, nodeRayMask);
+				continue;
+			}
+			assert(stackSize + 2 <= stack.size());
+			stack[stackSize++] = {node.firstChildOrPrimitive + 1, nodeRayMask};
+			stack[stackSize++] = {node.firstChildOrPrimitive, nodeRayMask};
+		}
+	}
+
+	constexpr uint32_t PREBUILT_BVH_VERSION = 1;
+	// Maximum depth of a prebuilt hierarchy. Deeper hierarchies would overflow the stack of the bvh library's single ray
+	// traverser (64 entries) and of the packet traversal (two entries per level, see BVH_TRAVERSAL_STACK_SIZE).
+	constexpr size_t PREBUILT_BVH_MAX_DEPTH = 64;
+	static_assert(PREBUILT_BVH_MAX_DEPTH * 2 <= BVH_TRAVERSAL_STACK_SIZE);
+	// Topology of a hierarchy without the node bounds. It can be stored with a model and applied to the same meshes again
+	// without having to run the SAH builder. The bounds are re-computed from the primitives when the hierarchy is applied.
+	struct BvhHierarchy {
+		struct Node {
+			uint32_t primitiveCount;
+			uint32_t firstChildOrPrimitive;
+		};
+		static std::shared_ptr<BvhHierarchy> Create(const bvh::Bvh<float> &bvh, uint64_t meshHash);
+		// Checks that all child and primitive indices are in range and that the hierarchy isn't deeper than
+		// PREBUILT_BVH_MAX_DEPTH, so that a corrupted hierarchy can't be applied
+		bool IsValid() const;
+		void Apply(bvh::Bvh<float> &bvh) const;
+
+		// Hash of the meshes the hierarchy was built from (see calc_bvh_mesh_hash)
+		uint64_t meshHash = 0;
+		std::vector<Node> nodes;
+		std::vector<uint32_t> primitiveIndices;
+	};
+	// Hash over the triangle geometry of the meshes, used to detect stored hierarchies which are out of date
+	uint64_t calc_bvh_mesh_hash(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes);
+	// Key of the hierarchy for the specified meshes in the model extension data
+	std::string get_prebuilt_bvh_key(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes);
+	// Returns nullptr if the model has no valid hierarchy with the key. The mesh hash is not validated.
+	std::shared_ptr<BvhHierarchy> load_prebuilt_bvh(const Model &mdl, const std::string &key);
+	void store_prebuilt_bvh(Model &mdl, const std::string &key, const BvhHierarchy &hierarchy);
+
+	struct BvhData {
+		struct IntersectorData {
+			IntersectorData(bvh::SweepSahBuilder<bvh::Bvh<float>> builder, bvh::ClosestPrimitiveIntersector<bvh::Bvh<float>, bvh::Triangle<float>> primitiveIntersector, bvh::SingleRayTraverser<bvh::Bvh<float>> traverser)
+			    : builder {std::move(builder)}, primitiveIntersector {std::move(primitiveIntersector)}, traverser {std::move(traverser)}
+			{
+			}
+			bvh::SweepSahBuilder<bvh::Bvh<float>> builder;
+			bvh::ClosestPrimitiveIntersector<bvh::Bvh<float>, bvh::Triangle<float>> primitiveIntersector;
+			bvh::SingleRayTraverser<bvh::Bvh<float>> traverser;
+		};
+		BvhData();
+		bvh::Bvh<float> bvh;
+		std::vector<BvhPrimitive> primitives;
+		std::vector<BvhMeshRange> meshRanges;
+
+		const BvhMeshRange *FindMeshRange(size_t primIdx) const
+		{
+			BvhMeshRange search {};
+			search.start = primIdx * 3;
+			auto it = std::upper_bound(meshRanges.begin(), meshRanges.end(), search);
+			if(it == meshRanges.begin())
+				return nullptr;
+			--it;
+			return &*it;
+		}
+
+		// (Re-)builds the hierarchy from the current primitives
+		void InitializeIntersectorData();
+		// Uses the topology of a prebuilt hierarchy instead of building a new one. The hierarchy has to
+		// be valid for the current primitives.
+		void InitializeIntersectorData(const BvhHierarchy &hierarchy);
+		// Re-computes the node bounds from the current primitives without changing the topology
+		void Refit();
+		// Surface area heuristic cost of the hierarchy, relative to the root bounds
+		float ComputeSahCost() const;
+		std::unique_ptr<IntersectorData> intersectorData;
+		// SAH cost right after the last full build, used to determine how much refitting has degraded the hierarchy
+		float referenceSahCost = 0.f;
+		// Flattened copy of the hierarchy used for traversal, has to be updated whenever the bvh changes
+		std::vector<BvhFlatNode> flatNodes;
+
+		void GetHitInfo(const BvhPacketHit &hit, BvhHitInfo &outHitInfo) const;
+	  private:
+		void InitializeIntersectorData(bvh::SweepSahBuilder<bvh::Bvh<float>> &&builder);
+	};
+	// Intersects the rays in rayMask with the primitives of the hierarchy. Hits which are closer than the current maximum distance
+	// of a ray are written to outHits, and the maximum distance of the ray is reduced to the hit distance.
+	void intersect_bvh_packet(const BvhData &bvhData, BvhRayPacket &packet, uint32_t rayMask, BvhPacketHits &outHits, size_t sourceIndex = 0);
+
+	void get_bvh_bounds(const bvh::BoundingBox<float> &bb, Vector3 &outMin, Vector3 &outMax);
+	// primitiveOffset is added to all primitive indices written to outIntersectionInfo
+	bool test_bvh_intersection_with_aabb(const BvhData &bvhData, const Vector3 &min, const Vector3 &max, uint32_t nodeIdx = 0, BvhIntersectionInfo *outIntersectionInfo = nullptr, size_t primitiveOffset = 0);
+	bool test_bvh_intersection_with_kdop(const BvhData &bvhData, const std::vector<umath::Plane> &kdop, uint32_t nodeIdx = 0, BvhIntersectionInfo *outIntersectionInfo = nullptr, size_t primitiveOffset = 0);
+};
+
+#endif
@@ -0,0 +1,65 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#ifndef __COMPONENT_EVENT_DISPATCH_TABLE_HPP__
+#define __COMPONENT_EVENT_DISPATCH_TABLE_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include "pragma/entities/entity_component_info.hpp"
+#include <sharedutils/functioncallback.h>
+#include <array>
+#include <vector>
+#include <optional>
+
+namespace pragma {
+	// List of event listeners. Most events only have one or two listeners, which are stored inline without a heap allocation.
+	class DLLNETWORK ComponentEventListenerList {
+	  public:
+		static constexpr size_t INLINE_CAPACITY = 2;
+		size_t size() const { return m_overflow.empty() ? m_numInline : m_overflow.size(); }
+		bool empty() const { return size() == 0; }
+		CallbackHandle &operator[](size_t idx) { return m_overflow.empty() ? m_inline[idx] : m_overflow[idx]; }
+		const CallbackHandle &operator[](size_t idx) const { return const_cast<ComponentEventListenerList *>(this)->operator[](idx); }
+
+		CallbackHandle &push_back(const CallbackHandle &hCallback);
+		void erase(size_t idx);
+		std::optional<size_t> find(const CallbackHandle &hCallback) const;
+	  private:
+		std::array<CallbackHandle, INLINE_CAPACITY> m_inline;
+		// Once the inline capacity has been exceeded, all listeners are moved here
+		std::vector<CallbackHandle> m_overflow;
+		uint8_t m_numInline = 0;
+	};
+
+	// Maps component event ids to their listeners. The entries are stored in a flat array sorted by event id.
+	// A bit mask of the event ids with listeners allows rejecting events without any listeners without a lookup.
+	class DLLNETWORK ComponentEventDispatchTable {
+	  public:
+		struct Entry {
+			ComponentEventId eventId;
+			ComponentEventListenerList listeners;
+		};
+		bool MayHaveListeners(ComponentEventId eventId) const { return (m_eventMask & get_event_bit(eventId)) != 0; }
+		// Note: The returned pointer is invalidated if listeners for a different event are added
+		ComponentEventListenerList *FindListeners(ComponentEventId eventId);
+		const ComponentEventListenerList *FindListeners(ComponentEventId eventId) const { return const_cast<ComponentEventDispatchTable *>(this)->FindListeners(eventId); }
+		ComponentEventListenerList &GetListeners(ComponentEventId eventId);
+		void Erase(ComponentEventId eventId);
+		void Clear();
+		bool IsEmpty() const { return m_entries.empty(); }
+
+		std::vector<Entry>::iterator begin() { return m_entries.begin(); }
+		std::vector<Entry>::iterator end() { return m_entries.end(); }
+		std::vector<Entry>::const_iterator begin() const { return m_entries.begin(); }
+		std::vector<Entry>::const_iterator end() const { return m_entries.end(); }
+	  private:
+		static uint64_t get_event_bit(ComponentEventId eventId) { return uint64_t {1} << (eventId % 64); }
+		std::vector<Entry> m_entries;
+		uint64_t m_eventMask = 0;
+	};
+};
+
+#endif
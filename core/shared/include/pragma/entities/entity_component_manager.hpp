@@ -14,6 +14,7 @@
 #include "pragma/entities/entity_component_info.hpp"
 #include "pragma/entities/entity_component_member_info.hpp"
 #include "pragma/entities/entity_component_event_info.hpp"
+#include "pragma/entities/entity_component_pool.hpp"
 #include "pragma/util/global_string_table.hpp"
 #include "pragma/types.hpp"
 #include <cinttypes>
@@ -40,6 +41,7 @@ namespace udm {
 class BaseEntity;
 namespace pragma {
 	class BaseEntityComponent;
+	class EntityComponentPool;
 	DLLNETWORK std::string get_normalized_component_member_name(const std::string &name);
 	DLLNETWORK size_t get_component_member_name_hash(const std::string &name);
 	DLLNETWORK size_t get_component_member_name_hash(const char *name);
@@ -77,6 +79,10 @@ namespace pragma {
 		pragma::GString name = "";
 		std::function<util::TSharedHandle<BaseEntityComponent>(BaseEntity &)> factory = nullptr;
 		mutable std::unique_ptr<std::vector<CallbackHandle>> onCreateCallbacks = nullptr;
+		// Memory pool the factory allocates the components from, if the component type is pooled.
+		// The pool is shared with the deleters of all components allocated from it, so it is only destroyed once
+		// both the component manager and the last of these components have been released.
+		std::shared_ptr<EntityComponentPool> pool = nullptr;
 		ComponentId id = std::numeric_limits<uint32_t>::max();
 		ComponentFlags flags = ComponentFlags::None;
 		std::vector<ComponentMemberInfo> members;
@@ -86,6 +92,18 @@ namespace pragma {
 		bool IsValid() const { return factory != nullptr; }
 	};
 
+	namespace detail {
+		// Returns a process-wide index for the specified component type, which is used for array-based lookups of component ids
+		DLLNETWORK uint32_t get_component_type_slot(std::type_index typeIndex);
+		template<class TComponent>
+		uint32_t get_component_type_slot()
+		{
+			// Only has to be resolved once per type
+			static const auto slot = get_component_type_slot(std::type_index(typeid(TComponent)));
+			return slot;
+		}
+	};
+
 	class DLLNETWORK EntityComponentManager {
 	  public:
 		EntityComponentManager() = default;
@@ -131,11 +149,19 @@ namespace pragma {
 		struct DLLNETWORK ComponentContainerInfo {
 		  protected:
 			friend EntityComponentManager;
-			void Push(BaseEntityComponent &component);
-			void Pop(BaseEntityComponent &component);
+			// If an index is specified (i.e. the slot index of a pooled component), the component is stored at that index,
+			// which keeps the container in the same order as the components are laid out in memory.
+			void Push(BaseEntityComponent &component, std::optional<std::size_t> index = {});
+			void Pop(BaseEntityComponent &component, std::optional<std::size_t> index = {});
+			// Pool slot indices can only be used if all components in the container have been allocated from the same pool.
+			// If the scheme changes while components are still alive (e.g. the component type has been re-registered under the same name),
+			// the container switches to free-list indices until it is empty again.
+			void SetUsePoolIndices(bool usePoolIndices);
 			std::size_t GetCount() const;
 			const std::vector<BaseEntityComponent *> &GetComponents() const;
 		  private:
+			bool m_usePoolIndices = false;
+			bool m_poolIndicesRequested = false;
 			std::queue<std::size_t> m_freeIndices = {};
 			std::size_t m_count = 0ull;
 			std::vector<BaseEntityComponent *> m_components = {};
@@ -150,12 +176,15 @@ namespace pragma {
 		// Automatically called when a component was removed; Don't call this manually!
 		void DeregisterComponent(BaseEntityComponent &component);
 	  private:
-		ComponentId RegisterComponentType(const std::string &name, const std::function<util::TSharedHandle<BaseEntityComponent>(BaseEntity &)> &factory, ComponentFlags flags, const std::type_index *typeIndex);
+		ComponentId RegisterComponentType(const std::string &name, const std::function<util::TSharedHandle<BaseEntityComponent>(BaseEntity &)> &factory, ComponentFlags flags, const std::type_index *typeIndex,
+		  const std::shared_ptr<EntityComponentPool> &pool = nullptr);
 		virtual void OnComponentTypeRegistered(const ComponentInfo &componentInfo);
 
 		std::vector<ComponentInfo> m_preRegistered;
 		std::vector<ComponentInfo> m_componentInfos;
 		std::unordered_map<std::type_index, ComponentId> m_typeIndexToComponentId;
+		// Component id by type slot (see detail::get_component_type_slot)
+		std::vector<ComponentId> m_typeSlotToComponentId;
 		std::vector<std::shared_ptr<std::type_index>> m_componentIdToTypeIndex;
 		ComponentId m_nextComponentId = 0u;
 
@@ -181,12 +210,30 @@ pragma::ComponentId pragma::EntityComponentManager::RegisterComponentType(const
 		it->second.componentId = componentId;
 		return id;
 	});
+	auto pool = std::make_shared<EntityComponentPool>(sizeof(TComponent), alignof(TComponent));
+	std::type_index typeIndex {typeid(TComponent)};
 	RegisterComponentType(
 	  name,
-	  [](BaseEntity &ent) {
-		  return util::TSharedHandle<BaseEntityComponent> {new TComponent {ent}, [](pragma::BaseEntityComponent *c) { delete c; }};
+	  [pool](BaseEntity &ent) {
+		  uint32_t index;
+		  auto *ptr = pool->Allocate(index);
+		  TComponent *component;
+		  try {
+			  component = new(ptr) TComponent {ent};
+		  }
+		  catch(...) {
+			  pool->Free(index);
+			  throw;
+		  }
+		  component->m_poolIndex = index;
+		  return util::TSharedHandle<BaseEntityComponent> {component, [pool](pragma::BaseEntityComponent *c) {
+			                                                   auto *component = static_cast<TComponent *>(c);
+			                                                   auto index = component->m_poolIndex;
+			                                                   std::destroy_at(component);
+			                                                   pool->Free(index);
+		                                                   }};
 	  },
-	  flags, std::type_index(typeid(TComponent)));
+	  flags, &typeIndex, pool);
 	auto &componentInfo = m_componentInfos[componentId];
 	TComponent::RegisterMembers(*this, [this, &componentInfo](ComponentMemberInfo &&memberInfo) -> ComponentMemberIndex { return RegisterMember(componentInfo, std::move(memberInfo)); });
 	return componentId;
@@ -195,10 +242,10 @@ pragma::ComponentId pragma::EntityComponentManager::RegisterComponentType(const
 template<class TComponent, typename>
 bool pragma::EntityComponentManager::GetComponentTypeId(ComponentId &outId) const
 {
-	auto it = m_typeIndexToComponentId.find(std::type_index(typeid(TComponent)));
-	if(it == m_typeIndexToComponentId.end())
+	auto slot = detail::get_component_type_slot<TComponent>();
+	if(slot >= m_typeSlotToComponentId.size() || m_typeSlotToComponentId[slot] == INVALID_COMPONENT_ID)
 		return false;
-	outId = it->second;
+	outId = m_typeSlotToComponentId[slot];
 	return true;
 }
 
@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#ifndef __ENTITY_COMPONENT_POOL_HPP__
+#define __ENTITY_COMPONENT_POOL_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <cinttypes>
+
+namespace pragma {
+	// Allocates objects of a fixed size in slabs, so that all components of the same type are laid out
+	// contiguously in memory. Free slots are re-used lowest index first, which keeps the live components packed
+	// at the front of the pool.
+	class DLLNETWORK EntityComponentPool {
+	  public:
+		static constexpr uint32_t SLAB_ELEMENT_COUNT = 64;
+		EntityComponentPool(size_t elementSize, size_t alignment);
+		~EntityComponentPool();
+		EntityComponentPool(const EntityComponentPool &) = delete;
+		EntityComponentPool &operator=(const EntityComponentPool &) = delete;
+
+		// Returns uninitialized memory for one element. The slot index has to be kept by the caller to free the element again.
+		void *Allocate(uint32_t &outIndex);
+		void Free(uint32_t index);
+		uint32_t GetCapacity() const;
+		uint32_t GetAllocatedCount() const;
+	  private:
+		std::byte *GetElement(uint32_t index) const;
+
+		std::vector<std::byte *> m_slabs;
+		std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> m_freeIndices;
+		size_t m_elementSize;
+		size_t m_alignment;
+		uint32_t m_numAllocated = 0;
+		mutable std::mutex m_mutex;
+	};
+};
+
+#endif
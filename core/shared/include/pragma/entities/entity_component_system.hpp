@@ -76,7 +76,16 @@ namespace pragma {
 		virtual void OnComponentAdded(BaseEntityComponent &component);
 		virtual void OnComponentRemoved(BaseEntityComponent &component);
 	  private:
-		std::unordered_map<ComponentId, ComponentHandle<BaseEntityComponent>> m_componentLookupTable; // Only contains one (the first) component per type; Used for fast lookups
+		struct ComponentLookupEntry {
+			ComponentId componentId;
+			ComponentHandle<BaseEntityComponent> component;
+		};
+		const ComponentLookupEntry *FindLookupEntry(ComponentId componentId) const;
+		ComponentLookupEntry *FindLookupEntry(ComponentId componentId) { return const_cast<ComponentLookupEntry *>(const_cast<const BaseEntityComponentSystem *>(this)->FindLookupEntry(componentId)); }
+		// Only contains one (the first) component per type; Used for fast lookups.
+		// Sorted by component id, entities usually only have a small number of components, so a binary search over a
+		// contiguous array is faster than a hash map.
+		std::vector<ComponentLookupEntry> m_componentLookupTable;
 		std::vector<util::TSharedHandle<BaseEntityComponent>> m_components;
 		EntityComponentManager *m_componentManager;
 		BaseEntity *m_entity;
@@ -33,19 +33,18 @@ template<class TComponent, typename>
 pragma::ComponentHandle<TComponent> pragma::BaseEntityComponentSystem::GetComponent() const
 {
 	ComponentId componentId;
-	if(m_componentManager->GetComponentId(std::type_index(typeid(TComponent)), componentId) == false)
+	if(m_componentManager->GetComponentTypeId<TComponent>(componentId) == false)
 		return pragma::ComponentHandle<TComponent> {};
-	auto it = m_componentLookupTable.find(componentId);
-	return (it != m_componentLookupTable.end()) ? const_cast<BaseEntityComponent *>(it->second.get())->GetHandle<TComponent>() : pragma::ComponentHandle<TComponent> {};
+	auto *entry = FindLookupEntry(componentId);
+	return (entry != nullptr) ? const_cast<BaseEntityComponent *>(entry->component.get())->GetHandle<TComponent>() : pragma::ComponentHandle<TComponent> {};
 }
 template<class TComponent, typename>
 bool pragma::BaseEntityComponentSystem::HasComponent() const
 {
 	ComponentId componentId;
-	if(m_componentManager->GetComponentId(std::type_index(typeid(TComponent)), componentId) == false)
+	if(m_componentManager->GetComponentTypeId<TComponent>(componentId) == false)
 		return false;
-	auto it = m_componentLookupTable.find(componentId);
-	return it != m_componentLookupTable.end() && it->second.expired() == false;
+	return HasComponent(componentId);
 }
 
 #endif
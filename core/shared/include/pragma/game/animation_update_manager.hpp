@@ -8,7 +8,7 @@
 #define __ANIMATION_UPDATE_MANAGER_HPP__
 
 #include "pragma/networkdefinitions.h"
-#include "pragma/util/util_thread_pool.hpp"
+#include "pragma/util/job_system.hpp"
 
 class Game;
 namespace pragma {
@@ -28,6 +28,9 @@ namespace pragma {
 
 		void UpdateAnimations(double dt);
 	  private:
+		static constexpr size_t ENTITIES_PER_JOB = 8;
+		static constexpr uint32_t INVALID_SLOT = std::numeric_limits<uint32_t>::max();
+		void RemoveSlot(uint32_t slot);
 		void UpdateEntityAnimationDrivers(double dt);
 		void UpdateConstraints(double dt);
 
@@ -36,8 +39,11 @@ namespace pragma {
 		pragma::ComponentId m_panimaComponentId = std::numeric_limits<pragma::ComponentId>::max();
 		pragma::ComponentId m_animationDriverComponentId = std::numeric_limits<pragma::ComponentId>::max();
 		pragma::ComponentId m_constraintManagerComponentId = std::numeric_limits<pragma::ComponentId>::max();
-		pragma::ThreadPool m_threadPool;
 		std::vector<AnimatedEntity> m_animatedEntities;
+		// Maps the local entity index to the index in m_animatedEntities
+		std::vector<uint32_t> m_entityIndexToSlot;
+		std::vector<BaseAnimatedComponent *> m_maintainedEntities;
+		JobCounter m_jobCounter;
 	};
 };
 
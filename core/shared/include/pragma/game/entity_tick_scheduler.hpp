@@ -0,0 +1,71 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#ifndef __ENTITY_TICK_SCHEDULER_HPP__
+#define __ENTITY_TICK_SCHEDULER_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <vector>
+#include <cinttypes>
+#include <limits>
+
+namespace pragma {
+	class BaseEntityComponent;
+	// Schedules the logic ticks of entity components. Components that are due every tick are kept in a dense list,
+	// components with a next tick time in the future are moved into a min-heap keyed on that time and aren't touched
+	// again until they're due.
+	// Removals and reschedules never erase from the middle of a container, instead they invalidate the existing
+	// entry (by incrementing the generation of the component's slot), which is then skipped and compacted lazily.
+	class DLLNETWORK EntityTickScheduler {
+	  public:
+		static constexpr uint32_t INVALID_SLOT = std::numeric_limits<uint32_t>::max();
+		EntityTickScheduler() = default;
+		EntityTickScheduler(const EntityTickScheduler &) = delete;
+		EntityTickScheduler &operator=(const EntityTickScheduler &) = delete;
+
+		// Components may be added, removed and rescheduled at any time, including during Tick
+		void Add(BaseEntityComponent &component);
+		void Remove(BaseEntityComponent &component);
+		// Has to be called whenever the next tick time of a registered component has changed
+		void Reschedule(BaseEntityComponent &component);
+		void Tick(double tCur, double tDelta);
+
+		uint32_t GetComponentCount() const { return m_numComponents; }
+		// Number of components that are currently waiting for a future tick time
+		uint32_t GetScheduledComponentCount() const { return m_numScheduled; }
+	  private:
+		enum class State : uint8_t { Free = 0u, Active, Scheduled };
+		struct Slot {
+			BaseEntityComponent *component = nullptr;
+			uint32_t generation = 0;
+			State state = State::Free;
+		};
+		struct ActiveEntry {
+			uint32_t slot;
+			uint32_t generation;
+		};
+		struct ScheduledEntry {
+			double time;
+			uint32_t slot;
+			uint32_t generation;
+		};
+		bool IsValid(uint32_t slot, uint32_t generation) const { return m_slots[slot].generation == generation; }
+		void Activate(uint32_t slot);
+		void Schedule(uint32_t slot, double time);
+		void FreeSlot(uint32_t slot);
+		void PopDueComponents(double tCur);
+		void CompactHeap();
+
+		std::vector<Slot> m_slots;
+		std::vector<uint32_t> m_freeSlots;
+		std::vector<ActiveEntry> m_active;
+		std::vector<ScheduledEntry> m_heap;
+		uint32_t m_numComponents = 0;
+		uint32_t m_numScheduled = 0;
+	};
+};
+
+#endif
@@ -80,6 +80,7 @@ namespace pragma {
 	class BaseGamemodeComponent;
 	class BaseGameComponent;
 	struct AnimationUpdateManager;
+	class EntityTickScheduler;
 	namespace nav {
 		class Mesh;
 	};
@@ -102,6 +103,8 @@ namespace util {
 struct BaseEntityComponentHandleWrapper;
 namespace pragma::physics {
 	class IEnvironment;
+	class TraceBatch;
+	enum class TraceBatchFlags : uint8_t;
 };
 class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
   public:
@@ -187,6 +190,9 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	Bool Overlap(const TraceData &data, std::vector<TraceResult> *optOutResults) const;
 	Bool RayCast(const TraceData &data, std::vector<TraceResult> *optOutResults) const;
 	Bool Sweep(const TraceData &data, std::vector<TraceResult> *optOutResults) const;
+	void OverlapBatch(pragma::physics::TraceBatch &batch, pragma::physics::TraceBatchFlags flags = {}) const;
+	void RayCastBatch(pragma::physics::TraceBatch &batch, pragma::physics::TraceBatchFlags flags = {}) const;
+	void SweepBatch(pragma::physics::TraceBatch &batch, pragma::physics::TraceBatchFlags flags = {}) const;
 
 	TraceResult Overlap(const TraceData &data) const;
 	TraceResult RayCast(const TraceData &data) const;
@@ -347,9 +353,19 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	GameFlags GetGameFlags() const;
 
 	virtual bool IsPhysicsSimulationEnabled() const = 0;
+	// Fixed time step of a single physics step, see sv_physics_simulation_rate
+	double GetPhysicsTimeStep() const { return m_physicsTimeStep; }
+	// Number of physics steps that have been simulated since the game has started
+	uint64_t GetPhysicsStepIndex() const { return m_physicsStepIndex; }
+	uint32_t GetLastPhysicsSubstepCount() const { return m_lastPhysicsSubstepCount; }
+	// Physics states are only interpolated if the physics simulation is decoupled from the tickrate
+	bool IsPhysicsInterpolationEnabled() const { return m_physicsInterpolationEnabled; }
+	// Fraction of a physics step that has passed since the most recent physics state, in the range [0,1].
+	// Used to interpolate between the previous and the most recent physics state.
+	float GetPhysicsInterpolationFactor() const;
 
 	std::vector<pragma::ComponentHandle<pragma::BasePhysicsComponent>> &GetAwakePhysicsComponents();
-	std::vector<pragma::BaseEntityComponent *> &GetEntityTickComponents() { return m_entityTickComponents; }
+	pragma::EntityTickScheduler &GetEntityTickScheduler() { return *m_entityTickScheduler; }
 	std::vector<pragma::BaseGamemodeComponent *> &GetGamemodeComponents() { return m_gamemodeComponents; }
 
 	// Debug
@@ -361,6 +377,8 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	bool StopProfilingStage(CPUProfilingPhase stage);
   protected:
 	virtual void UpdateTime();
+	// Steps the physics simulation at a fixed time step (see sv_physics_simulation_rate)
+	void SimulatePhysics();
 	void GetLuaRegisteredEntities(std::vector<std::string> &luaClasses) const;
 
 	GameFlags m_flags = GameFlags::InitialTick;
@@ -369,7 +387,7 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	std::unordered_map<size_t, BaseEntity *> m_uuidToEnt;
 	std::queue<EntityHandle> m_entsScheduledForRemoval;
 	std::vector<pragma::ComponentHandle<pragma::BasePhysicsComponent>> m_awakePhysicsEntities;
-	std::vector<pragma::BaseEntityComponent *> m_entityTickComponents;
+	std::unique_ptr<pragma::EntityTickScheduler> m_entityTickScheduler;
 	std::vector<pragma::BaseGamemodeComponent *> m_gamemodeComponents;
 	std::shared_ptr<Lua::Interface> m_lua = nullptr;
 	std::unique_ptr<pragma::lua::ClassManager> m_luaClassManager;
@@ -397,7 +415,12 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	// Physics have a fixed time-step, if the game delta time
 	// doesn't match that time-step, the remainder will be used
 	// for the next tick.
-	float m_tPhysDeltaRemainder = 0.f;
+	double m_tPhysDeltaRemainder = 0.0;
+	double m_physicsTimeStep = 0.0;
+	double m_tLastPhysicsStep = 0.0;
+	uint64_t m_physicsStepIndex = 0;
+	uint32_t m_lastPhysicsSubstepCount = 0;
+	bool m_physicsInterpolationEnabled = false;
 	Vector3 m_gravity = {0, -600, 0};
 	std::vector<util::TWeakSharedHandle<pragma::BaseWorldComponent>> m_worldComponents {};
 	GameModeInfo *m_gameMode = nullptr;
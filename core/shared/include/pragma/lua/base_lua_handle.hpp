@@ -34,6 +34,13 @@ namespace pragma {
 		template<class T, typename... TARGS>
 		CallbackReturnType CallLuaMethod(const std::string &name, T *ret, TARGS... args);
 
+		// Looks up a method of a Lua object in advance. Returns an empty object if the method doesn't exist, or if
+		// it isn't implemented in Lua (i.e. only the default C++ binding exists).
+		static luabind::object ResolveLuaMethod(luabind::object o, const char *name);
+		// Calls a method that has been resolved with ResolveLuaMethod. No lookups are required, and empty methods are skipped.
+		template<class T, typename... TARGS>
+		T CallResolvedLuaMethod(const luabind::object &method, TARGS... args);
+
 		template<typename T>
 		util::TWeakSharedHandle<T> GetHandle() const;
 	  protected:
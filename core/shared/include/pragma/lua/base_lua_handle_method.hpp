@@ -69,4 +69,27 @@ CallbackReturnType pragma::BaseLuaHandle::CallLuaMethod(const std::string &name,
 	return CallbackReturnType::NoReturnValue;
 }
 
+template<class T, typename... TARGS>
+T pragma::BaseLuaHandle::CallResolvedLuaMethod(const luabind::object &method, TARGS... args)
+{
+	if(!method)
+		return T();
+	auto &o = GetLuaObject();
+#ifndef LUABIND_NO_EXCEPTIONS
+	try {
+#endif
+		return static_cast<T>(luabind::call_function<T>(method, o, std::forward<TARGS>(args)...));
+#ifndef LUABIND_NO_EXCEPTIONS
+	}
+	catch(luabind::error &err) {
+		Lua::HandleLuaError(o.interpreter());
+	}
+	catch(const luabind::cast_failed &) // No return value was specified, or return value couldn't be cast
+	{
+		return T();
+	}
+#endif
+	return T();
+}
+
 #endif
@@ -24,6 +24,7 @@ extern DLLNETWORK Engine *engine;
 
 class BaseEntity;
 struct ClassMembers;
+struct ClassMethods;
 namespace pragma {
 	namespace detail {
 		constexpr ents::EntityMemberType util_type_to_member_type(util::VarType type)
@@ -169,15 +170,25 @@ namespace pragma {
 			std::unique_ptr<TransformCompositeInfo> transformCompositeInfo;
 
 			std::optional<ComponentMemberInfo> componentMemberInfo {};
+
+			// Members of value types are stored at this byte offset in the component's member data block. The offsets are
+			// assigned per class when the member is registered. All other members (properties, entity references, elements)
+			// are stored in the Lua object, in which case the type is udm::Type::Invalid.
+			udm::Type valueType = udm::Type::Invalid;
+			uint32_t valueOffset = 0;
 		};
 		struct DLLNETWORK DynamicMemberInfo {
 			bool enabled = false;
-			std::any value;
+			// The value is stored at this byte offset in the component's member data block
+			udm::Type type = udm::Type::Invalid;
+			uint32_t offset = 0;
 			luabind::object onChange;
 		};
 		static MemberIndex RegisterMember(const luabind::object &oClass, const std::string &memberName, ents::EntityMemberType memberType, const std::any &initialValue, MemberFlags memberFlags, const Lua::map<std::string, void> &attributes);
 		static std::vector<MemberInfo> *GetMemberInfos(const luabind::object &oClass);
 		static void ClearMembers(lua_State *l);
+		// Has to be called whenever a component class has been (re-)registered, so the methods are resolved again
+		static void InvalidateClassMethods(lua_State *l);
 
 		const MemberInfo *GetLuaMemberInfo(ComponentMemberInfo &memberInfo) const;
 		virtual void Initialize() override;
@@ -208,7 +219,17 @@ namespace pragma {
 		void SetDynamicMemberValue(ComponentMemberIndex memberIndex, const T &value);
 		template<typename T>
 		bool GetDynamicMemberValue(ComponentMemberIndex memberIndex, T &outValue, ents::EntityMemberType &outType);
-		std::any *GetDynamicMemberValue(ComponentMemberIndex memberIndex, ents::EntityMemberType &outType);
+		// Returns a pointer to the value of the member, or nullptr if the member doesn't exist or isn't of type T
+		template<typename T>
+		T *GetDynamicMemberValuePtr(ComponentMemberIndex memberIndex);
+		void *GetDynamicMemberValue(ComponentMemberIndex memberIndex, udm::Type &outType);
+
+		// Returns a pointer to the value of a class-declared member, or nullptr if the member is not stored in the member data block
+		template<typename T>
+		T *GetClassMemberValuePtr(MemberIndex memberIndex);
+		void *GetClassMemberValue(MemberIndex memberIndex, udm::Type &outType);
+		void *GetClassMemberValue(const MemberInfo &memberInfo);
+		const void *GetClassMemberValue(const MemberInfo &memberInfo) const { return const_cast<BaseLuaBaseEntityComponent *>(this)->GetClassMemberValue(memberInfo); }
 
 		virtual void Save(udm::LinkedPropertyWrapperArg udm) override;
 		virtual void Load(udm::LinkedPropertyWrapperArg udm, uint32_t version) override;
@@ -272,6 +293,7 @@ namespace pragma {
 		static void default_Lua_OnEntityComponentRemoved(lua_State *l, BaseLuaBaseEntityComponent &hComponent) {}
 	  protected:
 		BaseLuaBaseEntityComponent(BaseEntity &ent);
+		virtual ~BaseLuaBaseEntityComponent() override;
 		luabind::object *GetClassObject();
 		const luabind::object *GetClassObject() const { return const_cast<BaseLuaBaseEntityComponent *>(this)->GetClassObject(); }
 		virtual void InitializeLuaObject(lua_State *l) override;
@@ -280,6 +302,10 @@ namespace pragma {
 		virtual std::optional<ComponentMemberIndex> DoGetMemberIndex(const std::string &name) const override;
 		std::any GetMemberValue(const MemberInfo &memberInfo) const;
 		void SetMemberValue(const MemberInfo &memberInfo, const std::any &value) const;
+		void SetMemberValue(const MemberInfo &memberInfo, const std::string &value);
+		void WriteMemberValue(NetPacket &packet, const MemberInfo &memberInfo) const;
+		// Reads the value written by WriteMemberValue and invokes the change callback of the member
+		void ReadMemberValue(NetPacket &packet, const MemberInfo &memberInfo);
 		const std::vector<MemberInfo> &GetMembers() const;
 		virtual void OnEntityComponentAdded(BaseEntityComponent &component) override;
 		virtual void OnEntityComponentRemoved(BaseEntityComponent &component) override;
@@ -296,14 +322,36 @@ namespace pragma {
 
 		using BaseEntityComponent::InitializeLuaObject;
 	  private:
+		// Methods that are called by the engine. They're resolved once per class, so that they don't have to be looked up by name every time.
+		enum class LuaMethod : uint8_t { Initialize = 0u, OnTick, OnRemove, OnEntitySpawn, OnEntityPostSpawn, OnAttachedToEntity, OnDetachedToEntity, Count };
+		const luabind::object &GetClassMethod(LuaMethod method);
+		void ResolveClassMethods();
+		// Checks the Lua object of this component for methods that differ from the ones resolved for its class
+		void ResolveInstanceMethods();
+		template<typename... TARGS>
+		void CallClassMethod(LuaMethod method, TARGS... args);
+
 		mutable ClassMembers *m_classMembers = nullptr;
+		std::shared_ptr<ClassMethods> m_classMethods = nullptr;
 
 		virtual void OnMemberRegistered(const ComponentMemberInfo &memberInfo, ComponentMemberIndex index) override;
 		virtual void OnMemberRemoved(const ComponentMemberInfo &memberInfo, ComponentMemberIndex index) override;
 
 		std::vector<MemberInfo> m_members = {};
+		uint32_t AllocateDynamicMemberValue(udm::Type type);
+		void ReserveMemberData(uint32_t size, uint32_t dynamicMemberShift = 0);
+		void InitializeClassMemberValues();
+		void ClearClassMemberValues();
+		void ClearDynamicMemberValues();
+
 		std::vector<DynamicMemberInfo> m_dynamicMembers;
 		uint32_t m_dynamicMemberStartOffset = 0;
+		// Values of the class-declared value members, followed by the values of all dynamic members. The class members are laid out
+		// with the offsets of their MemberInfo, the dynamic members with the offsets of the DynamicMemberInfo entries.
+		std::unique_ptr<std::byte[]> m_memberData = nullptr;
+		uint32_t m_classMemberDataSize = 0;
+		uint32_t m_memberDataSize = 0;
+		uint32_t m_memberDataCapacity = 0;
 		std::unordered_map<std::string, size_t> m_memberNameToIndex = {};
 		uint32_t m_classMemberIndex = std::numeric_limits<uint32_t>::max();
 		bool m_bShouldTransmitNetData = false;
@@ -379,33 +427,66 @@ namespace pragma {
 };
 REGISTER_BASIC_BITWISE_OPERATORS(pragma::BaseLuaBaseEntityComponent::MemberFlags)
 
+template<typename T>
+T *pragma::BaseLuaBaseEntityComponent::GetClassMemberValuePtr(MemberIndex memberIndex)
+{
+	udm::Type type;
+	auto *ptr = GetClassMemberValue(memberIndex, type);
+	if(!ptr || type != udm::type_to_enum<T>())
+		return nullptr;
+	return static_cast<T *>(ptr);
+}
+template<typename T>
+T *pragma::BaseLuaBaseEntityComponent::GetDynamicMemberValuePtr(ComponentMemberIndex memberIndex)
+{
+	udm::Type type;
+	auto *ptr = GetDynamicMemberValue(memberIndex, type);
+	if(!ptr || type != udm::type_to_enum<T>())
+		return nullptr;
+	return static_cast<T *>(ptr);
+}
 template<typename T>
 void pragma::BaseLuaBaseEntityComponent::SetDynamicMemberValue(ComponentMemberIndex memberIndex, const T &value)
 {
-	auto *memberInfo = GetMemberInfo(memberIndex);
-	if(!memberInfo)
+	udm::Type type;
+	auto *ptr = GetDynamicMemberValue(memberIndex, type);
+	if(!ptr)
 		return;
-	ents::EntityMemberType type;
-	auto *anyVal = GetDynamicMemberValue(memberIndex, type);
-	if(!anyVal)
-		return;
-	udm::visit(pragma::ents::member_type_to_udm_type(memberInfo->type), [this, memberInfo, &value, anyVal](auto tag) {
+	if constexpr(udm::is_udm_type<T>()) {
+		if(type == udm::type_to_enum<T>()) {
+			*static_cast<T *>(ptr) = value;
+			return;
+		}
+	}
+	udm::visit(type, [ptr, &value](auto tag) {
 		using TMember = typename decltype(tag)::type;
-		if constexpr(udm::is_convertible<T, TMember>())
-			*anyVal = udm::convert<T, TMember>(value);
+		if constexpr(is_valid_component_property_type_v<TMember> && udm::is_convertible<T, TMember>())
+			*static_cast<TMember *>(ptr) = udm::convert<T, TMember>(value);
 	});
 }
 template<typename T>
 bool pragma::BaseLuaBaseEntityComponent::GetDynamicMemberValue(ComponentMemberIndex memberIndex, T &outValue, ents::EntityMemberType &outType)
 {
-	auto *anyVal = GetDynamicMemberValue(memberIndex, outType);
-	if(!anyVal)
+	udm::Type type;
+	auto *ptr = GetDynamicMemberValue(memberIndex, type);
+	if(!ptr)
 		return false;
-	udm::visit(pragma::ents::member_type_to_udm_type(outType), [anyVal, &outValue](auto tag) {
+	outType = static_cast<ents::EntityMemberType>(type);
+	if constexpr(udm::is_udm_type<T>()) {
+		if(type == udm::type_to_enum<T>()) {
+			outValue = *static_cast<T *>(ptr);
+			return true;
+		}
+	}
+	auto success = false;
+	udm::visit(type, [ptr, &outValue, &success](auto tag) {
 		using TMember = typename decltype(tag)::type;
-		if constexpr(udm::is_udm_type<T>() && udm::is_udm_type<TMember>() && is_valid_component_property_type_v<TMember> && udm::is_convertible<TMember, T>())
-			outValue = udm::convert<TMember, T>(std::any_cast<TMember>(*anyVal));
+		if constexpr(udm::is_udm_type<T>() && udm::is_udm_type<TMember>() && is_valid_component_property_type_v<TMember> && udm::is_convertible<TMember, T>()) {
+			outValue = udm::convert<TMember, T>(*static_cast<TMember *>(ptr));
+			success = true;
+		}
 	});
+	return success;
 }
 
 #endif
@@ -46,6 +46,7 @@ namespace udm {
 	struct AssetData;
 };
 namespace pragma::animation {
+	class CompressedAnimation;
 	class DLLNETWORK Animation : public std::enable_shared_from_this<Animation> {
 	  public:
 		static util::EnumRegister &GetActivityEnumRegister();
@@ -84,8 +85,19 @@ namespace pragma::animation {
 		void SetBoneList(const std::vector<uint16_t> &list);
 		void ReserveBoneIds(uint32_t count);
 		unsigned int GetBoneCount();
-		unsigned int GetFrameCount();
+		unsigned int GetFrameCount() const;
 		std::vector<std::shared_ptr<Frame>> &GetFrames();
+		// Returns the frame without decompressing the animation. If the animation is compressed, the returned frame is a
+		// temporary copy, changes to it have no effect.
+		std::shared_ptr<const Frame> ReadFrame(unsigned int ID) const;
+
+		// An animation either stores its compressed curves or its frames, never both. Loaded animations are compressed; the
+		// frames are decompressed on demand when they're accessed for editing (GetFrame, GetFrames, AddFrame and the transform
+		// operations), which discards the compressed data, so playback always uses the edited frames. Compress can be called
+		// once editing is complete. The curves are quantized, so decompressed frames don't have the precision of the source data.
+		std::shared_ptr<const CompressedAnimation> GetCompressedData() const;
+		// Compresses the frames and discards them
+		void Compress();
 		void AddEvent(unsigned int frame, AnimationEvent *ev);
 		std::vector<std::shared_ptr<AnimationEvent>> *GetEvents(unsigned int frame);
 		float GetFadeInTime();
@@ -125,8 +137,11 @@ namespace pragma::animation {
 		bool LoadFromAssetData(const udm::AssetData &data, std::string &outErr, const panima::Skeleton *optSkeleton = nullptr, const Frame *optReference = nullptr);
 		Animation();
 		Animation(const Animation &other, ShareMode share = ShareMode::None);
+		void DecompressFrames();
+		void RestoreCompressedData(const std::shared_ptr<const CompressedAnimation> &compressed);
 
 		std::vector<std::shared_ptr<Frame>> m_frames;
+		std::shared_ptr<const CompressedAnimation> m_compressed;
 		// Contains a list of model bone Ids which are used by this animation
 		std::vector<BoneId> m_boneIds;
 		std::vector<float> m_boneWeights;
@@ -0,0 +1,49 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#ifndef __BONE_POSE_BLEND_HPP__
+#define __BONE_POSE_BLEND_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <mathutil/transform.hpp>
+#include <vector>
+#include <cinttypes>
+
+namespace panima {
+	class Skeleton;
+};
+namespace pragma::animation {
+	// Blends 'src' towards 'dst' with a per-bone interpolation factor. Rotations are interpolated using a
+	// polynomial-corrected normalized lerp, which approximates slerp without any transcendental functions.
+	DLLNETWORK void blend_bone_poses(const umath::Transform *src, const umath::Transform *dst, umath::Transform *out, const float *factors, size_t count);
+	DLLNETWORK void blend_bone_scales(const Vector3 *src, const Vector3 *dst, Vector3 *out, const float *factors, size_t count);
+
+	// Bones of a skeleton in parent-before-child order, which allows the global bone transforms
+	// to be evaluated in a single linear pass.
+	class DLLNETWORK FlatBoneHierarchy {
+	  public:
+		static constexpr uint32_t INVALID_BONE = std::numeric_limits<uint32_t>::max();
+		struct Entry {
+			uint32_t boneId = INVALID_BONE;
+			uint32_t parentIndex = INVALID_BONE; // Index into the flat list, not the bone id
+			uint32_t subtreeEnd = 0;             // Index of the first entry that is not a descendant of this bone
+		};
+		void Build(panima::Skeleton &skeleton);
+		void Clear();
+		bool IsValid(const panima::Skeleton &skeleton) const;
+		const std::vector<Entry> &GetEntries() const { return m_entries; }
+
+		// Transforms the relative bone poses into entity space
+		void ComputeGlobalTransforms(std::vector<umath::ScaledTransform> &transforms) const;
+	  private:
+		const panima::Skeleton *m_skeleton = nullptr;
+		size_t m_boneCount = 0;
+		std::vector<Entry> m_entries;
+	};
+};
+
+#endif
@@ -0,0 +1,83 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#ifndef __COMPRESSED_ANIMATION_HPP__
+#define __COMPRESSED_ANIMATION_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <mathutil/glmutil.h>
+#include <mathutil/uquat.h>
+#include <mathutil/transform.hpp>
+#include <vector>
+#include <array>
+#include <memory>
+#include <optional>
+
+class Frame;
+namespace pragma::animation {
+	// Compact keyframe storage for skeletal animations. Every bone has a separate curve for its position, rotation and scale,
+	// with one key per animation frame. Curves that don't change over the course of the animation are stored as a single value,
+	// all other keys are quantized to 16 bits per component (rotations use the 'smallest three' encoding).
+	class DLLNETWORK CompressedAnimation {
+	  public:
+		struct DLLNETWORK Vector3Track {
+			static constexpr float CONSTANT_EPSILON = 0.0001f;
+			void SetConstant(const Vector3 &value);
+			void Compress(const std::vector<Vector3> &values);
+			bool IsConstant() const { return keys.empty(); }
+			Vector3 GetValue(uint32_t frameIdx) const;
+			// Size of the key data in bytes
+			size_t GetMemorySize() const;
+
+			Vector3 min {};    // Value of the track if it is constant
+			Vector3 extent {};
+			std::vector<std::array<uint16_t, 3>> keys;
+		};
+		struct DLLNETWORK RotationTrack {
+			static constexpr float CONSTANT_EPSILON = 0.00001f;
+			void SetConstant(const Quat &value);
+			void Compress(const std::vector<Quat> &values);
+			bool IsConstant() const { return keys.empty(); }
+			Quat GetValue(uint32_t frameIdx) const;
+			// Size of the key data in bytes
+			size_t GetMemorySize() const;
+
+			Quat constant = uquat::identity();
+			std::vector<uint64_t> keys;
+		};
+		struct DLLNETWORK BoneTracks {
+			Vector3Track position;
+			RotationTrack rotation;
+			Vector3Track scale;
+		};
+
+		static std::shared_ptr<CompressedAnimation> Create(const std::vector<std::shared_ptr<Frame>> &frames, uint32_t numBones);
+		CompressedAnimation(uint32_t numFrames, uint32_t numBones);
+
+		uint32_t GetFrameCount() const { return m_numFrames; }
+		uint32_t GetBoneCount() const { return static_cast<uint32_t>(m_bones.size()); }
+		BoneTracks *GetBoneTracks(uint32_t boneIdx);
+		const BoneTracks *GetBoneTracks(uint32_t boneIdx) const;
+
+		bool HasScales() const { return m_hasScales; }
+		void SetHasScales(bool hasScales) { m_hasScales = hasScales; }
+		void SetMoveOffsets(std::vector<Vector2> &&moveOffsets);
+		std::optional<Vector2> GetMoveOffset(uint32_t frameIdx) const;
+
+		// Writes the bone poses of the specified frame; outScales will always be filled, even if the animation has no scale transforms
+		void SampleFrame(uint32_t frameIdx, std::vector<umath::Transform> &outPoses, std::vector<Vector3> &outScales) const;
+		std::shared_ptr<Frame> Decompress(uint32_t frameIdx) const;
+		size_t GetMemorySize() const;
+	  private:
+		uint32_t m_numFrames = 0;
+		std::vector<BoneTracks> m_bones;
+		std::vector<Vector2> m_moveOffsets;
+		bool m_hasScales = false;
+	};
+};
+
+#endif
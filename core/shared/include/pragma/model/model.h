@@ -271,6 +271,12 @@ class DLLNETWORK Model : public std::enable_shared_from_this<Model> {
 	uint32_t GetLOD(uint32_t id) const;
 	const std::vector<LODInfo> &GetLODs() const;
 	bool TranslateLODMeshes(uint32_t lod, std::vector<uint32_t> &meshIds);
+	// Generates LOD levels 1 to n by simplifying the LOD 0 mesh groups (see ModelSubMesh::Simplify). triangleRatios[i] is the target
+	// triangle count of LOD i +1 relative to LOD 0, distances[i] the distance it is used at (see LODInfo). The mesh groups of
+	// a previous call are re-used. Returns false if there were no mesh groups to simplify.
+	// The simplification may stop short of the target (e.g. due to maxError or locked vertices), if outAchievedRatios is specified,
+	// it receives the actual triangle count of each generated LOD relative to LOD 0.
+	bool GenerateLODs(const std::vector<float> &triangleRatios, const std::vector<float> &distances, float maxError = std::numeric_limits<float>::max(), std::vector<float> *outAchievedRatios = nullptr);
 	// Returns true if the bodygroup exists and sets 'outMeshId' to the mesh Id. If the bodygroup mesh is none/blank, 'outMeshId' will be (unsigned int)(-1)
 	bool GetMesh(uint32_t bodyGroupId, uint32_t groupId, uint32_t &outMeshId);
 	ModelMesh *GetMesh(uint32_t meshGroupIdx, uint32_t meshIdx);
@@ -159,6 +159,12 @@ class DLLNETWORK ModelSubMesh : public std::enable_shared_from_this<ModelSubMesh
 	void Merge(const ModelSubMesh &other);
 	void Scale(const Vector3 &scale);
 	void ClipAgainstPlane(const Vector3 &n, double d, ModelSubMesh &clippedMeshA, ModelSubMesh &clippedMeshB, const std::vector<Mat4> *boneMatrices = nullptr, ModelSubMesh *clippedCoverMeshA = nullptr, ModelSubMesh *clippedCoverMeshB = nullptr);
+	// Returns a simplified copy of the mesh with (at most) targetTriangleCount triangles, using quadric error edge collapses.
+	// Vertices are only removed, never moved, so the UVs and bone weights of the remaining vertices are unaffected. Seams (vertices
+	// sharing a position) are collapsed as a whole, each split vertex into the vertex on the same side of the seam.
+	// maxError is relative to the mesh extents; collapses with a larger error are not performed, even if the target hasn't been reached.
+	// Returns nullptr if the mesh doesn't consist of triangles.
+	std::shared_ptr<ModelSubMesh> Simplify(uint32_t targetTriangleCount, float maxError = std::numeric_limits<float>::max()) const;
 	virtual std::shared_ptr<ModelSubMesh> Copy(bool fullCopy = false) const;
 
 	void ApplyUVMapping(const Vector3 &nu, const Vector3 &nv, uint32_t w, uint32_t h, float ou, float ov, float su, float sv);
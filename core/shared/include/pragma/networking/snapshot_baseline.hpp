@@ -0,0 +1,112 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#ifndef __SNAPSHOT_BASELINE_HPP__
+#define __SNAPSHOT_BASELINE_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <mathutil/glmutil.h>
+#include <mathutil/uquat.h>
+#include <sharedutils/netpacket.hpp>
+#include <unordered_map>
+#include <optional>
+#include <vector>
+#include <array>
+
+namespace pragma::networking {
+	// Quantized transform state of a single entity or physics collision object.
+	// Snapshots in delta mode only transmit the difference of these values relative to
+	// the last snapshot that was acknowledged by the client.
+	struct DLLNETWORK SnapshotObjectState {
+		static constexpr float POSITION_PRECISION = 1.f / 64.f;
+		static constexpr float VELOCITY_PRECISION = 1.f / 32.f;
+		static constexpr float ANGULAR_VELOCITY_PRECISION = 1.f / 1'024.f;
+
+		static SnapshotObjectState Quantize(const Vector3 &pos, const Vector3 &vel, const Vector3 &angVel, const Quat &rot);
+		Vector3 GetPosition() const;
+		Vector3 GetVelocity() const;
+		Vector3 GetAngularVelocity() const;
+		Quat GetRotation() const;
+
+		// Writes the delta to 'base' (or the full state if 'base' is nullptr)
+		void WriteDelta(NetPacket &packet, const SnapshotObjectState *base) const;
+		static SnapshotObjectState ReadDelta(NetPacket &packet, const SnapshotObjectState *base);
+
+		std::array<int32_t, 3> position {0, 0, 0};
+		std::array<int32_t, 3> velocity {0, 0, 0};
+		std::array<int32_t, 3> angularVelocity {0, 0, 0};
+		std::array<int16_t, 4> rotation {0, 0, 0, 0};
+	};
+
+	struct DLLNETWORK SnapshotEntityState {
+		SnapshotObjectState state {};
+		std::vector<SnapshotObjectState> physicsObjects {};
+		const SnapshotObjectState *FindPhysicsObject(size_t idx) const;
+	};
+
+	// Entity states that were transmitted with a single snapshot
+	struct DLLNETWORK SnapshotBaseline {
+		const SnapshotEntityState *FindEntity(uint32_t entIdx) const;
+		uint8_t snapshotId = 0;
+		// Monotonic index of the snapshot, unlike the snapshot id this never wraps around
+		uint64_t snapshotIndex = 0;
+		bool valid = false;
+		bool acknowledged = false;
+		std::unordered_map<uint32_t, SnapshotEntityState> entities;
+	};
+
+	// Ring of the most recent snapshots sent to a client, which haven't been acknowledged yet
+	class DLLNETWORK SnapshotBaselineRing {
+	  public:
+		static constexpr uint32_t BASELINE_COUNT = 32;
+		SnapshotBaseline *Find(uint8_t snapshotId);
+		const SnapshotBaseline *Find(uint8_t snapshotId) const;
+		void Store(SnapshotBaseline &&baseline);
+		void RemoveEntity(uint32_t entIdx);
+		void Clear();
+	  private:
+		std::array<SnapshotBaseline, BASELINE_COUNT> m_baselines {};
+	};
+
+	// Last state of every entity that the client has acknowledged, used by the server as delta base.
+	// Each entity has its own base, so entities which aren't part of every snapshot (e.g. due to relevance culling)
+	// don't need to be carried over from snapshot to snapshot.
+	class DLLNETWORK SnapshotAcknowledgedStates {
+	  public:
+		// Moves the entity states of the baseline into the acknowledged states, unless newer states have already been acknowledged
+		void Acknowledge(SnapshotBaseline &baseline);
+		// Returns the acknowledged state of the entity, if it's recent enough to still be known by the client.
+		// outAge receives the number of snapshots between the acknowledged snapshot and snapshotIndex.
+		const SnapshotEntityState *FindBase(uint32_t entIdx, uint64_t snapshotIndex, uint8_t &outAge) const;
+		void RemoveEntity(uint32_t entIdx);
+		void Clear();
+	  private:
+		struct EntityState {
+			uint64_t snapshotIndex = 0;
+			SnapshotEntityState state {};
+		};
+		std::unordered_map<uint32_t, EntityState> m_entities;
+	};
+
+	// States of every entity from the most recent snapshots received by the client.
+	// The server references one of these per entity as delta base.
+	class DLLNETWORK SnapshotEntityHistory {
+	  public:
+		const SnapshotEntityState *Find(uint32_t entIdx, uint8_t snapshotId) const;
+		void Store(uint32_t entIdx, uint8_t snapshotId, SnapshotEntityState &&state);
+		void RemoveEntity(uint32_t entIdx);
+		void Clear();
+	  private:
+		struct Entry {
+			uint8_t snapshotId = 0;
+			SnapshotEntityState state {};
+		};
+		std::unordered_map<uint32_t, std::vector<Entry>> m_entities;
+	};
+};
+
+#endif
@@ -58,6 +58,9 @@ namespace pragma::physics {
 	class ITriangleShape;
 
 	class WaterBuoyancySimulator;
+	class TraceBatch;
+	enum class TraceQueryType : uint8_t;
+	enum class TraceBatchFlags : uint8_t;
 	class IVisualDebugger;
 
 	using Scalar = double;
@@ -164,6 +167,10 @@ namespace pragma::physics {
 		virtual Bool Overlap(const TraceData &data, std::vector<TraceResult> *optOutResults = nullptr) const = 0;
 		virtual Bool RayCast(const TraceData &data, std::vector<TraceResult> *optOutResults = nullptr) const = 0;
 		virtual Bool Sweep(const TraceData &data, std::vector<TraceResult> *optOutResults = nullptr) const = 0;
+		// Executes all queries of the batch. The results of each query are written to the result storage of the batch.
+		void OverlapBatch(TraceBatch &batch, TraceBatchFlags flags = {}) const;
+		void RayCastBatch(TraceBatch &batch, TraceBatchFlags flags = {}) const;
+		void SweepBatch(TraceBatch &batch, TraceBatchFlags flags = {}) const;
 
 		const std::vector<util::TSharedHandle<IConstraint>> &GetConstraints() const;
 		std::vector<util::TSharedHandle<IConstraint>> &GetConstraints();
@@ -217,6 +224,10 @@ namespace pragma::physics {
 		void OnConstraintBroken(IConstraint &constraint);
 		virtual void OnVisualDebuggerChanged(pragma::physics::IVisualDebugger *debugger) {}
 		virtual RemainingDeltaTime DoStepSimulation(float timeStep, int maxSubSteps = 1, float fixedTimeStep = (1.f / 60.f)) = 0;
+		// Physics modules can overwrite this to provide a native batched query path. The default implementation
+		// executes the queries one by one, or distributes them across the engine's job system if TraceBatchFlags::Parallel is set.
+		virtual void DoTraceBatch(TraceQueryType type, TraceBatch &batch, TraceBatchFlags flags) const;
+		Bool ExecuteQuery(TraceQueryType type, const TraceData &data, std::vector<TraceResult> *optOutResults) const;
 		virtual void UpdateSurfaceTypes() = 0;
 
 		std::unique_ptr<pragma::physics::IVisualDebugger> m_visualDebugger;
@@ -0,0 +1,54 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#ifndef __TRACE_BATCH_HPP__
+#define __TRACE_BATCH_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include "pragma/physics/raytraces.h"
+#include <vector>
+
+namespace pragma::physics {
+	enum class TraceQueryType : uint8_t { Overlap = 0u, RayCast, Sweep };
+	enum class TraceBatchFlags : uint8_t {
+		None = 0u,
+		// Distributes the queries across the engine's job system. Must only be used if the filters of all
+		// queries are thread-safe (i.e. no Lua filters)!
+		Parallel = 1u,
+	};
+
+	// Set of trace queries that are executed together. The result storage of a query is kept when the batch is cleared,
+	// so a batch that is re-used (e.g. every tick) doesn't need to allocate memory once it has warmed up.
+	class DLLNETWORK TraceBatch {
+	  public:
+		TraceBatch() = default;
+		void Reserve(uint32_t numQueries);
+		// Removes all queries, but keeps the allocated memory
+		void Clear();
+		// Returns the index of the query
+		uint32_t AddQuery(const TraceData &data);
+		uint32_t GetQueryCount() const { return m_numQueries; }
+		const TraceData &GetQuery(uint32_t idx) const { return m_queries[idx]; }
+		TraceData &GetQuery(uint32_t idx) { return m_queries[idx]; }
+
+		bool HasHit(uint32_t idx) const { return m_hits[idx] != 0; }
+		const std::vector<TraceResult> &GetResults(uint32_t idx) const { return m_results[idx]; }
+		std::vector<TraceResult> &GetResults(uint32_t idx) { return m_results[idx]; }
+		// For use by the physics environment only. Queries of the same batch may be executed concurrently,
+		// but each query must only be written to by one thread.
+		void SetHit(uint32_t idx, bool hit) { m_hits[idx] = hit ? 1 : 0; }
+	  private:
+		std::vector<TraceData> m_queries;
+		std::vector<std::vector<TraceResult>> m_results;
+		// Not a std::vector<bool>, since queries may be written to concurrently
+		std::vector<uint8_t> m_hits;
+		uint32_t m_numQueries = 0;
+	};
+};
+REGISTER_BASIC_BITWISE_OPERATORS(pragma::physics::TraceBatchFlags)
+
+#endif
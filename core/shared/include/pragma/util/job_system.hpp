@@ -0,0 +1,96 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#ifndef __JOB_SYSTEM_HPP__
+#define __JOB_SYSTEM_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <array>
+#include <string>
+#include <limits>
+#include <exception>
+
+namespace pragma {
+	class JobSystem;
+	// Completion counter for a group of jobs. Jobs only ever decrement the counter, so
+	// completing a job is wait-free.
+	class DLLNETWORK JobCounter {
+	  public:
+		JobCounter() = default;
+		JobCounter(const JobCounter &) = delete;
+		JobCounter &operator=(const JobCounter &) = delete;
+		bool IsComplete() const { return GetPendingCount() == 0; }
+		uint32_t GetPendingCount() const { return m_pending.load(std::memory_order_acquire); }
+	  private:
+		friend JobSystem;
+		std::atomic<uint32_t> m_pending = 0;
+		// First exception that was thrown by one of the jobs (or their child jobs)
+		std::atomic<bool> m_hasException = false;
+		std::exception_ptr m_exception;
+	};
+
+	// Work-stealing job scheduler. Every worker owns a lock-free deque, jobs scheduled from within a job are pushed onto the
+	// deque of the executing worker and idle workers steal from the others. Jobs scheduled from any other thread go through a
+	// shared lock-free injection queue.
+	class DLLNETWORK JobSystem {
+	  public:
+		using Function = std::function<void()>;
+		static constexpr uint32_t INVALID_WORKER_INDEX = std::numeric_limits<uint32_t>::max();
+		// Index of the worker of this job system that the calling thread belongs to, or INVALID_WORKER_INDEX
+		uint32_t GetCurrentWorkerIndex() const;
+
+		JobSystem(uint32_t numWorkers, const std::string &name);
+		~JobSystem();
+		JobSystem(const JobSystem &) = delete;
+		JobSystem &operator=(const JobSystem &) = delete;
+
+		// The counter (if specified) is incremented immediately and decremented once the job and all of its child jobs have completed
+		void Schedule(Function f, JobCounter *counter = nullptr);
+		// Schedules a job as a child of the job that is currently being executed on this thread. The parent is only
+		// considered complete once all of its children have completed as well.
+		// If called outside of a job, this is equivalent to Schedule(f).
+		void ScheduleChild(Function f);
+		// Blocks until the counter has reached zero. In the meantime the calling thread executes jobs from its own queue (if it is a worker)
+		// and jobs that belong to the counter, but never unrelated jobs of other threads.
+		// If any of the jobs has thrown an exception, the first one is rethrown once all jobs have completed.
+		void Wait(JobCounter &counter);
+		uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+	  private:
+		struct Job;
+		class WorkStealingQueue;
+		class JobQueue;
+		struct Worker;
+		void RunWorker(uint32_t workerIdx);
+		Job *AllocateJob(Function &&f);
+		void FreeJob(Job *job);
+		void Submit(Job *job);
+		Job *FindJob(uint32_t workerIdx);
+		// Only returns jobs that may be executed while waiting for the counter. outHasOtherJobs is set to true if there are jobs of other threads queued.
+		Job *FindJob(uint32_t workerIdx, const JobCounter &counter, bool &outHasOtherJobs);
+		void Execute(Job *job);
+		void Finish(Job *job);
+		void WakeWorkers();
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		std::unique_ptr<JobQueue> m_injectionQueue;
+		// Pre-allocated jobs, so scheduling a job usually doesn't require a heap allocation
+		std::unique_ptr<Job[]> m_jobPool;
+		std::unique_ptr<JobQueue> m_freeJobs;
+		std::atomic<bool> m_running = true;
+		std::atomic<uint32_t> m_wakeEpoch = 0;
+		std::atomic<uint32_t> m_numSleepingWorkers = 0;
+		// Incremented whenever a job counter has reached zero
+		std::atomic<uint32_t> m_completionEpoch = 0;
+	};
+};
+
+#endif
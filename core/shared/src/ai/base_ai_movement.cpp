@@ -282,7 +282,7 @@ void BaseAIComponent::BlendAnimationMovementMT(std::vector<umath::Transform> &bo
 	auto animIdle = hMdl->GetAnimation(m_seqIdle);
 	if(animIdle == nullptr)
 		return;
-	auto frame = animIdle->GetFrame(0);
+	auto frame = animIdle->ReadFrame(0);
 	if(frame == NULL)
 		return;
 	auto pVelComponent = ent.GetComponent<pragma::VelocityComponent>();
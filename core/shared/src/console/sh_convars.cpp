@@ -20,6 +20,8 @@
 #include <pragma/engine_version.h>
 #include <pragma/lua/lua_doc.hpp>
 #include <pragma/asset/util_asset.hpp>
+#include "pragma/model/model.h"
+#include "pragma/entities/components/bvh_data.hpp"
 #include <map>
 
 #define DLLSPEC_ISTEAMWORKS DLLNETWORK
@@ -261,6 +263,99 @@ REGISTER_SHARED_CONCOMMAND(
   },
   ConVarFlags::None, "Finds similar console commands to whatever was given as argument.");
 
+REGISTER_SHARED_CONCOMMAND(
+  bvh_generate_model_data,
+  [](NetworkState *state, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  if(argv.empty()) {
+		  Con::cwar << "No model specified!" << Con::endl;
+		  return;
+	  }
+	  auto *game = state->GetGameState();
+	  if(game == nullptr) {
+		  Con::cwar << "No active game!" << Con::endl;
+		  return;
+	  }
+	  auto &mdlName = argv.front();
+	  auto mdl = game->LoadModel(mdlName);
+	  if(mdl == nullptr) {
+		  Con::cwar << "Failed to load model '" << mdlName << "'!" << Con::endl;
+		  return;
+	  }
+	  // These have to be the same meshes that are used for the BVH of an entity with the default body groups,
+	  // otherwise the stored hierarchy won't be found at runtime
+	  std::vector<uint32_t> bodyGroups(mdl->GetBodyGroupCount(), 0);
+	  std::vector<std::shared_ptr<ModelSubMesh>> meshes;
+	  auto numLods = umath::max(mdl->GetLODCount(), static_cast<uint32_t>(1));
+	  for(auto lod = decltype(numLods) {0u}; lod < numLods; ++lod)
+		  mdl->GetBodyGroupMeshes(bodyGroups, lod, meshes);
+	  auto bvhData = pragma::BaseBvhComponent::RebuildBvh(*mdl, meshes, true);
+	  if(bvhData == nullptr || bvhData->primitives.empty()) {
+		  Con::cwar << "Model '" << mdlName << "' has no triangle meshes!" << Con::endl;
+		  return;
+	  }
+	  std::string err;
+	  if(mdl->Save(*game, err) == false) {
+		  Con::cwar << "Failed to save model '" << mdlName << "': " << err << Con::endl;
+		  return;
+	  }
+	  Con::cout << "BVH data for model '" << mdlName << "' has been generated and saved." << Con::endl;
+  },
+  ConVarFlags::None, "Builds the BVH for the specified model and stores it in the model file, so it doesn't have to be built when the model is loaded. Usage: bvh_generate_model_data <model>");
+
+REGISTER_SHARED_CONCOMMAND(
+  model_generate_lods,
+  [](NetworkState *state, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  if(argv.size() < 2) {
+		  Con::cwar << "Usage: model_generate_lods <model> <ratio>[:<distance>] [<ratio>[:<distance>]] ..." << Con::endl;
+		  return;
+	  }
+	  auto *game = state->GetGameState();
+	  if(game == nullptr) {
+		  Con::cwar << "No active game!" << Con::endl;
+		  return;
+	  }
+	  constexpr auto DEFAULT_LOD_DISTANCE_STEP = 50.f;
+	  std::vector<float> triangleRatios;
+	  std::vector<float> distances;
+	  for(auto it = argv.begin() + 1; it != argv.end(); ++it) {
+		  std::vector<std::string> values;
+		  ustring::explode(*it, ":", values);
+		  if(values.empty())
+			  continue;
+		  triangleRatios.push_back(util::to_float(values[0]));
+		  distances.push_back((values.size() > 1) ? util::to_float(values[1]) : (DEFAULT_LOD_DISTANCE_STEP * triangleRatios.size()));
+	  }
+	  auto &mdlName = argv.front();
+	  auto mdl = game->LoadModel(mdlName);
+	  if(mdl == nullptr) {
+		  Con::cwar << "Failed to load model '" << mdlName << "'!" << Con::endl;
+		  return;
+	  }
+	  std::vector<float> achievedRatios;
+	  if(mdl->GenerateLODs(triangleRatios, distances, std::numeric_limits<float>::max(), &achievedRatios) == false) {
+		  Con::cwar << "Model '" << mdlName << "' has no meshes to generate LODs for!" << Con::endl;
+		  return;
+	  }
+	  std::string err;
+	  if(mdl->Save(*game, err) == false) {
+		  Con::cwar << "Failed to save model '" << mdlName << "': " << err << Con::endl;
+		  return;
+	  }
+	  Con::cout << "Generated " << triangleRatios.size() << " LODs for model '" << mdlName << "':" << Con::endl;
+	  // Tolerance for the rounding of the per-mesh target triangle counts
+	  constexpr auto RATIO_TOLERANCE = 0.01f;
+	  for(auto i = decltype(achievedRatios.size()) {0u}; i < achievedRatios.size(); ++i) {
+		  auto requested = umath::clamp(triangleRatios[i], 0.f, 1.f);
+		  auto achieved = achievedRatios[i];
+		  if(achieved > requested + RATIO_TOLERANCE)
+			  Con::cwar << "LOD " << (i + 1) << ": Requested triangle ratio " << requested << ", achieved " << achieved << " (mesh could not be simplified further)" << Con::endl;
+		  else
+			  Con::cout << "LOD " << (i + 1) << ": Requested triangle ratio " << requested << ", achieved " << achieved << Con::endl;
+	  }
+  },
+  ConVarFlags::None,
+  "Generates simplified LOD meshes for the specified model and saves it. Each LOD is specified by the ratio of triangles relative to LOD 0 and optionally the LOD distance (defaults to 50 per LOD level). Usage: model_generate_lods <model> <ratio>[:<distance>] [<ratio>[:<distance>]] ...");
+
 REGISTER_ENGINE_CONCOMMAND(
   listmaps,
   [](NetworkState *, pragma::BasePlayerComponent *, std::vector<std::string> &) {
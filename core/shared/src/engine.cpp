@@ -24,6 +24,7 @@
 #include "pragma/console/cvar.h"
 #include "pragma/debug/debug_performance_profiler.hpp"
 #include "pragma/localization.h"
+#include "pragma/util/job_system.hpp"
 #include <pragma/asset/util_asset.hpp>
 #include <sharedutils/util.h>
 #include <sharedutils/util_clock.hpp>
@@ -115,6 +116,7 @@ Engine::Engine(int, char *[]) : CVarHandler(), m_logFile(nullptr), m_tickRate(En
 	// Link package system to file system
 	m_padPackageManager = upad::link_to_file_system();
 	m_assetManager = std::make_unique<pragma::asset::AssetManager>();
+	m_jobSystem = std::make_unique<pragma::JobSystem>(std::max(std::thread::hardware_concurrency(), 2u) - 1, "engine");
 
 	RegisterCallback<void>("Think");
 
@@ -133,6 +135,7 @@ Engine::Engine(int, char *[]) : CVarHandler(), m_logFile(nullptr), m_tickRate(En
 
 pragma::asset::AssetManager &Engine::GetAssetManager() { return *m_assetManager; }
 const pragma::asset::AssetManager &Engine::GetAssetManager() const { return const_cast<Engine *>(this)->GetAssetManager(); }
+pragma::JobSystem &Engine::GetJobSystem() { return *m_jobSystem; }
 
 void Engine::ClearConsole() { std::system("cls"); }
 
@@ -829,10 +832,15 @@ void Engine::Start()
 
 	InvokeConVarChangeCallbacks("steam_steamworks_enabled");
 
-	//const double FRAMES_PER_SECOND = GetTickRate();
-	//const double SKIP_TICKS = 1000 /FRAMES_PER_SECOND;
+	using Clock = std::chrono::steady_clock;
 	const int MAX_FRAMESKIP = 5;
-	long long nextTick = GetTickCount();
+	// Sleeping is only accurate to the scheduler granularity, the remainder is spent yielding
+#ifdef _WIN32
+	constexpr auto SPIN_THRESHOLD = std::chrono::milliseconds {2};
+#else
+	constexpr auto SPIN_THRESHOLD = std::chrono::milliseconds {1};
+#endif
+	auto nextTick = Clock::now();
 	int loops;
 	do {
 		StartProfilingStage(CPUProfilingPhase::Think);
@@ -840,19 +848,40 @@ void Engine::Start()
 		StopProfilingStage(CPUProfilingPhase::Think);
 
 		loops = 0;
-		auto tickRate = GetTickRate();
-		auto skipTicks = static_cast<long long>(1'000 / tickRate);
+		// The tick rate may change at any time, so the interval is re-evaluated every iteration.
+		// Scheduling with a floating point interval avoids the drift of an integer millisecond step (e.g. 1000 /60).
+		auto tickInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double> {1.0 / static_cast<double>(std::max<UInt32>(GetTickRate(), 1u))});
 
-		auto t = GetTickCount();
-		while(t > nextTick && loops < MAX_FRAMESKIP) {
+		auto t = Clock::now();
+		while(t >= nextTick && loops < MAX_FRAMESKIP) {
+			auto tStart = Clock::now();
 			Tick();
+			auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - tStart);
 
 			m_lastTick = static_cast<long long>(m_ctTick());
-			nextTick += skipTicks; //SKIP_TICKS);
+			++m_tickStats.tickCount;
+			m_tickStats.lastTickDuration = dt;
+			m_tickStats.maxTickDuration = std::max(m_tickStats.maxTickDuration, dt);
+			m_tickStats.totalTickDuration += dt;
+			if(dt > tickInterval)
+				++m_tickStats.overrunCount;
+
+			nextTick += tickInterval;
 			loops++;
 		}
-		if(t > nextTick)
-			nextTick = t; // This should only happen after loading times
+		if(t >= nextTick) {
+			// We've fallen too far behind to catch up (this should only happen after loading times), skip the remaining ticks
+			m_tickStats.droppedTickCount += static_cast<uint64_t>((t - nextTick) / tickInterval) + 1;
+			nextTick = t + tickInterval;
+		}
+
+		// The client's think renders frames and handles its own frame pacing, so we only wait for the next tick on a dedicated server
+		if(IsServerOnly() && IsRunning()) {
+			if(nextTick - Clock::now() > SPIN_THRESHOLD)
+				std::this_thread::sleep_until(nextTick - SPIN_THRESHOLD);
+			while(Clock::now() < nextTick)
+				std::this_thread::yield();
+		}
 	} while(IsRunning());
 	Close();
 }
@@ -936,6 +965,9 @@ void Engine::DumpDebugInformation(ZIPFile &zip) const
 
 const long long &Engine::GetLastTick() const { return m_lastTick; }
 
+const Engine::TickStats &Engine::GetTickStats() const { return m_tickStats; }
+void Engine::ResetTickStats() { m_tickStats = {}; }
+
 long long Engine::GetDeltaTick() const { return GetTickCount() - m_lastTick; }
 
 void Engine::Think()
@@ -48,6 +48,25 @@ void Engine::RegisterSharedConsoleCommands(ConVarMap &map)
 			  autoCompleteOptions.push_back(mapName);
 		  }
 	  });
+	map.RegisterConCommand(
+	  "debug_tick_stats",
+	  [this](NetworkState *state, pragma::BasePlayerComponent *, std::vector<std::string> &argv, float) {
+		  if(!argv.empty() && argv.front() == "reset") {
+			  ResetTickStats();
+			  return;
+		  }
+		  auto &stats = GetTickStats();
+		  auto toMs = [](std::chrono::nanoseconds t) { return std::chrono::duration<double, std::milli> {t}.count(); };
+		  auto avg = (stats.tickCount > 0) ? (toMs(stats.totalTickDuration) / static_cast<double>(stats.tickCount)) : 0.0;
+		  Con::cout << "Tick rate: " << GetTickRate() << " (" << (1'000.0 / static_cast<double>(std::max<UInt32>(GetTickRate(), 1u))) << " ms)" << Con::endl;
+		  Con::cout << "Ticks: " << stats.tickCount << Con::endl;
+		  Con::cout << "Overruns: " << stats.overrunCount << Con::endl;
+		  Con::cout << "Dropped ticks: " << stats.droppedTickCount << Con::endl;
+		  Con::cout << "Last tick duration: " << toMs(stats.lastTickDuration) << " ms" << Con::endl;
+		  Con::cout << "Average tick duration: " << avg << " ms" << Con::endl;
+		  Con::cout << "Max tick duration: " << toMs(stats.maxTickDuration) << " ms" << Con::endl;
+	  },
+	  ConVarFlags::None, "Prints timing statistics of the engine ticks. Usage: debug_tick_stats <reset>");
 	map.RegisterConCommand(
 	  "udm_convert",
 	  [this](NetworkState *state, pragma::BasePlayerComponent *, std::vector<std::string> &argv, float) {
@@ -52,6 +52,8 @@ void BaseActorComponent::Initialize()
 	BindEventUnhandled(BasePhysicsComponent::EVENT_ON_PHYSICS_UPDATED, [this](std::reference_wrapper<pragma::ComponentEvent> evData) { PhysicsUpdate(0.0 /* unused */); });
 
 	auto &ent = GetEntity();
+	// Hitbox history is only needed for lag compensation on the server
+	m_hitboxHistoryEnabled = ent.GetNetworkState()->IsServer();
 	ent.AddComponent("gravity");
 	ent.AddComponent("name");
 	ent.AddComponent("flammable");
@@ -260,6 +262,7 @@ void BaseActorComponent::OnPhysicsInitialized()
 	if(physEnv == nullptr)
 		return;
 	m_hitboxData.clear();
+	ClearHitboxHistory();
 	auto &hMdl = ent.GetModel();
 	if(hMdl == nullptr)
 		return;
@@ -317,7 +320,14 @@ bool BaseActorComponent::FindHitgroup(const pragma::physics::ICollisionObject &p
 	hitgroup = itHitbox->second.group;
 	return true;
 }
-void BaseActorComponent::PhysicsUpdate(double) { UpdateHitboxPhysics(); }
+void BaseActorComponent::PhysicsUpdate(double)
+{
+	if(m_hitboxesRewound)
+		RestoreHitboxes();
+	UpdateHitboxPhysics();
+	if(m_hitboxHistoryEnabled)
+		RecordHitboxHistory(GetEntity().GetNetworkState()->GetGameState()->CurTime());
+}
 PhysObjHandle BaseActorComponent::GetHitboxPhysicsObject() const { return (m_physHitboxes == nullptr) ? PhysObjHandle {} : m_physHitboxes->GetHandle(); }
 void BaseActorComponent::UpdateHitboxPhysics()
 {
@@ -352,6 +362,96 @@ void BaseActorComponent::OnPhysicsDestroyed()
 {
 	m_physHitboxes = nullptr;
 	m_hitboxData.clear();
+	ClearHitboxHistory();
+}
+
+const BaseActorComponent::HitboxHistoryEntry &BaseActorComponent::GetHitboxHistoryEntry(uint32_t age) const { return m_hitboxHistory[(m_hitboxHistoryHead + HITBOX_HISTORY_SIZE - 1 - age) % HITBOX_HISTORY_SIZE]; }
+void BaseActorComponent::ClearHitboxHistory()
+{
+	m_hitboxHistoryHead = 0;
+	m_hitboxHistoryCount = 0;
+	m_hitboxesRewound = false;
+}
+void BaseActorComponent::RecordHitboxHistory(double t)
+{
+	if(m_physHitboxes == nullptr)
+		return;
+	// The physics may be updated multiple times per tick, in which case we only keep the last state
+	if(m_hitboxHistoryCount == 0 || GetHitboxHistoryEntry(0).time != t) {
+		m_hitboxHistoryHead = (m_hitboxHistoryHead + 1) % HITBOX_HISTORY_SIZE;
+		m_hitboxHistoryCount = umath::min(m_hitboxHistoryCount + 1, HITBOX_HISTORY_SIZE);
+	}
+	auto &entry = m_hitboxHistory[(m_hitboxHistoryHead + HITBOX_HISTORY_SIZE - 1) % HITBOX_HISTORY_SIZE];
+	entry.time = t;
+	auto &colObjs = m_physHitboxes->GetCollisionObjects();
+	entry.transforms.resize(colObjs.size());
+	for(auto i = decltype(colObjs.size()) {0u}; i < colObjs.size(); ++i) {
+		auto *col = colObjs[i].Get();
+		entry.transforms[i] = col ? umath::Transform {col->GetPos(), col->GetRotation()} : umath::Transform {};
+	}
+}
+std::optional<double> BaseActorComponent::GetHitboxHistoryStartTime() const
+{
+	if(m_hitboxHistoryCount == 0)
+		return {};
+	return GetHitboxHistoryEntry(m_hitboxHistoryCount - 1).time;
+}
+void BaseActorComponent::ApplyHitboxTransforms(const std::vector<umath::Transform> &transforms)
+{
+	auto &colObjs = m_physHitboxes->GetCollisionObjects();
+	auto n = umath::min(colObjs.size(), transforms.size());
+	for(auto i = decltype(n) {0u}; i < n; ++i) {
+		auto *col = colObjs[i].Get();
+		if(col == nullptr)
+			continue;
+		col->SetPos(transforms[i].GetOrigin());
+		col->SetRotation(transforms[i].GetRotation());
+	}
+}
+bool BaseActorComponent::RewindHitboxes(double t)
+{
+	if(m_physHitboxes == nullptr || m_hitboxHistoryCount == 0)
+		return false;
+	// Find the two recorded states surrounding t
+	uint32_t age = 0;
+	while(age < m_hitboxHistoryCount && GetHitboxHistoryEntry(age).time > t)
+		++age;
+	if(age == 0)
+		return false; // t is at or after the latest recorded state, nothing to rewind
+	auto &colObjs = m_physHitboxes->GetCollisionObjects();
+	if(!m_hitboxesRewound) {
+		m_hitboxRestoreTransforms.resize(colObjs.size());
+		for(auto i = decltype(colObjs.size()) {0u}; i < colObjs.size(); ++i) {
+			auto *col = colObjs[i].Get();
+			m_hitboxRestoreTransforms[i] = col ? umath::Transform {col->GetPos(), col->GetRotation()} : umath::Transform {};
+		}
+		m_hitboxesRewound = true;
+	}
+	auto &next = GetHitboxHistoryEntry(age - 1);
+	if(age == m_hitboxHistoryCount) {
+		// t is older than our history, use the oldest state we have
+		ApplyHitboxTransforms(next.transforms);
+		return true;
+	}
+	auto &prev = GetHitboxHistoryEntry(age);
+	auto dt = next.time - prev.time;
+	auto f = (dt > 0.0) ? static_cast<float>((t - prev.time) / dt) : 1.f;
+	thread_local std::vector<umath::Transform> transforms;
+	auto n = umath::min(prev.transforms.size(), next.transforms.size());
+	transforms.resize(n);
+	for(auto i = decltype(n) {0u}; i < n; ++i)
+		transforms[i] = umath::Transform {uvec::lerp(prev.transforms[i].GetOrigin(), next.transforms[i].GetOrigin(), f), uquat::slerp(prev.transforms[i].GetRotation(), next.transforms[i].GetRotation(), f)};
+	ApplyHitboxTransforms(transforms);
+	return true;
+}
+void BaseActorComponent::RestoreHitboxes()
+{
+	if(!m_hitboxesRewound)
+		return;
+	m_hitboxesRewound = false;
+	if(m_physHitboxes == nullptr)
+		return;
+	ApplyHitboxTransforms(m_hitboxRestoreTransforms);
 }
 
 ///////////////
@@ -17,6 +17,7 @@
 #include "pragma/util/global_string_table.hpp"
 #include "pragma/game/animation_update_manager.hpp"
 #include "pragma/model/model.h"
+#include "pragma/model/animation/compressed_animation.hpp"
 #include "pragma/audio/alsound_type.h"
 #include "pragma/lua/luafunction_call.h"
 #include <panima/skeleton.hpp>
@@ -135,7 +136,48 @@ void BaseAnimatedComponent::UpdateAnimations(double dt)
 	m_stateFlags |= StateFlags::IsAnimated;
 	auto &ent = GetEntity();
 	auto pTimeScaleComponent = ent.GetTimeScaleComponent();
+	umath::set_flag(m_stateFlags, StateFlags::DeferMainThreadEvents);
 	MaintainAnimations(dt * (pTimeScaleComponent.valid() ? pTimeScaleComponent->GetEffectiveTimeScale() : 1.f));
+	umath::set_flag(m_stateFlags, StateFlags::DeferMainThreadEvents, false);
+}
+void BaseAnimatedComponent::FlushDeferredAnimationEvents()
+{
+	for(auto &selection : m_deferredAnimationSelections) {
+		AnimationSlotInfo *animInfo = nullptr;
+		if(selection.layeredSlot == -1)
+			animInfo = &m_baseAnim;
+		else {
+			auto it = m_animSlots.find(selection.layeredSlot);
+			if(it != m_animSlots.end())
+				animInfo = &it->second;
+		}
+		if(animInfo == nullptr)
+			continue;
+		// The model's random number generator is not thread-safe
+		auto animId = SelectWeightedAnimation(selection.activity, selection.animAvoid);
+		if(animId == -1)
+			continue;
+		animInfo->animation = animId;
+		SetBaseAnimationDirty();
+	}
+	m_deferredAnimationSelections.clear();
+
+	if(m_deferredBoneTransformEvents.empty())
+		return;
+	// A bone may have been changed multiple times, the listeners only need the final transform
+	std::sort(m_deferredBoneTransformEvents.begin(), m_deferredBoneTransformEvents.end(), [](const DeferredBoneTransformEvent &a, const DeferredBoneTransformEvent &b) { return a.boneId < b.boneId; });
+	for(auto it = m_deferredBoneTransformEvents.begin(); it != m_deferredBoneTransformEvents.end();) {
+		auto boneId = it->boneId;
+		auto scale = false;
+		for(; it != m_deferredBoneTransformEvents.end() && it->boneId == boneId; ++it)
+			scale = scale || it->scale;
+		if(boneId >= m_bones.size())
+			continue;
+		auto &pose = m_bones[boneId];
+		CEOnBoneTransformChanged evData {boneId, &pose.GetOrigin(), &pose.GetRotation(), scale ? &pose.GetScale() : nullptr};
+		InvokeEventCallbacks(EVENT_ON_BONE_TRANSFORM_CHANGED, evData);
+	}
+	m_deferredBoneTransformEvents.clear();
 }
 
 void BaseAnimatedComponent::ResetAnimation(const std::shared_ptr<Model> &mdl)
@@ -145,6 +187,7 @@ void BaseAnimatedComponent::ResetAnimation(const std::shared_ptr<Model> &mdl)
 	m_blendControllers.clear();
 	m_bones.clear();
 	m_processedBones.clear();
+	m_flatBoneHierarchy.Clear();
 	m_bindPose = nullptr;
 	umath::set_flag(m_stateFlags, StateFlags::AbsolutePosesDirty);
 	ApplyAnimationEventTemplates();
@@ -477,13 +520,13 @@ void BaseAnimatedComponent::ClearPreviousAnimation()
 	lastAnim.blendTimeScale = {0.f, 0.f};
 	lastAnim.animation = -1;
 }
-Frame *BaseAnimatedComponent::GetPreviousAnimationBlendFrame(AnimationSlotInfo &animInfo, double tDelta, float &blendScale)
+bool BaseAnimatedComponent::GetPreviousAnimationBlendFrame(AnimationSlotInfo &animInfo, double tDelta, float &blendScale, std::shared_ptr<pragma::animation::Animation> &outAnim, uint32_t &outFrame)
 {
 	auto mdlComponent = GetEntity().GetModelComponent();
 	auto &hModel = GetEntity().GetModel();
 	if(hModel == nullptr)
-		return nullptr;
-	Frame *frameLastAnim = nullptr;
+		return false;
+	auto found = false;
 	auto &lastAnim = animInfo.lastAnim;
 	if(lastAnim.animation != -1) {
 		lastAnim.blendTimeScale.second -= static_cast<float>(tDelta);
@@ -493,14 +536,71 @@ Frame *BaseAnimatedComponent::GetPreviousAnimationBlendFrame(AnimationSlotInfo &
 		}
 		else {
 			auto anim = hModel->GetAnimation(lastAnim.animation);
-			if(anim != nullptr) {
-				auto frameLast = umath::floor((anim->GetFrameCount() - 1) * lastAnim.cycle);
-				frameLastAnim = anim->GetFrame(frameLast).get();
+			if(anim != nullptr && anim->GetFrameCount() > 0) {
+				outAnim = anim;
+				outFrame = static_cast<uint32_t>(umath::floor((anim->GetFrameCount() - 1) * lastAnim.cycle));
+				found = true;
 			}
 		}
 		blendScale = ((lastAnim.blendTimeScale.first != 0.f) ? (lastAnim.blendTimeScale.second / lastAnim.blendTimeScale.first) : 0.f) * lastAnim.blendScale;
 	}
-	return frameLastAnim;
+	return found;
+}
+bool BaseAnimatedComponent::SampleAnimationFrame(pragma::animation::Animation &anim, uint32_t frameIdx, std::vector<umath::Transform> &outPoses, std::vector<Vector3> &outScales)
+{
+	auto compressed = anim.GetCompressedData();
+	if(compressed) {
+		if(frameIdx >= compressed->GetFrameCount())
+			return false;
+		compressed->SampleFrame(frameIdx, outPoses, outScales);
+		return true;
+	}
+	auto frame = anim.GetFrame(frameIdx);
+	if(frame == nullptr)
+		return false;
+	outPoses = frame->GetBoneTransforms();
+	outScales = frame->GetBoneScales();
+	return true;
+}
+bool BaseAnimatedComponent::SampleAnimation(pragma::animation::Animation &anim, float cycle, std::vector<umath::Transform> &outPoses, std::vector<Vector3> &outScales, pragma::animation::Animation *optWeightAnim) const
+{
+	auto &weightAnim = optWeightAnim ? *optWeightAnim : anim;
+	auto compressed = anim.GetCompressedData();
+	if(compressed) {
+		// Sample the compressed curves directly, without decompressing the frames of the animation
+		auto numFrames = compressed->GetFrameCount();
+		if(numFrames == 0)
+			return false;
+		auto frameVal = (numFrames - 1) * cycle;
+		auto interpFactor = frameVal - static_cast<float>(umath::floor(frameVal));
+		auto frameSrc = std::min(static_cast<uint32_t>(std::max(static_cast<int32_t>(frameVal), 0)), numFrames - 1);
+		auto frameDst = std::min(frameSrc + 1, numFrames - 1);
+		compressed->SampleFrame(frameSrc, outPoses, outScales);
+		if(frameDst == frameSrc)
+			return true;
+		thread_local std::vector<umath::Transform> dstPoses;
+		thread_local std::vector<Vector3> dstScales;
+		compressed->SampleFrame(frameDst, dstPoses, dstScales);
+		BlendBonePoses(outPoses, &outScales, dstPoses, &dstScales, outPoses, &outScales, weightAnim, interpFactor);
+		return true;
+	}
+
+	Frame *srcFrame, *dstFrame;
+	float interpFactor;
+	if(GetBlendFramesFromCycle(anim, cycle, &srcFrame, &dstFrame, interpFactor) == false)
+		return false;
+	if(dstFrame) {
+		auto numBones = anim.GetBoneList().size();
+		outPoses.resize(numBones);
+		outScales.resize(numBones, Vector3 {1.f, 1.f, 1.f});
+		BlendBonePoses(srcFrame->GetBoneTransforms(), &srcFrame->GetBoneScales(), dstFrame->GetBoneTransforms(), &dstFrame->GetBoneScales(), outPoses, &outScales, weightAnim, interpFactor);
+	}
+	else {
+		// Destination frame can be nullptr if no interpolation is required.
+		outPoses = srcFrame->GetBoneTransforms();
+		outScales = srcFrame->GetBoneScales();
+	}
+	return true;
 }
 void BaseAnimatedComponent::ApplyAnimationBlending(AnimationSlotInfo &animInfo, double tDelta)
 {
@@ -561,7 +661,13 @@ bool BaseAnimatedComponent::MaintainAnimation(AnimationSlotInfo &animInfo, doubl
 			if(bLoop == true) {
 				cycleNew -= floor(cycleNew);
 				if(anim->HasFlag(FAnim::NoRepeat)) {
-					animId = SelectWeightedAnimation(act, animId);
+					if(umath::is_flag_set(m_stateFlags, StateFlags::DeferMainThreadEvents))
+						m_deferredAnimationSelections.push_back({layeredSlot, act, animId});
+					else {
+						auto newAnimId = SelectWeightedAnimation(act, animId);
+						if(newAnimId != -1)
+							animInfo.animation = newAnimId;
+					}
 					cycle = cycleNew;
 					SetBaseAnimationDirty();
 					return MaintainAnimation(animInfo, dt);
@@ -592,17 +698,10 @@ bool BaseAnimatedComponent::MaintainAnimation(AnimationSlotInfo &animInfo, doubl
 	std::vector<umath::Transform> bonePoses {};
 	std::vector<Vector3> boneScales {};
 
-	// Blend between the last frame and the current frame of this animation.
-	Frame *srcFrame, *dstFrame;
-	float interpFactor;
-	if(GetBlendFramesFromCycle(*anim, cycle, &srcFrame, &dstFrame, interpFactor) == false)
+	if(anim->GetFrameCount() == 0)
 		return false; // This shouldn't happen unless the animation has no frames
-
-	//if(dstFrame)
-	{
-		bonePoses.resize(numBones);
-		boneScales.resize(numBones, Vector3 {1.f, 1.f, 1.f});
-	}
+	bonePoses.resize(numBones);
+	boneScales.resize(numBones, Vector3 {1.f, 1.f, 1.f});
 
 	// Blend Controllers
 	auto *animBcData = anim->GetBlendController();
@@ -631,53 +730,21 @@ bool BaseAnimatedComponent::MaintainAnimation(AnimationSlotInfo &animInfo, doubl
 				// of both animations.
 
 				// Interpolated poses of source animation
-				Frame *srcFrame, *dstFrame;
-				float animInterpFactor;
 				std::vector<umath::Transform> ppBonePosesSrc {};
 				std::vector<Vector3> ppBoneScalesSrc {};
-				if(GetBlendFramesFromCycle(*blendAnimSrc, cycle, &srcFrame, &dstFrame, animInterpFactor)) {
-					if(dstFrame) {
-						ppBonePosesSrc.resize(numBones);
-						ppBoneScalesSrc.resize(numBones, Vector3 {1.f, 1.f, 1.f});
-						BlendBonePoses(srcFrame->GetBoneTransforms(), &srcFrame->GetBoneScales(), dstFrame->GetBoneTransforms(), &dstFrame->GetBoneScales(), ppBonePosesSrc, &ppBoneScalesSrc, *blendAnimSrc, animInterpFactor);
-					}
-					else {
-						ppBonePosesSrc = srcFrame->GetBoneTransforms();
-						ppBoneScalesSrc = srcFrame->GetBoneScales();
-					}
-				}
+				SampleAnimation(*blendAnimSrc, cycle, ppBonePosesSrc, ppBoneScalesSrc);
 
 				// Interpolated poses of destination animation
 				std::vector<umath::Transform> ppBonePosesDst {};
 				std::vector<Vector3> ppBoneScalesDst {};
-				if(GetBlendFramesFromCycle(*blendAnimDst, cycle, &srcFrame, &dstFrame, animInterpFactor)) {
-					if(dstFrame) {
-						ppBonePosesDst.resize(numBones);
-						ppBoneScalesDst.resize(numBones, Vector3 {1.f, 1.f, 1.f});
-						BlendBonePoses(srcFrame->GetBoneTransforms(), &srcFrame->GetBoneScales(), dstFrame->GetBoneTransforms(), &dstFrame->GetBoneScales(), ppBonePosesDst, &ppBoneScalesDst, *blendAnimSrc, animInterpFactor);
-					}
-					else {
-						ppBonePosesDst = srcFrame->GetBoneTransforms();
-						ppBoneScalesDst = srcFrame->GetBoneScales();
-					}
-				}
+				SampleAnimation(*blendAnimDst, cycle, ppBonePosesDst, ppBoneScalesDst, blendAnimSrc.get());
 
 				// Interpolate between the two frames
 				BlendBonePoses(ppBonePosesSrc, &ppBoneScalesSrc, ppBonePosesDst, &ppBoneScalesDst, bonePoses, &boneScales, *blendAnimSrc, interpFactor);
 
 				if(animBcData->animationPostBlendController != std::numeric_limits<uint32_t>::max() && animBcData->animationPostBlendTarget != std::numeric_limits<uint32_t>::max()) {
 					auto blendAnimPost = hModel->GetAnimation(animBcData->animationPostBlendTarget);
-					if(blendAnimPost && GetBlendFramesFromCycle(*blendAnimPost, cycle, &srcFrame, &dstFrame, animInterpFactor)) {
-						if(dstFrame) {
-							ppBonePosesSrc.resize(numBones);
-							ppBoneScalesSrc.resize(numBones, Vector3 {1.f, 1.f, 1.f});
-							BlendBonePoses(srcFrame->GetBoneTransforms(), &srcFrame->GetBoneScales(), dstFrame->GetBoneTransforms(), &dstFrame->GetBoneScales(), ppBonePosesSrc, &ppBoneScalesSrc, *blendAnimPost, animInterpFactor);
-						}
-						else {
-							ppBonePosesSrc = srcFrame->GetBoneTransforms();
-							ppBoneScalesSrc = srcFrame->GetBoneScales();
-						}
-
+					if(blendAnimPost && SampleAnimation(*blendAnimPost, cycle, ppBonePosesSrc, ppBoneScalesSrc)) {
 						// Interpolate between the two frames
 						auto bcValuePostBlend = GetBlendController(animBcData->animationPostBlendController);
 						auto interpFactor = 1.f - bcValuePostBlend;
@@ -688,24 +755,18 @@ bool BaseAnimatedComponent::MaintainAnimation(AnimationSlotInfo &animInfo, doubl
 		}
 	}
 	else {
-		if(dstFrame) {
-			BlendBonePoses(srcFrame->GetBoneTransforms(), &srcFrame->GetBoneScales(), dstFrame->GetBoneTransforms(), &dstFrame->GetBoneScales(), bonePoses, &boneScales, *anim, interpFactor);
-		}
-		else {
-			// Destination frame can be nullptr if no interpolation is required.
-			bonePoses = srcFrame->GetBoneTransforms();
-			boneScales = srcFrame->GetBoneScales();
-		}
-		//
+		// Blend between the last frame and the current frame of this animation.
+		SampleAnimation(*anim, cycle, bonePoses, boneScales);
 
 		// Blend between previous animation and this animation
 		float interpFactorLastAnim;
-		auto *lastPlayedFrameOfPreviousAnim = GetPreviousAnimationBlendFrame(animInfo, dt, interpFactorLastAnim);
-		if(lastPlayedFrameOfPreviousAnim) {
-			auto lastAnim = hModel->GetAnimation(animInfo.lastAnim.animation);
-			if(lastAnim) {
-				BlendBonePoses(lastPlayedFrameOfPreviousAnim->GetBoneTransforms(), &lastPlayedFrameOfPreviousAnim->GetBoneScales(), bonePoses, &boneScales, bonePoses, &boneScales, *lastAnim, 1.f - interpFactorLastAnim);
-			}
+		std::shared_ptr<pragma::animation::Animation> lastAnim;
+		uint32_t lastAnimFrame;
+		if(GetPreviousAnimationBlendFrame(animInfo, dt, interpFactorLastAnim, lastAnim, lastAnimFrame)) {
+			thread_local std::vector<umath::Transform> lastAnimPoses;
+			thread_local std::vector<Vector3> lastAnimScales;
+			if(SampleAnimationFrame(*lastAnim, lastAnimFrame, lastAnimPoses, lastAnimScales))
+				BlendBonePoses(lastAnimPoses, &lastAnimScales, bonePoses, &boneScales, bonePoses, &boneScales, *lastAnim, 1.f - interpFactorLastAnim);
 		}
 		//
 	}
@@ -1178,21 +1239,44 @@ bool BaseAnimatedComponent::CalcAnimationMovementSpeed(float *x, float *z, int32
 	if(anim == nullptr || (((x != nullptr && anim->HasFlag(FAnim::MoveX) == false) || x == nullptr) && ((z != nullptr && anim->HasFlag(FAnim::MoveZ) == false) || z == nullptr)))
 		return false;
 
-	std::array<Frame *, 2> frames = {nullptr, nullptr};
-	auto blendScale = 0.f;
-	if(GetBlendFramesFromCycle(*anim, GetCycle(), &frames[0], &frames[1], blendScale, frameOffset) == false)
-		return false; // Animation doesn't have any frames?
 	auto animSpeed = GetPlaybackRate();
-	std::array<float, 2> blendScales = {1.f - blendScale, blendScale};
 	Vector2 mvOffset {0.f, 0.f};
-	for(auto i = decltype(frames.size()) {0}; i < frames.size(); ++i) {
-		auto *frame = frames[i];
-		if(frame == nullptr)
-			continue;
-		auto *moveOffset = frame->GetMoveOffset();
-		if(moveOffset == nullptr)
-			continue;
-		mvOffset += *moveOffset * blendScales[i] * animSpeed;
+	auto compressed = anim->GetCompressedData();
+	if(compressed) {
+		auto numFrames = compressed->GetFrameCount();
+		if(numFrames == 0)
+			return false; // Animation doesn't have any frames?
+		auto frameVal = (numFrames - 1) * GetCycle();
+		auto blendScale = frameVal - static_cast<float>(umath::floor(frameVal));
+		auto frameSrc = std::max(static_cast<int32_t>(frameVal) + frameOffset, 0);
+		if(frameSrc >= static_cast<int32_t>(numFrames))
+			return false;
+		auto frameDst = std::max(static_cast<int32_t>(frameVal) + 1 + frameOffset, 0);
+		if(frameDst >= static_cast<int32_t>(numFrames))
+			blendScale = 0.f;
+		std::array<std::optional<Vector2>, 2> moveOffsets = {compressed->GetMoveOffset(frameSrc), compressed->GetMoveOffset(frameDst)};
+		std::array<float, 2> blendScales = {1.f - blendScale, blendScale};
+		for(auto i = decltype(moveOffsets.size()) {0}; i < moveOffsets.size(); ++i) {
+			if(moveOffsets[i].has_value() == false)
+				continue;
+			mvOffset += *moveOffsets[i] * blendScales[i] * animSpeed;
+		}
+	}
+	else {
+		std::array<Frame *, 2> frames = {nullptr, nullptr};
+		auto blendScale = 0.f;
+		if(GetBlendFramesFromCycle(*anim, GetCycle(), &frames[0], &frames[1], blendScale, frameOffset) == false)
+			return false; // Animation doesn't have any frames?
+		std::array<float, 2> blendScales = {1.f - blendScale, blendScale};
+		for(auto i = decltype(frames.size()) {0}; i < frames.size(); ++i) {
+			auto *frame = frames[i];
+			if(frame == nullptr)
+				continue;
+			auto *moveOffset = frame->GetMoveOffset();
+			if(moveOffset == nullptr)
+				continue;
+			mvOffset += *moveOffset * blendScales[i] * animSpeed;
+		}
 	}
 	if(x != nullptr)
 		*x = mvOffset.x;
@@ -10,6 +10,7 @@
 #include "pragma/entities/components/base_model_component.hpp"
 #include "pragma/entities/components/base_transform_component.hpp"
 #include "pragma/model/model.h"
+#include "pragma/model/animation/bone_pose_blend.hpp"
 #include <panima/skeleton.hpp>
 #include <panima/bone.hpp>
 
@@ -220,8 +221,7 @@ void BaseAnimatedComponent::SetBonePosition(UInt32 boneId, const Vector3 &pos, c
 	umath::set_flag(m_stateFlags, StateFlags::AbsolutePosesDirty);
 	//if(updatePhysics == false)
 	//	return;
-	CEOnBoneTransformChanged evData {boneId, &pos, &rot, scale};
-	InvokeEventCallbacks(EVENT_ON_BONE_TRANSFORM_CHANGED, evData);
+	InvokeBoneTransformChanged(boneId, &pos, &rot, scale);
 }
 void BaseAnimatedComponent::SetBonePosition(UInt32 boneId, const Vector3 &pos, const Quat &rot, const Vector3 &scale) { SetBonePosition(boneId, pos, rot, &scale, true); }
 void BaseAnimatedComponent::SetBonePosition(UInt32 boneId, const Vector3 &pos, const Quat &rot) { SetBonePosition(boneId, pos, rot, nullptr, true); }
@@ -233,7 +233,17 @@ void BaseAnimatedComponent::SetBonePosition(UInt32 boneId, const Vector3 &pos)
 	m_bones[boneId].SetOrigin(pos);
 	umath::set_flag(m_stateFlags, StateFlags::AbsolutePosesDirty);
 
-	CEOnBoneTransformChanged evData {boneId, &pos, nullptr, nullptr};
+	InvokeBoneTransformChanged(boneId, &pos, nullptr, nullptr);
+}
+void BaseAnimatedComponent::InvokeBoneTransformChanged(uint32_t boneId, const Vector3 *pos, const Quat *rot, const Vector3 *scale)
+{
+	// EVENT_ON_BONE_TRANSFORM_CHANGED is not a multi-threaded event, its listeners (e.g. bone collision objects or Lua callbacks)
+	// have to run on the main thread
+	if(umath::is_flag_set(m_stateFlags, StateFlags::DeferMainThreadEvents)) {
+		m_deferredBoneTransformEvents.push_back({boneId, scale != nullptr});
+		return;
+	}
+	CEOnBoneTransformChanged evData {boneId, pos, rot, scale};
 	InvokeEventCallbacks(EVENT_ON_BONE_TRANSFORM_CHANGED, evData);
 }
 void BaseAnimatedComponent::SetBoneRotation(UInt32 boneId, const Quat &rot)
@@ -415,45 +425,31 @@ void BaseAnimatedComponent::BlendBonePoses(const std::vector<umath::Transform> &
 {
 	auto numBones = umath::min(srcBonePoses.size(), dstBonePoses.size(), outBonePoses.size());
 	auto numScales = (optSrcBoneScales && optDstBoneScales && optOutBoneScales) ? umath::min(optSrcBoneScales->size(), optDstBoneScales->size(), optOutBoneScales->size(), numBones) : 0;
-	for(auto boneId = decltype(numBones) {0u}; boneId < numBones; ++boneId) {
-		auto &srcPose = srcBonePoses.at(boneId);
-		auto dstPose = dstBonePoses.at(boneId);
-		auto boneWeight = anim.GetBoneWeight(boneId);
-		auto boneInterpFactor = boneWeight * interpFactor;
-		auto &outPose = (outBonePoses.at(boneId) = srcPose);
-		outPose.Interpolate(dstPose, boneInterpFactor);
+	thread_local std::vector<float> interpFactors;
+	interpFactors.resize(numBones);
+	for(auto boneId = decltype(numBones) {0u}; boneId < numBones; ++boneId)
+		interpFactors[boneId] = anim.GetBoneWeight(boneId) * interpFactor;
+	pragma::animation::blend_bone_poses(srcBonePoses.data(), dstBonePoses.data(), outBonePoses.data(), interpFactors.data(), numBones);
 
-		// Scaling
-		if(boneId >= numScales)
-			continue;
-		optOutBoneScales->at(boneId) = uvec::lerp(optSrcBoneScales->at(boneId), optDstBoneScales->at(boneId) * boneWeight, interpFactor);
-	}
+	// Scaling
+	for(auto boneId = decltype(numScales) {0u}; boneId < numScales; ++boneId)
+		optOutBoneScales->at(boneId) = uvec::lerp(optSrcBoneScales->at(boneId), optDstBoneScales->at(boneId) * anim.GetBoneWeight(boneId), interpFactor);
 }
 void BaseAnimatedComponent::BlendBoneFrames(std::vector<umath::Transform> &tgt, std::vector<Vector3> *tgtScales, std::vector<umath::Transform> &add, std::vector<Vector3> *addScales, float blendScale) const
 {
 	if(blendScale == 0.f)
 		return;
-	for(unsigned int i = 0; i < umath::min(tgt.size(), add.size()); i++) {
-		auto &pose = tgt.at(i);
-		pose.Interpolate(add.at(i), blendScale);
-		if(tgtScales != nullptr && addScales != nullptr)
-			tgtScales->at(i) = uvec::lerp(tgtScales->at(i), addScales->at(i), blendScale);
+	auto numBones = umath::min(tgt.size(), add.size());
+	thread_local std::vector<float> interpFactors;
+	interpFactors.resize(numBones);
+	std::fill(interpFactors.begin(), interpFactors.end(), blendScale);
+	pragma::animation::blend_bone_poses(tgt.data(), add.data(), tgt.data(), interpFactors.data(), numBones);
+	if(tgtScales != nullptr && addScales != nullptr) {
+		auto numScales = umath::min(tgtScales->size(), addScales->size(), numBones);
+		pragma::animation::blend_bone_scales(tgtScales->data(), addScales->data(), tgtScales->data(), interpFactors.data(), numScales);
 	}
 }
 
-static void get_global_bone_transforms(std::vector<umath::ScaledTransform> &transforms, std::unordered_map<uint32_t, std::shared_ptr<panima::Bone>> &childBones, const umath::ScaledTransform &tParent = {})
-{
-	for(auto &pair : childBones) {
-		auto boneId = pair.first;
-		auto &bone = pair.second;
-		if(boneId >= transforms.size())
-			continue;
-		auto &t = transforms.at(boneId);
-		t.SetOrigin(t.GetOrigin() * tParent.GetScale());
-		t = tParent * t;
-		get_global_bone_transforms(transforms, bone->children, t);
-	}
-}
 bool BaseAnimatedComponent::UpdateSkeleton()
 {
 	if(umath::is_flag_set(m_stateFlags, StateFlags::AbsolutePosesDirty) == false)
@@ -463,7 +459,9 @@ bool BaseAnimatedComponent::UpdateSkeleton()
 		return false;
 	umath::set_flag(m_stateFlags, StateFlags::AbsolutePosesDirty, false);
 	auto &skeleton = hModel->GetSkeleton();
+	if(m_flatBoneHierarchy.IsValid(skeleton) == false)
+		m_flatBoneHierarchy.Build(skeleton);
 	m_processedBones = m_bones;
-	get_global_bone_transforms(m_processedBones, skeleton.GetRootBones());
+	m_flatBoneHierarchy.ComputeGlobalTransforms(m_processedBones);
 	return true;
 }
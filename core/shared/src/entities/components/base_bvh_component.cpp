@@ -12,134 +12,95 @@
 #include "pragma/entities/components/base_static_bvh_cache_component.hpp"
 #include "pragma/entities/entity_component_manager_t.hpp"
 #include "pragma/model/c_modelmesh.h"
+#include "pragma/model/model.h"
 #include "pragma/debug/intel_vtune.hpp"
+#include "pragma/entities/components/bvh_data.hpp"
 #include <mathutil/umath_geometry.hpp>
 #include <sharedutils/util_hash.hpp>
-#include <bvh/bvh.hpp>
-#include <bvh/triangle.hpp>
-#include <bvh/sweep_sah_builder.hpp>
-#include <bvh/single_ray_traverser.hpp>
-#include <bvh/primitive_intersectors.hpp>
 #include <bvh/hierarchy_refitter.hpp>
+#include <udm.hpp>
 
 using namespace pragma;
 
-using Primitive = bvh::Triangle<float>;
+using Primitive = BvhPrimitive;
 static_assert(sizeof(BvhTriangle) == sizeof(Primitive));
-namespace pragma {
-	struct BvhData {
-		struct IntersectorData {
-			IntersectorData(bvh::SweepSahBuilder<bvh::Bvh<float>> builder, bvh::ClosestPrimitiveIntersector<bvh::Bvh<float>, bvh::Triangle<float>> primitiveIntersector, bvh::SingleRayTraverser<bvh::Bvh<float>> traverser)
-			    : builder {std::move(builder)}, primitiveIntersector {std::move(primitiveIntersector)}, traverser {std::move(traverser)}
-			{
-			}
-			bvh::SweepSahBuilder<bvh::Bvh<float>> builder;
-			bvh::ClosestPrimitiveIntersector<bvh::Bvh<float>, bvh::Triangle<float>> primitiveIntersector;
-			bvh::SingleRayTraverser<bvh::Bvh<float>> traverser;
-		};
-		BvhData();
-		bvh::Bvh<float> bvh;
-		std::vector<Primitive> primitives;
-		std::vector<BvhMeshRange> meshRanges;
-
-		const BvhMeshRange *FindMeshRange(size_t primIdx) const
-		{
-			BvhMeshRange search {};
-			search.start = primIdx * 3;
-			auto it = std::upper_bound(meshRanges.begin(), meshRanges.end(), search);
-			if(it == meshRanges.begin())
-				return nullptr;
-			--it;
-			return &*it;
-		}
-
-		void InitializeIntersectorData();
-		std::unique_ptr<IntersectorData> intersectorData;
-	};
-};
 
 BvhMeshIntersectionInfo *pragma::BvhIntersectionInfo::GetMeshIntersectionInfo() { return m_isMeshIntersectionInfo ? static_cast<BvhMeshIntersectionInfo *>(this) : nullptr; }
 
 std::vector<BvhMeshRange> &pragma::get_bvh_mesh_ranges(BvhData &bvhData) { return bvhData.meshRanges; }
 
-void pragma::BvhIntersectionInfo::Clear() { primitives.clear(); }
+void pragma::BvhIntersectionInfo::Clear()
+{
+	primitives.clear();
+	source = nullptr;
+}
 
-static void get_bvh_bounds(const bvh::BoundingBox<float> &bb, Vector3 &outMin, Vector3 &outMax)
+void pragma::get_bvh_bounds(const bvh::BoundingBox<float> &bb, Vector3 &outMin, Vector3 &outMax)
 {
 	constexpr auto epsilon = 0.001f;
 	outMin = Vector3 {umath::min(bb.min.values[0], bb.max.values[0]) - epsilon, umath::min(bb.min.values[1], bb.max.values[1]) - epsilon, umath::min(bb.min.values[2], bb.max.values[2]) - epsilon};
 	outMax = Vector3 {umath::max(bb.min.values[0], bb.max.values[0]) + epsilon, umath::max(bb.min.values[1], bb.max.values[1]) + epsilon, umath::max(bb.min.values[2], bb.max.values[2]) + epsilon};
 }
-static bool test_bvh_intersection(const pragma::BvhData &bvhData, const std::function<bool(const Vector3 &, const Vector3 &)> &testAabb, const std::function<bool(const Primitive &)> &testTri, size_t nodeIdx = 0, BvhIntersectionInfo *outIntersectionInfo = nullptr)
+template<typename TTestAabb, typename TTestTri>
+static bool test_bvh_intersection(const pragma::BvhData &bvhData, const TTestAabb &testAabb, const TTestTri &testTri, uint32_t nodeIdx = 0, BvhIntersectionInfo *outIntersectionInfo = nullptr, size_t primitiveOffset = 0)
 {
 	auto &bvh = bvhData.bvh;
-	auto &node = bvh.nodes.get()[nodeIdx];
-	Vector3 v0, v1;
-	get_bvh_bounds(node.bounding_box_proxy().to_bounding_box(), v0, v1);
-	auto intersect = testAabb(v0, v1);
-	if(!intersect)
-		return false;
-	if(node.is_leaf()) {
-		auto hasHit = false;
-		auto *meshIntersectionInfo = outIntersectionInfo ? outIntersectionInfo->GetMeshIntersectionInfo() : nullptr;
-		for(auto i = decltype(node.primitive_count) {0u}; i < node.primitive_count; ++i) {
-			auto primIdx = bvh.primitive_indices[node.first_child_or_primitive + i];
-
-			if(meshIntersectionInfo) {
-				auto skip = false;
-				auto idx = primIdx * 3;
-				for(auto *meshRange : meshIntersectionInfo->GetTemporaryMeshRanges()) {
-					if(idx >= meshRange->start && idx < meshRange->end) {
-						skip = true;
-						break;
-					}
-				}
-				if(skip)
-					continue;
-			}
-
-			auto &prim = bvhData.primitives[primIdx];
-			auto p1 = prim.p1();
-			auto p2 = prim.p2();
-			auto res = testTri(prim);
-			if(res) {
-				if(!outIntersectionInfo)
-					return true;
-				auto addPrim = true;
-				if(meshIntersectionInfo) {
-					auto *meshRange = bvhData.FindMeshRange(primIdx);
-					assert(meshRange != nullptr);
-					meshIntersectionInfo->GetTemporaryMeshRanges().push_back(meshRange);
-
-					auto &tmpMeshes = meshIntersectionInfo->GetTemporarMeshMap();
-					auto hash = util::hash_combine<uint64_t>(util::hash_combine<uint64_t>(0, reinterpret_cast<uint64_t>(meshRange->mesh.get())), reinterpret_cast<uint64_t>(meshRange->entity));
-					auto it = tmpMeshes.find(hash);
-					if(it != tmpMeshes.end())
-						addPrim = false;
-					else
-						tmpMeshes.insert(hash);
-				}
-				if(addPrim) {
-					if(outIntersectionInfo->primitives.size() == outIntersectionInfo->primitives.capacity())
-						outIntersectionInfo->primitives.reserve(outIntersectionInfo->primitives.size() * 1.75);
-					outIntersectionInfo->primitives.push_back(primIdx);
-				}
-				hasHit = true;
-			}
-		}
-		if(meshIntersectionInfo)
-			meshIntersectionInfo->GetTemporaryMeshRanges().clear();
-		return hasHit;
-	}
-	if(!outIntersectionInfo) {
-		return test_bvh_intersection(bvhData, testAabb, testTri, node.first_child_or_primitive, outIntersectionInfo) || test_bvh_intersection(bvhData, testAabb, testTri, node.first_child_or_primitive + 1, outIntersectionInfo);
-	}
-	// We have to visit both
-	auto a = test_bvh_intersection(bvhData, testAabb, testTri, node.first_child_or_primitive, outIntersectionInfo);
-	auto b = test_bvh_intersection(bvhData, testAabb, testTri, node.first_child_or_primitive + 1, outIntersectionInfo);
-	return a || b;
+	auto hasHit = false;
+	auto *meshIntersectionInfo = outIntersectionInfo ? outIntersectionInfo->GetMeshIntersectionInfo() : nullptr;
+	traverse_bvh(
+	  bvhData.flatNodes, testAabb,
+	  [&](const BvhFlatNode &node) -> bool {
+		  for(auto i = decltype(node.primitiveCount) {0u}; i < node.primitiveCount; ++i) {
+			  auto primIdx = bvh.primitive_indices[node.firstChildOrPrimitive + i];
+
+			  if(meshIntersectionInfo) {
+				  auto skip = false;
+				  auto idx = primIdx * 3;
+				  for(auto *meshRange : meshIntersectionInfo->GetTemporaryMeshRanges()) {
+					  if(idx >= meshRange->start && idx < meshRange->end) {
+						  skip = true;
+						  break;
+					  }
+				  }
+				  if(skip)
+					  continue;
+			  }
+
+			  auto &prim = bvhData.primitives[primIdx];
+			  auto res = testTri(prim);
+			  if(res) {
+				  hasHit = true;
+				  if(!outIntersectionInfo)
+					  return false; // We only need to know whether there is an intersection at all
+				  auto addPrim = true;
+				  if(meshIntersectionInfo) {
+					  auto *meshRange = bvhData.FindMeshRange(primIdx);
+					  assert(meshRange != nullptr);
+					  meshIntersectionInfo->GetTemporaryMeshRanges().push_back(meshRange);
+
+					  auto &tmpMeshes = meshIntersectionInfo->GetTemporarMeshMap();
+					  auto hash = util::hash_combine<uint64_t>(util::hash_combine<uint64_t>(0, reinterpret_cast<uint64_t>(meshRange->mesh.get())), reinterpret_cast<uint64_t>(meshRange->entity));
+					  auto it = tmpMeshes.find(hash);
+					  if(it != tmpMeshes.end())
+						  addPrim = false;
+					  else
+						  tmpMeshes.insert(hash);
+				  }
+				  if(addPrim) {
+					  if(outIntersectionInfo->primitives.size() == outIntersectionInfo->primitives.capacity())
+						  outIntersectionInfo->primitives.reserve(outIntersectionInfo->primitives.size() * 1.75);
+					  outIntersectionInfo->primitives.push_back(primitiveOffset + primIdx);
+				  }
+			  }
+		  }
+		  if(meshIntersectionInfo)
+			  meshIntersectionInfo->GetTemporaryMeshRanges().clear();
+		  return true;
+	  },
+	  nodeIdx);
+	return hasHit;
 }
-static bool test_bvh_intersection_with_aabb(const pragma::BvhData &bvhData, const Vector3 &min, const Vector3 &max, size_t nodeIdx = 0, BvhIntersectionInfo *outIntersectionInfo = nullptr)
+bool pragma::test_bvh_intersection_with_aabb(const pragma::BvhData &bvhData, const Vector3 &min, const Vector3 &max, uint32_t nodeIdx, BvhIntersectionInfo *outIntersectionInfo, size_t primitiveOffset)
 {
 	return test_bvh_intersection(
 	  bvhData, [&min, &max](const Vector3 &aabbMin, const Vector3 &aabbMax) -> bool { return umath::intersection::aabb_aabb(min, max, aabbMin, aabbMax) != umath::intersection::Intersect::Outside; },
@@ -148,9 +109,9 @@ static bool test_bvh_intersection_with_aabb(const pragma::BvhData &bvhData, cons
 		  auto p2 = prim.p2();
 		  return umath::intersection::aabb_triangle(min, max, *reinterpret_cast<const Vector3 *>(&prim.p0.values), *reinterpret_cast<const Vector3 *>(&p1.values), *reinterpret_cast<const Vector3 *>(&p2.values));
 	  },
-	  nodeIdx, outIntersectionInfo);
+	  nodeIdx, outIntersectionInfo, primitiveOffset);
 }
-static bool test_bvh_intersection_with_kdop(const pragma::BvhData &bvhData, const std::vector<umath::Plane> &kdop, size_t nodeIdx = 0, BvhIntersectionInfo *outIntersectionInfo = nullptr)
+bool pragma::test_bvh_intersection_with_kdop(const pragma::BvhData &bvhData, const std::vector<umath::Plane> &kdop, uint32_t nodeIdx, BvhIntersectionInfo *outIntersectionInfo, size_t primitiveOffset)
 {
 	return test_bvh_intersection(
 	  bvhData, [&kdop](const Vector3 &aabbMin, const Vector3 &aabbMax) -> bool { return umath::intersection::aabb_in_plane_mesh(aabbMin, aabbMax, kdop) != umath::intersection::Intersect::Outside; },
@@ -159,7 +120,7 @@ static bool test_bvh_intersection_with_kdop(const pragma::BvhData &bvhData, cons
 		  get_bvh_bounds(prim.bounding_box(), v0, v1);
 		  return umath::intersection::aabb_in_plane_mesh(v0, v1, kdop) != umath::intersection::Intersect::Outside;
 	  },
-	  nodeIdx, outIntersectionInfo);
+	  nodeIdx, outIntersectionInfo, primitiveOffset);
 }
 
 pragma::BvhData::BvhData() {}
@@ -171,9 +132,307 @@ void pragma::BvhData::InitializeIntersectorData()
 
 	bvh::SweepSahBuilder<bvh::Bvh<float>> builder {bvh};
 	builder.build(global_bbox, bboxes.get(), centers.get(), primitives.size());
+	InitializeIntersectorData(std::move(builder));
+}
+
+void pragma::BvhData::InitializeIntersectorData(const BvhHierarchy &hierarchy)
+{
+	hierarchy.Apply(bvh);
+	Refit();
+	InitializeIntersectorData(bvh::SweepSahBuilder<bvh::Bvh<float>> {bvh});
+}
+
+void pragma::BvhData::InitializeIntersectorData(bvh::SweepSahBuilder<bvh::Bvh<float>> &&builder)
+{
 	bvh::ClosestPrimitiveIntersector<bvh::Bvh<float>, bvh::Triangle<float>> primitive_intersector(bvh, primitives.data());
 	bvh::SingleRayTraverser<bvh::Bvh<float>> traverser {bvh};
 	intersectorData = std::make_unique<IntersectorData>(std::move(builder), std::move(primitive_intersector), std::move(traverser));
+	build_flat_bvh_nodes(bvh, flatNodes);
+	referenceSahCost = ComputeSahCost();
+}
+
+void pragma::BvhData::Refit()
+{
+	bvh::HierarchyRefitter<bvh::Bvh<float>> refitter {bvh};
+	refitter.refit([this](bvh::Bvh<float>::Node &leaf) {
+		assert(leaf.is_leaf());
+		auto bbox = bvh::BoundingBox<float>::empty();
+		for(size_t i = 0; i < leaf.primitive_count; ++i) {
+			auto &triangle = primitives[bvh.primitive_indices[leaf.first_child_or_primitive + i]];
+			bbox.extend(triangle.bounding_box());
+		}
+		leaf.bounding_box_proxy() = bbox;
+	});
+}
+
+std::shared_ptr<pragma::BvhHierarchy> pragma::BvhHierarchy::Create(const bvh::Bvh<float> &bvh, uint64_t meshHash)
+{
+	auto hierarchy = std::make_shared<BvhHierarchy>();
+	hierarchy->meshHash = meshHash;
+	hierarchy->nodes.resize(bvh.node_count);
+	size_t numPrimitiveIndices = 0;
+	for(size_t i = 0; i < bvh.node_count; ++i) {
+		auto &node = bvh.nodes[i];
+		hierarchy->nodes[i] = {static_cast<uint32_t>(node.primitive_count), static_cast<uint32_t>(node.first_child_or_primitive)};
+		if(node.is_leaf())
+			numPrimitiveIndices = std::max(numPrimitiveIndices, node.first_child_or_primitive + node.primitive_count);
+	}
+	hierarchy->primitiveIndices.resize(numPrimitiveIndices);
+	for(size_t i = 0; i < numPrimitiveIndices; ++i)
+		hierarchy->primitiveIndices[i] = static_cast<uint32_t>(bvh.primitive_indices[i]);
+	return hierarchy;
+}
+
+bool pragma::BvhHierarchy::IsValid() const
+{
+	if(nodes.empty())
+		return false;
+	auto numPrimitives = primitiveIndices.size();
+	for(auto idx : primitiveIndices) {
+		if(idx >= numPrimitives)
+			return false;
+	}
+	// Depth of each node, counting the root as 1. Parents are always visited before their children (see below),
+	// so the depth of a node is final by the time it is visited.
+	std::vector<uint32_t> depths(nodes.size(), 0);
+	depths.front() = 1;
+	for(size_t i = 0; i < nodes.size(); ++i) {
+		auto &node = nodes[i];
+		if(depths[i] > PREBUILT_BVH_MAX_DEPTH)
+			return false;
+		if(node.primitiveCount > 0) {
+			if(static_cast<size_t>(node.firstChildOrPrimitive) + node.primitiveCount > numPrimitives)
+				return false;
+			continue;
+		}
+		// Children are always stored after their parent, which also rules out cycles
+		if(node.firstChildOrPrimitive <= i || static_cast<size_t>(node.firstChildOrPrimitive) + 1 >= nodes.size())
+			return false;
+		for(auto childIdx : {node.firstChildOrPrimitive, node.firstChildOrPrimitive + 1})
+			depths[childIdx] = umath::max(depths[childIdx], depths[i] + 1);
+	}
+	return true;
+}
+
+void pragma::BvhHierarchy::Apply(bvh::Bvh<float> &bvh) const
+{
+	bvh.node_count = nodes.size();
+	bvh.nodes = std::make_unique<bvh::Bvh<float>::Node[]>(nodes.size());
+	for(size_t i = 0; i < nodes.size(); ++i) {
+		auto &node = bvh.nodes[i];
+		node.primitive_count = nodes[i].primitiveCount;
+		node.first_child_or_primitive = nodes[i].firstChildOrPrimitive;
+	}
+	bvh.primitive_indices = std::make_unique<size_t[]>(primitiveIndices.size());
+	for(size_t i = 0; i < primitiveIndices.size(); ++i)
+		bvh.primitive_indices[i] = primitiveIndices[i];
+}
+
+static bool should_use_mesh_for_bvh(const ModelSubMesh &mesh) { return mesh.GetGeometryType() == ModelSubMesh::GeometryType::Triangles; }
+
+// FNV-1a
+static uint64_t hash_bvh_data(uint64_t hash, const void *data, size_t size)
+{
+	auto *bytes = static_cast<const uint8_t *>(data);
+	for(size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1'099'511'628'211ull;
+	}
+	return hash;
+}
+
+uint64_t pragma::calc_bvh_mesh_hash(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes)
+{
+	uint64_t hash = 14'695'981'039'346'656'037ull;
+	for(auto &mesh : meshes) {
+		if(!should_use_mesh_for_bvh(*mesh))
+			continue;
+		// Only the positions and indices affect the hierarchy
+		auto &verts = mesh->GetVertices();
+		auto numVerts = static_cast<uint64_t>(verts.size());
+		hash = hash_bvh_data(hash, &numVerts, sizeof(numVerts));
+		for(auto &v : verts)
+			hash = hash_bvh_data(hash, &v.position, sizeof(v.position));
+		mesh->VisitIndices([&hash](auto *indexData, uint32_t numIndices) {
+			hash = hash_bvh_data(hash, &numIndices, sizeof(numIndices));
+			for(auto i = decltype(numIndices) {0u}; i < numIndices; ++i) {
+				auto idx = static_cast<uint32_t>(indexData[i]);
+				hash = hash_bvh_data(hash, &idx, sizeof(idx));
+			}
+		});
+	}
+	return hash;
+}
+
+std::string pragma::get_prebuilt_bvh_key(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes)
+{
+	uint64_t hash = 0;
+	for(auto &mesh : meshes) {
+		if(!should_use_mesh_for_bvh(*mesh))
+			continue;
+		auto &uuid = mesh->GetUuid();
+		hash = util::hash_combine<uint64_t>(util::hash_combine<uint64_t>(hash, uuid[0]), uuid[1]);
+	}
+	return std::to_string(hash);
+}
+
+std::shared_ptr<pragma::BvhHierarchy> pragma::load_prebuilt_bvh(const Model &mdl, const std::string &key)
+{
+	auto udmBvh = mdl.GetExtensionData()["bvh"];
+	if(!udmBvh)
+		return nullptr;
+	uint32_t version = 0;
+	udmBvh["version"](version);
+	if(version != PREBUILT_BVH_VERSION)
+		return nullptr;
+	auto udmHierarchy = udmBvh["hierarchies"][key];
+	if(!udmHierarchy)
+		return nullptr;
+	auto hierarchy = std::make_shared<BvhHierarchy>();
+	udmHierarchy["meshHash"](hierarchy->meshHash);
+	udmHierarchy["nodes"].GetBlobData(hierarchy->nodes);
+	udmHierarchy["primitiveIndices"].GetBlobData(hierarchy->primitiveIndices);
+	if(!hierarchy->IsValid())
+		return nullptr;
+	return hierarchy;
+}
+
+void pragma::store_prebuilt_bvh(Model &mdl, const std::string &key, const BvhHierarchy &hierarchy)
+{
+	auto udmBvh = mdl.GetExtensionData()["bvh"];
+	uint32_t version = 0;
+	udmBvh["version"](version);
+	if(version != PREBUILT_BVH_VERSION) {
+		// Hierarchies of older versions can't be used anymore
+		auto *el = udmBvh.GetValuePtr<udm::Element>();
+		if(el)
+			el->children.erase("hierarchies");
+		udmBvh["version"] = PREBUILT_BVH_VERSION;
+	}
+	auto udmHierarchy = udmBvh["hierarchies"][key];
+	udmHierarchy["meshHash"] = hierarchy.meshHash;
+	udmHierarchy["nodes"] = udm::compress_lz4_blob(hierarchy.nodes);
+	udmHierarchy["primitiveIndices"] = udm::compress_lz4_blob(hierarchy.primitiveIndices);
+}
+
+void pragma::BvhData::GetHitInfo(const BvhPacketHit &hit, BvhHitInfo &outHitInfo) const
+{
+	auto *meshRange = FindMeshRange(hit.primitiveIndex);
+	assert(meshRange != nullptr);
+	outHitInfo.primitiveIndex = hit.primitiveIndex - meshRange->start / 3;
+	outHitInfo.distance = hit.intersection.distance();
+	outHitInfo.u = hit.intersection.u;
+	outHitInfo.v = hit.intersection.v;
+	outHitInfo.t = hit.intersection.t;
+	outHitInfo.mesh = meshRange->mesh;
+	if(meshRange->entity)
+		outHitInfo.entity = meshRange->entity->GetHandle();
+}
+
+void pragma::build_flat_bvh_nodes(const bvh::Bvh<float> &bvh, std::vector<BvhFlatNode> &outNodes)
+{
+	outNodes.resize(bvh.node_count);
+	for(size_t i = 0; i < bvh.node_count; ++i) {
+		auto &node = bvh.nodes[i];
+		auto &flatNode = outNodes[i];
+		get_bvh_bounds(node.bounding_box_proxy().to_bounding_box(), flatNode.min, flatNode.max);
+		flatNode.firstChildOrPrimitive = static_cast<uint32_t>(node.first_child_or_primitive);
+		flatNode.primitiveCount = static_cast<uint32_t>(node.primitive_count);
+	}
+}
+
+void pragma::BvhRayPacket::Initialize(const BvhRay *rays, uint32_t count)
+{
+	assert(count <= SIZE);
+	m_count = count;
+	for(uint32_t i = 0; i < SIZE; ++i) {
+		if(i >= count) {
+			// Unused slots can never intersect anything
+			m_originX[i] = m_originY[i] = m_originZ[i] = 0.f;
+			m_dirX[i] = m_dirY[i] = m_dirZ[i] = 0.f;
+			m_invDirX[i] = m_invDirY[i] = m_invDirZ[i] = 0.f;
+			m_minDist[i] = 1.f;
+			m_maxDist[i] = 0.f;
+			continue;
+		}
+		auto &ray = rays[i];
+		m_originX[i] = ray.origin.x;
+		m_originY[i] = ray.origin.y;
+		m_originZ[i] = ray.origin.z;
+		m_dirX[i] = ray.dir.x;
+		m_dirY[i] = ray.dir.y;
+		m_dirZ[i] = ray.dir.z;
+		m_invDirX[i] = 1.f / ray.dir.x;
+		m_invDirY[i] = 1.f / ray.dir.y;
+		m_invDirZ[i] = 1.f / ray.dir.z;
+		m_minDist[i] = ray.minDist;
+		m_maxDist[i] = ray.maxDist;
+	}
+}
+
+uint32_t pragma::BvhRayPacket::IntersectAabb(const Vector3 &min, const Vector3 &max, uint32_t rayMask) const
+{
+	uint32_t mask = 0;
+	// Fixed trip count without early-outs, so this can be vectorized
+	for(uint32_t i = 0; i < SIZE; ++i) {
+		float txNear, txFar, tyNear, tyFar, tzNear, tzFar;
+		get_slab_interval(min.x, max.x, m_originX[i], m_invDirX[i], txNear, txFar);
+		get_slab_interval(min.y, max.y, m_originY[i], m_invDirY[i], tyNear, tyFar);
+		get_slab_interval(min.z, max.z, m_originZ[i], m_invDirZ[i], tzNear, tzFar);
+		auto tNear = std::max(std::max(txNear, tyNear), std::max(tzNear, m_minDist[i]));
+		auto tFar = std::min(std::min(txFar, tyFar), std::min(tzFar, m_maxDist[i]));
+		mask |= static_cast<uint32_t>(tNear <= tFar) << i;
+	}
+	return mask & rayMask;
+}
+
+bvh::Ray<float> pragma::BvhRayPacket::GetRay(uint32_t idx) const
+{
+	return bvh::Ray<float> {bvh::Vector3<float>(m_originX[idx], m_originY[idx], m_originZ[idx]), bvh::Vector3<float>(m_dirX[idx], m_dirY[idx], m_dirZ[idx]), m_minDist[idx], m_maxDist[idx]};
+}
+
+void pragma::intersect_bvh_packet(const BvhData &bvhData, BvhRayPacket &packet, uint32_t rayMask, BvhPacketHits &outHits, size_t sourceIndex)
+{
+	auto &bvh = bvhData.bvh;
+	traverse_bvh_packet(bvhData.flatNodes, packet, rayMask, [&bvhData, &bvh, &packet, &outHits, sourceIndex](const BvhFlatNode &leaf, uint32_t leafRayMask) {
+		for(uint32_t rayIdx = 0; rayIdx < BvhRayPacket::SIZE; ++rayIdx) {
+			if((leafRayMask & (1u << rayIdx)) == 0)
+				continue;
+			auto ray = packet.GetRay(rayIdx);
+			for(auto i = decltype(leaf.primitiveCount) {0u}; i < leaf.primitiveCount; ++i) {
+				auto primIdx = bvh.primitive_indices[leaf.firstChildOrPrimitive + i];
+				auto hit = bvhData.primitives[primIdx].intersect(ray);
+				if(!hit)
+					continue;
+				ray.tmax = hit->distance();
+				outHits[rayIdx] = BvhPacketHit {primIdx, *hit, sourceIndex};
+			}
+			packet.SetMaxDistance(rayIdx, ray.tmax);
+		}
+	});
+}
+
+static float get_half_area(const bvh::BoundingBox<float> &bb)
+{
+	auto dx = bb.max.values[0] - bb.min.values[0];
+	auto dy = bb.max.values[1] - bb.min.values[1];
+	auto dz = bb.max.values[2] - bb.min.values[2];
+	return dx * dy + dy * dz + dz * dx;
+}
+float pragma::BvhData::ComputeSahCost() const
+{
+	if(bvh.node_count == 0)
+		return 0.f;
+	auto rootArea = get_half_area(bvh.nodes[0].bounding_box_proxy().to_bounding_box());
+	if(rootArea <= 0.f)
+		return 0.f;
+	auto cost = 0.f;
+	for(size_t i = 0; i < bvh.node_count; ++i) {
+		auto &node = bvh.nodes[i];
+		auto area = get_half_area(node.bounding_box_proxy().to_bounding_box());
+		cost += node.is_leaf() ? (area * node.primitive_count) : area;
+	}
+	return cost / rootArea;
 }
 
 ComponentEventId BaseBvhComponent::EVENT_ON_CLEAR_BVH = INVALID_COMPONENT_ID;
@@ -204,7 +463,7 @@ void BaseBvhComponent::RebuildBvh()
 {
 	ClearBvh();
 	if(m_staticCache.valid()) {
-		m_staticCache->SetCacheDirty();
+		m_staticCache->SetEntityDirty(GetEntity());
 		return;
 	}
 	DoRebuildBvh();
@@ -240,6 +499,7 @@ std::shared_ptr<BvhData> BaseBvhComponent::SetBvhData(std::shared_ptr<BvhData> &
 	return tmp;
 }
 
+std::optional<Vector3> BaseBvhComponent::GetVertex(const BvhIntersectionInfo &intersectionInfo, size_t idx) const { return GetVertex(idx); }
 std::optional<Vector3> BaseBvhComponent::GetVertex(size_t idx) const
 {
 	std::scoped_lock lock {m_bvhDataMutex};
@@ -272,19 +532,25 @@ bool BaseBvhComponent::SetVertexData(pragma::BvhData &bvhData, const std::vector
 	memcpy(bvhData.primitives.data(), data.data(), util::size_of_container(data));
 
 	// Update bounding boxes
-	bvh::HierarchyRefitter<bvh::Bvh<float>> refitter {bvhData.bvh};
-	refitter.refit([&](bvh::Bvh<float>::Node &leaf) {
-		assert(leaf.is_leaf());
-		auto bbox = bvh::BoundingBox<float>::empty();
-		for(size_t i = 0; i < leaf.primitive_count; ++i) {
-			auto &triangle = bvhData.primitives[bvhData.bvh.primitive_indices[leaf.first_child_or_primitive + i]];
-			bbox.extend(triangle.bounding_box());
-		}
-		leaf.bounding_box_proxy() = bbox;
-	});
+	bvhData.Refit();
+	build_flat_bvh_nodes(bvhData.bvh, bvhData.flatNodes);
 	return true;
 }
 
+BvhUpdateResult BaseBvhComponent::RefitVertexData(pragma::BvhData &bvhData, const std::vector<BvhTriangle> &data, float maxSahCostRatio)
+{
+	if(!SetVertexData(bvhData, data))
+		return BvhUpdateResult::Failed;
+	if(maxSahCostRatio <= 0.f || bvhData.referenceSahCost <= 0.f)
+		return BvhUpdateResult::Refitted;
+	// Refitting keeps the topology of the last build, which can get arbitrarily bad if the primitives
+	// have moved far from where they were at that time (e.g. limbs of an animated character).
+	if(bvhData.ComputeSahCost() <= bvhData.referenceSahCost * maxSahCostRatio)
+		return BvhUpdateResult::Refitted;
+	bvhData.InitializeIntersectorData();
+	return BvhUpdateResult::Rebuilt;
+}
+
 bool BaseBvhComponent::SetVertexData(const std::vector<BvhTriangle> &data)
 {
 #ifdef PRAGMA_ENABLE_VTUNE_PROFILING
@@ -297,11 +563,10 @@ bool BaseBvhComponent::SetVertexData(const std::vector<BvhTriangle> &data)
 	return SetVertexData(*m_bvhData, data);
 }
 
-std::shared_ptr<pragma::BvhData> BaseBvhComponent::RebuildBvh(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes, const std::vector<umath::ScaledTransform> *optPoses, const std::function<bool()> &fIsCancelled, std::vector<size_t> *optOutMeshIndices)
+std::shared_ptr<pragma::BvhData> BaseBvhComponent::RebuildBvh(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes, const std::vector<umath::ScaledTransform> *optPoses, const std::function<bool()> &fIsCancelled, std::vector<size_t> *optOutMeshIndices, const BvhHierarchy *optHierarchy)
 {
 	auto bvhData = std::make_unique<pragma::BvhData>();
 
-	auto shouldUseMesh = [](const ModelSubMesh &mesh) { return mesh.GetGeometryType() == ModelSubMesh::GeometryType::Triangles; };
 	size_t numVerts = 0;
 	bvhData->meshRanges.reserve(meshes.size());
 	if(optOutMeshIndices)
@@ -312,7 +577,7 @@ std::shared_ptr<pragma::BvhData> BaseBvhComponent::RebuildBvh(const std::vector<
 			++meshIdx;
 			return nullptr;
 		}
-		if(shouldUseMesh(*mesh) == false) {
+		if(should_use_mesh_for_bvh(*mesh) == false) {
 			++meshIdx;
 			continue;
 		}
@@ -336,7 +601,7 @@ std::shared_ptr<pragma::BvhData> BaseBvhComponent::RebuildBvh(const std::vector<
 	for(uint32_t meshIdx = 0; auto &mesh : meshes) {
 		if(fIsCancelled && fIsCancelled())
 			return nullptr;
-		if(shouldUseMesh(*mesh) == false) {
+		if(should_use_mesh_for_bvh(*mesh) == false) {
 			++meshIdx;
 			continue;
 		}
@@ -362,10 +627,26 @@ std::shared_ptr<pragma::BvhData> BaseBvhComponent::RebuildBvh(const std::vector<
 		++meshIdx;
 	}
 
-	bvhData->InitializeIntersectorData();
+	if(optHierarchy && optHierarchy->primitiveIndices.size() == primitives.size())
+		bvhData->InitializeIntersectorData(*optHierarchy);
+	else
+		bvhData->InitializeIntersectorData();
 	return std::move(bvhData);
 }
 
+std::shared_ptr<pragma::BvhData> BaseBvhComponent::RebuildBvh(Model &mdl, const std::vector<std::shared_ptr<ModelSubMesh>> &meshes, bool storeIfMissing)
+{
+	auto key = get_prebuilt_bvh_key(meshes);
+	auto meshHash = calc_bvh_mesh_hash(meshes);
+	auto hierarchy = load_prebuilt_bvh(mdl, key);
+	if(hierarchy && hierarchy->meshHash != meshHash)
+		hierarchy = nullptr; // The meshes have changed since the hierarchy was built
+	auto bvhData = RebuildBvh(meshes, nullptr, nullptr, nullptr, hierarchy.get());
+	if(storeIfMissing && bvhData && !hierarchy && !bvhData->primitives.empty())
+		store_prebuilt_bvh(mdl, key, *BvhHierarchy::Create(bvhData->bvh, meshHash));
+	return bvhData;
+}
+
 std::vector<BvhMeshRange> &BaseBvhComponent::GetMeshRanges() { return m_bvhData->meshRanges; }
 
 const std::shared_ptr<BvhData> &BaseBvhComponent::GetUpdatedBvh() const
@@ -478,7 +759,43 @@ bool BaseBvhComponent::IntersectionTest(const Vector3 &origin, const Vector3 &di
 	return false;
 }
 
+uint32_t BaseBvhComponent::IntersectionTestBatch(const std::vector<BvhRay> &rays, std::vector<std::optional<BvhHitInfo>> &outHits) const
+{
+	outHits.clear();
+	outHits.resize(rays.size());
+	auto bvhData = GetUpdatedBvh();
+	if(!bvhData || bvhData->primitives.empty())
+		return 0;
+
+#ifdef PRAGMA_ENABLE_VTUNE_PROFILING
+	::debug::get_domain().BeginTask("bvh_mutex_wait");
+#endif
+	std::scoped_lock lock {m_bvhDataMutex};
+#ifdef PRAGMA_ENABLE_VTUNE_PROFILING
+	::debug::get_domain().EndTask();
+#endif
+	uint32_t numHits = 0;
+	BvhRayPacket packet;
+	BvhPacketHits hits;
+	for(size_t offset = 0; offset < rays.size(); offset += BvhRayPacket::SIZE) {
+		packet.Initialize(rays.data() + offset, static_cast<uint32_t>(umath::min(rays.size() - offset, static_cast<size_t>(BvhRayPacket::SIZE))));
+		hits = {};
+		intersect_bvh_packet(*bvhData, packet, packet.GetActiveMask(), hits);
+		for(uint32_t i = 0; i < packet.GetCount(); ++i) {
+			if(!hits[i])
+				continue;
+			auto &hitInfo = outHits[offset + i];
+			hitInfo = BvhHitInfo {};
+			hitInfo->entity = GetEntity().GetHandle();
+			bvhData->GetHitInfo(*hits[i], *hitInfo);
+			++numHits;
+		}
+	}
+	return numHits;
+}
+
 const BvhMeshRange *BaseBvhComponent::FindPrimitiveMeshInfo(size_t primIdx) const { return m_bvhData->FindMeshRange(primIdx); }
+const BvhMeshRange *BaseBvhComponent::FindPrimitiveMeshInfo(const BvhIntersectionInfo &intersectionInfo, size_t primIdx) const { return FindPrimitiveMeshInfo(primIdx); }
 
 std::optional<pragma::BvhHitInfo> BaseBvhComponent::IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist) const
 {
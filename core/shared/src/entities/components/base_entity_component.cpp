@@ -348,8 +348,9 @@ void BaseEntityComponent::OnRemove()
 {
 	OnDetached(GetEntity());
 	if(m_eventCallbacks) {
-		for(auto &pair : *m_eventCallbacks) {
-			for(auto &hCb : pair.second) {
+		for(auto &entry : *m_eventCallbacks) {
+			for(auto i = decltype(entry.listeners.size()) {0u}; i < entry.listeners.size(); ++i) {
+				auto &hCb = entry.listeners[i];
 				if(hCb.IsValid() == false)
 					continue;
 				hCb.Remove();
@@ -358,8 +359,9 @@ void BaseEntityComponent::OnRemove()
 		m_eventCallbacks = nullptr;
 	}
 	if(m_boundEvents) {
-		for(auto &pair : *m_boundEvents) {
-			for(auto &hCb : pair.second) {
+		for(auto &entry : *m_boundEvents) {
+			for(auto i = decltype(entry.listeners.size()) {0u}; i < entry.listeners.size(); ++i) {
+				auto &hCb = entry.listeners[i];
 				if(hCb.IsValid() == false)
 					continue;
 				hCb.Remove();
@@ -368,8 +370,7 @@ void BaseEntityComponent::OnRemove()
 		m_boundEvents = nullptr;
 	}
 	if(umath::is_flag_set(m_stateFlags, StateFlags::IsLogicEnabled)) {
-		auto &logicComponents = GetEntity().GetNetworkState()->GetGameState()->GetEntityTickComponents();
-		*std::find(logicComponents.begin(), logicComponents.end(), this) = nullptr;
+		GetEntity().GetNetworkState()->GetGameState()->GetEntityTickScheduler().Remove(*this);
 		umath::set_flag(m_stateFlags, StateFlags::IsLogicEnabled, false);
 	}
 }
@@ -403,16 +404,16 @@ std::vector<BaseEntityComponent::CallbackInfo> &BaseEntityComponent::GetCallback
 		m_callbackInfos = std::make_unique<std::vector<CallbackInfo>>();
 	return *m_callbackInfos;
 }
-std::unordered_map<ComponentEventId, std::vector<CallbackHandle>> &BaseEntityComponent::GetEventCallbacks() const
+ComponentEventDispatchTable &BaseEntityComponent::GetEventCallbacks() const
 {
 	if(!m_eventCallbacks)
-		m_eventCallbacks = std::make_unique<std::unordered_map<ComponentEventId, std::vector<CallbackHandle>>>();
+		m_eventCallbacks = std::make_unique<ComponentEventDispatchTable>();
 	return *m_eventCallbacks;
 }
-std::unordered_map<ComponentEventId, std::vector<CallbackHandle>> &BaseEntityComponent::GetBoundEvents() const
+ComponentEventDispatchTable &BaseEntityComponent::GetBoundEvents() const
 {
 	if(!m_boundEvents)
-		m_boundEvents = std::make_unique<std::unordered_map<ComponentEventId, std::vector<CallbackHandle>>>();
+		m_boundEvents = std::make_unique<ComponentEventDispatchTable>();
 	return *m_boundEvents;
 }
 CallbackHandle BaseEntityComponent::AddEventCallback(ComponentEventId eventId, const std::function<util::EventReply(std::reference_wrapper<ComponentEvent>)> &fCallback)
@@ -430,27 +431,21 @@ CallbackHandle BaseEntityComponent::AddEventCallback(ComponentEventId eventId, c
 	if(it != events.end() && it->second.typeIndex.has_value() && componentTypeIndex != *it->second.typeIndex && baseTypeIndex != *it->second.typeIndex)
 		throw std::logic_error("Attempted to add callback for component event " + std::to_string(eventId) + " (" + it->second.name + ") to component " + std::string(typeid(*this).name()) + ", which this event does not belong to!");
 
-	auto &eventCallbacks = GetEventCallbacks();
-	auto itEv = eventCallbacks.find(eventId);
-	if(itEv == eventCallbacks.end())
-		itEv = eventCallbacks.insert(std::make_pair(eventId, std::vector<CallbackHandle> {})).first;
-	itEv->second.push_back(hCallback);
-	return itEv->second.back();
+	return GetEventCallbacks().GetListeners(eventId).push_back(hCallback);
 }
 void BaseEntityComponent::RemoveEventCallback(ComponentEventId eventId, const CallbackHandle &hCallback)
 {
 	if(!m_eventCallbacks)
 		return;
-	auto &eventCallbacks = GetEventCallbacks();
-	auto itEv = eventCallbacks.find(eventId);
-	if(itEv == eventCallbacks.end())
+	auto *listeners = m_eventCallbacks->FindListeners(eventId);
+	if(!listeners)
 		return;
-	auto itCb = std::find(itEv->second.begin(), itEv->second.end(), hCallback);
-	if(itCb == itEv->second.end())
+	auto idx = listeners->find(hCallback);
+	if(!idx.has_value())
 		return;
-	itEv->second.erase(itCb);
-	if(itEv->second.empty())
-		eventCallbacks.erase(itEv);
+	listeners->erase(*idx);
+	if(listeners->empty())
+		m_eventCallbacks->Erase(eventId);
 }
 util::EventReply BaseEntityComponent::InvokeEventCallbacks(ComponentEventId eventId, const ComponentEvent &evData) const
 {
@@ -458,18 +453,18 @@ util::EventReply BaseEntityComponent::InvokeEventCallbacks(ComponentEventId even
 }
 util::EventReply BaseEntityComponent::InvokeEventCallbacks(ComponentEventId eventId, ComponentEvent &evData) const
 {
-	if(!m_eventCallbacks)
-		return util::EventReply::Unhandled;
-	auto &eventCallbacks = GetEventCallbacks();
-	auto itEv = eventCallbacks.find(eventId);
-	if(itEv == eventCallbacks.end())
+	if(!m_eventCallbacks || !m_eventCallbacks->FindListeners(eventId))
 		return util::EventReply::Unhandled;
 	auto hThis = GetHandle();
-	auto &evs = itEv->second;
-	for(auto i = decltype(evs.size()) {0u}; i < evs.size();) {
-		auto &hCb = evs[i];
+	for(size_t i = 0;;) {
+		// The listeners have to be looked up again every iteration, since a callback may add listeners for other events,
+		// which can relocate the list
+		auto *evs = m_eventCallbacks ? m_eventCallbacks->FindListeners(eventId) : nullptr;
+		if(!evs || i >= evs->size())
+			break;
+		auto hCb = (*evs)[i];
 		if(hCb.IsValid() == false) {
-			itEv->second.erase(itEv->second.begin() + i);
+			evs->erase(i);
 			continue;
 		}
 		if(hCb.Call<util::EventReply, std::reference_wrapper<ComponentEvent>>(std::reference_wrapper<ComponentEvent>(evData)) == util::EventReply::Handled)
@@ -538,12 +533,7 @@ CallbackHandle BaseEntityComponent::BindEvent(ComponentEventId eventId, const st
 			}
 		}
 	}
-	auto &boundEvents = GetBoundEvents();
-	auto itEv = boundEvents.find(eventId);
-	if(itEv == boundEvents.end())
-		itEv = boundEvents.insert(std::make_pair(eventId, std::vector<CallbackHandle> {})).first;
-	itEv->second.push_back(hCallback);
-	return itEv->second.back();
+	return GetBoundEvents().GetListeners(eventId).push_back(hCallback);
 }
 util::EventReply BaseEntityComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
@@ -552,21 +542,21 @@ util::EventReply BaseEntityComponent::HandleEvent(ComponentEventId eventId, Comp
 	else if(eventId == BaseEntity::EVENT_ON_POST_SPAWN)
 		OnEntityPostSpawn();
 
-	if(!m_boundEvents)
+	if(!m_boundEvents || !m_boundEvents->FindListeners(eventId))
 		return util::EventReply::Unhandled;
-	auto &boundEvents = GetBoundEvents();
-	auto itEv = boundEvents.find(eventId);
-	if(itEv == boundEvents.end())
-		return util::EventReply::Unhandled;
-	for(auto it = itEv->second.begin(); it != itEv->second.end();) {
-		auto &hCb = *it;
+	for(size_t i = 0;;) {
+		// See InvokeEventCallbacks
+		auto *evs = m_boundEvents ? m_boundEvents->FindListeners(eventId) : nullptr;
+		if(!evs || i >= evs->size())
+			break;
+		auto hCb = (*evs)[i];
 		if(hCb.IsValid() == false) {
-			it = itEv->second.erase(it);
+			evs->erase(i);
 			continue;
 		}
 		if(hCb.Call<util::EventReply, std::reference_wrapper<ComponentEvent>>(std::reference_wrapper<ComponentEvent>(evData)) == util::EventReply::Handled)
 			return util::EventReply::Handled;
-		++it;
+		++i;
 	}
 	return util::EventReply::Unhandled;
 }
@@ -577,8 +567,8 @@ void BaseEntityComponent::OnEntityComponentAdded(BaseEntityComponent &component,
 	if(bSkipEventBinding == false) {
 		if(m_boundEvents) {
 			auto &events = GetEntity().GetNetworkState()->GetGameState()->GetEntityComponentManager().GetEvents();
-			for(auto &pair : *m_boundEvents) {
-				auto evId = pair.first;
+			for(auto &entry : *m_boundEvents) {
+				auto evId = entry.eventId;
 				auto &info = events.at(evId);
 				if(!info.typeIndex.has_value())
 					continue;
@@ -587,8 +577,8 @@ void BaseEntityComponent::OnEntityComponentAdded(BaseEntityComponent &component,
 				component.GetBaseTypeIndex(baseTypeIndex);
 				if(componentTypeIndex != *info.typeIndex && baseTypeIndex != *info.typeIndex)
 					continue;
-				for(auto &hCb : pair.second)
-					component.AddEventCallback(evId, hCb);
+				for(auto i = decltype(entry.listeners.size()) {0u}; i < entry.listeners.size(); ++i)
+					component.AddEventCallback(evId, entry.listeners[i]);
 			}
 		}
 	}
@@ -598,8 +588,8 @@ void BaseEntityComponent::OnEntityComponentRemoved(BaseEntityComponent &componen
 {
 	if(m_boundEvents) {
 		auto &events = GetEntity().GetNetworkState()->GetGameState()->GetEntityComponentManager().GetEvents();
-		for(auto &pair : *m_boundEvents) {
-			auto evId = pair.first;
+		for(auto &entry : *m_boundEvents) {
+			auto evId = entry.eventId;
 			auto &info = events.at(evId);
 			if(!info.typeIndex.has_value())
 				continue;
@@ -608,8 +598,8 @@ void BaseEntityComponent::OnEntityComponentRemoved(BaseEntityComponent &componen
 			component.GetBaseTypeIndex(baseTypeIndex);
 			if(componentTypeIndex != *info.typeIndex && baseTypeIndex != *info.typeIndex)
 				continue;
-			for(auto &hCb : pair.second)
-				component.RemoveEventCallback(evId, hCb);
+			for(auto i = decltype(entry.listeners.size()) {0u}; i < entry.listeners.size(); ++i)
+				component.RemoveEventCallback(evId, entry.listeners[i]);
 		}
 	}
 	if(m_callbackInfos) {
@@ -696,17 +686,17 @@ void BaseEntityComponent::UpdateTickPolicy()
 {
 	if(!GetEntity().IsSpawned())
 		return;
-	auto &logicComponents = GetEntity().GetNetworkState()->GetGameState()->GetEntityTickComponents();
+	auto &tickScheduler = GetEntity().GetNetworkState()->GetGameState()->GetEntityTickScheduler();
 	if(ShouldThink()) {
 		if(umath::is_flag_set(m_stateFlags, StateFlags::IsLogicEnabled))
 			return;
-		logicComponents.push_back(this);
+		tickScheduler.Add(*this);
 		umath::set_flag(m_stateFlags, StateFlags::IsLogicEnabled);
 		return;
 	}
 	if(!umath::is_flag_set(m_stateFlags, StateFlags::IsLogicEnabled))
 		return;
-	logicComponents.erase(std::find(logicComponents.begin(), logicComponents.end(), this));
+	tickScheduler.Remove(*this);
 	umath::set_flag(m_stateFlags, StateFlags::IsLogicEnabled, false);
 }
 void BaseEntityComponent::SetTickPolicy(TickPolicy policy)
@@ -721,7 +711,12 @@ void BaseEntityComponent::SetTickPolicy(TickPolicy policy)
 }
 
 double BaseEntityComponent::GetNextTick() const { return m_tickData.nextTick; }
-void BaseEntityComponent::SetNextTick(double t) { m_tickData.nextTick = t; }
+void BaseEntityComponent::SetNextTick(double t)
+{
+	m_tickData.nextTick = t;
+	if(umath::is_flag_set(m_stateFlags, StateFlags::IsLogicEnabled))
+		GetEntity().GetNetworkState()->GetGameState()->GetEntityTickScheduler().Reschedule(*this);
+}
 
 double BaseEntityComponent::LastTick() const { return m_tickData.lastTick; }
 
@@ -750,7 +745,7 @@ bool BaseEntityComponent::Tick(double tDelta)
 
 	if(ShouldThink() == false) {
 		m_stateFlags &= ~pragma::BaseEntityComponent::StateFlags::IsLogicEnabled;
-		return false; // Game will handle removal from tick componentlist
+		return false; // Game will handle removal from the tick scheduler
 	}
 	return true;
 }
@@ -737,10 +737,29 @@ void BasePhysicsComponent::UpdateRagdollPose()
 	PostPhysicsSimulate(reference, rootBones, moveOffset, invRot, physRootBoneId);
 }
 
+void BasePhysicsComponent::StorePreviousPhysicsPose(uint64_t physicsStepIndex)
+{
+	auto *phys = GetPhysicsObject();
+	m_prevPhysicsPose = {GetOrigin(), phys ? phys->GetOrientation() : uquat::identity()};
+	m_prevPhysicsPoseStepIndex = physicsStepIndex;
+}
+
+std::optional<umath::Transform> BasePhysicsComponent::GetInterpolatedPhysicsPose(float factor) const
+{
+	auto *game = GetEntity().GetNetworkState()->GetGameState();
+	auto *phys = GetPhysicsObject();
+	if(phys == nullptr || m_prevPhysicsPoseStepIndex != game->GetPhysicsStepIndex())
+		return {};
+	auto pos = uvec::lerp(m_prevPhysicsPose.GetOrigin(), GetOrigin(), factor);
+	auto rot = uquat::slerp(m_prevPhysicsPose.GetRotation(), phys->GetOrientation(), factor);
+	return umath::Transform {pos, rot};
+}
+
 bool BasePhysicsComponent::PostPhysicsSimulate()
 {
 	PhysObj *phys = GetPhysicsObject();
 	CEPostPhysicsSimulate evData {};
+	evData.interpolationFactor = GetEntity().GetNetworkState()->GetGameState()->GetPhysicsInterpolationFactor();
 	InvokeEventCallbacks(EVENT_ON_POST_PHYSICS_SIMULATE, evData);
 	if(phys == NULL || phys->IsStatic())
 		return evData.keepAwake;
@@ -932,7 +951,7 @@ void CEInitializePhysics::PushArguments(lua_State *l)
 ///////////////
 
 CEPostPhysicsSimulate::CEPostPhysicsSimulate() {}
-void CEPostPhysicsSimulate::PushArguments(lua_State *l) {}
+void CEPostPhysicsSimulate::PushArguments(lua_State *l) { Lua::PushNumber(l, interpolationFactor); }
 uint32_t CEPostPhysicsSimulate::GetReturnCount() { return 1; }
 void CEPostPhysicsSimulate::HandleReturnValues(lua_State *l)
 {
@@ -8,7 +8,9 @@
 #include "stdafx_shared.h"
 #include "pragma/entities/components/base_static_bvh_cache_component.hpp"
 #include "pragma/entities/components/base_static_bvh_user_component.hpp"
+#include "pragma/entities/components/bvh_data.hpp"
 #include "pragma/entities/entity_component_manager_t.hpp"
+#include <mathutil/umath_geometry.hpp>
 
 using namespace pragma;
 
@@ -45,10 +47,41 @@ class FunctionalParallelWorker : public util::ParallelWorker<void> {
 	friend util::ParallelJob<typename TJob::RESULT_TYPE> util::create_parallel_job(TARGS &&...args);
 };
 
+namespace pragma {
+	struct StaticBvhEntityData {
+		EntityHandle hEntity;
+		BaseEntity *entity = nullptr;
+		// World-space BVH of all meshes of the entity
+		std::shared_ptr<BvhData> bvhData;
+	};
+	struct StaticBvhSnapshot {
+		std::vector<std::shared_ptr<const StaticBvhEntityData>> entities;
+		// Index of the first primitive of each entity in the combined primitive index space of the cache
+		std::vector<size_t> primitiveOffsets;
+		size_t primitiveCount = 0;
+		// BVH over the bounds of the entity sub-BVHs
+		bvh::Bvh<float> topLevel;
+		std::vector<BvhFlatNode> topLevelNodes;
+
+		const StaticBvhEntityData *FindEntityData(size_t primIdx, size_t &outLocalPrimIdx) const
+		{
+			if(primIdx >= primitiveCount)
+				return nullptr;
+			auto it = std::upper_bound(primitiveOffsets.begin(), primitiveOffsets.end(), primIdx);
+			if(it == primitiveOffsets.begin())
+				return nullptr;
+			--it;
+			outLocalPrimIdx = primIdx - *it;
+			return entities[it - primitiveOffsets.begin()].get();
+		}
+	};
+};
+
 BaseStaticBvhCacheComponent::BaseStaticBvhCacheComponent(BaseEntity &ent) : BaseBvhComponent(ent) {}
 BaseStaticBvhCacheComponent::~BaseStaticBvhCacheComponent()
 {
 	if(m_buildWorker) {
+		m_buildWorker->CancelTask();
 		m_buildWorker->Cancel();
 		m_buildWorker->Wait();
 		m_buildWorker = nullptr;
@@ -103,7 +136,9 @@ FunctionalParallelWorker::FunctionalParallelWorker() : util::ParallelWorker<void
 			m_taskCancelled = false;
 			m_taskMutex.unlock();
 
-			task(*this);
+			// The task may have been cancelled before it was picked up
+			if(task)
+				task(*this);
 			if(!IsTaskCancelled()) {
 				m_taskCompleteMutex.lock();
 				m_taskComplete = true;
@@ -130,72 +165,422 @@ void FunctionalParallelWorker::DoCancel(const std::string &resultMsg, std::optio
 	m_taskAvailableMutex.unlock();
 }
 
+struct StaticBvhBuildInput {
+	EntityHandle hEntity;
+	BaseEntity *entity = nullptr;
+	// Sub-BVH of the previous build, if the entity hasn't changed since
+	std::shared_ptr<const StaticBvhEntityData> data;
+	std::vector<std::shared_ptr<ModelSubMesh>> meshes;
+	umath::ScaledTransform pose;
+	// Prebuilt hierarchy of the model (if any). The key is empty if the entity has no model.
+	// Hierarchies built at runtime are not stored in the model, see bvh_generate_model_data.
+	std::string prebuiltBvhKey;
+	std::shared_ptr<BvhHierarchy> prebuiltHierarchy;
+};
+
+// Hierarchies built during the current build, by prebuilt key, so entities with the same model only have to be built once
+using StaticBvhBuiltHierarchies = std::unordered_map<std::string, std::shared_ptr<BvhHierarchy>>;
+static std::shared_ptr<const StaticBvhEntityData> build_entity_bvh_data(StaticBvhBuildInput &input, const std::function<bool()> &fIsCancelled, StaticBvhBuiltHierarchies &builtHierarchies)
+{
+	auto data = std::make_shared<StaticBvhEntityData>();
+	data->hEntity = input.hEntity;
+	data->entity = input.entity;
+	if(input.meshes.empty())
+		return data;
+	// The topology of a hierarchy doesn't depend on the entity pose, only the bounds do
+	const BvhHierarchy *hierarchy = nullptr;
+	uint64_t meshHash = 0;
+	if(!input.prebuiltBvhKey.empty()) {
+		meshHash = calc_bvh_mesh_hash(input.meshes);
+		if(input.prebuiltHierarchy && input.prebuiltHierarchy->meshHash == meshHash)
+			hierarchy = input.prebuiltHierarchy.get();
+		else {
+			auto it = builtHierarchies.find(input.prebuiltBvhKey);
+			if(it != builtHierarchies.end() && it->second->meshHash == meshHash)
+				hierarchy = it->second.get();
+		}
+	}
+	std::vector<umath::ScaledTransform> meshPoses;
+	meshPoses.resize(input.meshes.size(), input.pose);
+	auto bvhData = BaseBvhComponent::RebuildBvh(input.meshes, &meshPoses, fIsCancelled, nullptr, hierarchy);
+	if(!bvhData || bvhData->primitives.empty())
+		return data;
+	if(!hierarchy && !input.prebuiltBvhKey.empty())
+		builtHierarchies[input.prebuiltBvhKey] = BvhHierarchy::Create(bvhData->bvh, meshHash);
+	for(auto &range : bvhData->meshRanges)
+		range.entity = input.entity;
+	data->bvhData = std::move(bvhData);
+	return data;
+}
+
+static std::shared_ptr<StaticBvhSnapshot> build_static_bvh_snapshot(std::vector<StaticBvhBuildInput> &inputs, const std::function<bool()> &fIsCancelled)
+{
+	auto snapshot = std::make_shared<StaticBvhSnapshot>();
+	snapshot->entities.reserve(inputs.size());
+	snapshot->primitiveOffsets.reserve(inputs.size());
+	StaticBvhBuiltHierarchies builtHierarchies;
+	for(auto &input : inputs) {
+		if(fIsCancelled())
+			return nullptr;
+		auto data = input.data ? std::move(input.data) : build_entity_bvh_data(input, fIsCancelled, builtHierarchies);
+		if(!data->bvhData)
+			continue;
+		snapshot->primitiveOffsets.push_back(snapshot->primitiveCount);
+		snapshot->primitiveCount += data->bvhData->primitives.size();
+		snapshot->entities.push_back(std::move(data));
+	}
+	if(snapshot->entities.empty() || fIsCancelled())
+		return snapshot;
+
+	// The top-level BVH only covers the entity bounds, so this is cheap compared to the sub-BVHs
+	auto numEntities = snapshot->entities.size();
+	auto bboxes = std::make_unique<bvh::BoundingBox<float>[]>(numEntities);
+	auto centers = std::make_unique<bvh::Vector3<float>[]>(numEntities);
+	for(size_t i = 0; i < numEntities; ++i) {
+		bboxes[i] = snapshot->entities[i]->bvhData->bvh.nodes[0].bounding_box_proxy().to_bounding_box();
+		centers[i] = bboxes[i].center();
+	}
+	auto globalBbox = bvh::compute_bounding_boxes_union(bboxes.get(), numEntities);
+	bvh::SweepSahBuilder<bvh::Bvh<float>> builder {snapshot->topLevel};
+	builder.build(globalBbox, bboxes.get(), centers.get(), numEntities);
+	build_flat_bvh_nodes(snapshot->topLevel, snapshot->topLevelNodes);
+	return snapshot;
+}
+
+// Calls visitEntity for all entities in the leaves of the top-level BVH whose bounds pass testAabb.
+// Traversal stops early if visitEntity returns false.
+template<typename TTestAabb, typename TVisitEntity>
+static void visit_static_bvh_entities(const StaticBvhSnapshot &snapshot, const TTestAabb &testAabb, const TVisitEntity &visitEntity)
+{
+	auto &topLevel = snapshot.topLevel;
+	traverse_bvh(snapshot.topLevelNodes, testAabb, [&snapshot, &topLevel, &visitEntity](const BvhFlatNode &node) -> bool {
+		for(auto i = decltype(node.primitiveCount) {0u}; i < node.primitiveCount; ++i) {
+			auto entIdx = topLevel.primitive_indices[node.firstChildOrPrimitive + i];
+			auto &entData = *snapshot.entities[entIdx];
+			// The entity may have been removed since the snapshot was built
+			if(!entData.hEntity.valid())
+				continue;
+			if(!visitEntity(entIdx, entData))
+				return false;
+		}
+		return true;
+	});
+}
+
+static bool intersect_ray_aabb(const Vector3 &origin, const Vector3 &invDir, float tMin, float tMax, const Vector3 &min, const Vector3 &max)
+{
+	for(uint8_t i = 0; i < 3; ++i) {
+		float t0, t1;
+		get_slab_interval(min[i], max[i], origin[i], invDir[i], t0, t1);
+		tMin = std::max(tMin, t0);
+		tMax = std::min(tMax, t1);
+		if(tMax < tMin)
+			return false;
+	}
+	return true;
+}
+
+template<typename TTestAabb, typename TTestEntity>
+static bool test_static_bvh_intersection(const StaticBvhSnapshot &snapshot, const TTestAabb &testAabb, const TTestEntity &testEntity, BvhIntersectionInfo *outIntersectionInfo)
+{
+	auto hasHit = false;
+	visit_static_bvh_entities(snapshot, testAabb, [&snapshot, &testEntity, outIntersectionInfo, &hasHit](size_t entIdx, const StaticBvhEntityData &entData) -> bool {
+		if(!testEntity(*entData.bvhData, outIntersectionInfo, snapshot.primitiveOffsets[entIdx]))
+			return true;
+		hasHit = true;
+		// If no intersection info was requested, the first hit is enough
+		return outIntersectionInfo != nullptr;
+	});
+	return hasHit;
+}
+
+std::shared_ptr<const StaticBvhSnapshot> BaseStaticBvhCacheComponent::GetSnapshot() const
+{
+	std::scoped_lock lock {m_bvhDataMutex};
+	return m_snapshot;
+}
+
 bool BaseStaticBvhCacheComponent::IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist, BvhHitInfo &outHitInfo) const
 {
-	const_cast<BaseStaticBvhCacheComponent *>(this)->UpdateBuild();
-	if(m_buildWorker)
-		m_buildWorker->WaitForTask();
-	return BaseBvhComponent::IntersectionTest(origin, dir, minDist, maxDist, outHitInfo);
+	auto snapshot = GetSnapshot();
+	if(!snapshot || snapshot->entities.empty())
+		return false;
+	bvh::Ray<float> ray {
+	  bvh::Vector3<float>(origin.x, origin.y, origin.z), // origin
+	  bvh::Vector3<float>(dir.x, dir.y, dir.z),          // direction
+	  minDist,                                           // minimum distance
+	  maxDist                                            // maximum distance
+	};
+	Vector3 invDir {1.f / dir.x, 1.f / dir.y, 1.f / dir.z};
+	std::optional<bvh::ClosestPrimitiveIntersector<bvh::Bvh<float>, bvh::Triangle<float>>::Result> closestHit {};
+	const StaticBvhEntityData *closestEntData = nullptr;
+	visit_static_bvh_entities(
+	  *snapshot, [&origin, &invDir, &ray](const Vector3 &min, const Vector3 &max) -> bool { return intersect_ray_aabb(origin, invDir, ray.tmin, ray.tmax, min, max); },
+	  [&ray, &closestHit, &closestEntData](size_t entIdx, const StaticBvhEntityData &entData) -> bool {
+		  auto &intersectorData = *entData.bvhData->intersectorData;
+		  auto hit = intersectorData.traverser.traverse(ray, intersectorData.primitiveIntersector);
+		  if(hit) {
+			  // Only hits closer than this one are of interest for the remaining entities
+			  ray.tmax = hit->distance();
+			  closestHit = hit;
+			  closestEntData = &entData;
+		  }
+		  return true;
+	  });
+	if(!closestHit)
+		return false;
+	auto *meshRange = closestEntData->bvhData->FindMeshRange(closestHit->primitive_index);
+	assert(meshRange != nullptr);
+	auto &hitInfo = outHitInfo;
+	hitInfo.primitiveIndex = closestHit->primitive_index - meshRange->start / 3;
+	hitInfo.distance = closestHit->distance();
+	hitInfo.u = closestHit->intersection.u;
+	hitInfo.v = closestHit->intersection.v;
+	hitInfo.t = closestHit->intersection.t;
+	hitInfo.mesh = meshRange->mesh;
+	hitInfo.entity = closestEntData->hEntity;
+	return true;
 }
 
-void BaseStaticBvhCacheComponent::Build(std::vector<std::shared_ptr<ModelSubMesh>> &&meshes, std::vector<BaseEntity *> &&meshToEntity, std::vector<umath::ScaledTransform> &&meshPoses)
+uint32_t BaseStaticBvhCacheComponent::IntersectionTestBatch(const std::vector<BvhRay> &rays, std::vector<std::optional<BvhHitInfo>> &outHits) const
+{
+	outHits.clear();
+	outHits.resize(rays.size());
+	auto snapshot = GetSnapshot();
+	if(!snapshot || snapshot->entities.empty())
+		return 0;
+	auto &topLevel = snapshot->topLevel;
+	uint32_t numHits = 0;
+	BvhRayPacket packet;
+	BvhPacketHits hits;
+	for(size_t offset = 0; offset < rays.size(); offset += BvhRayPacket::SIZE) {
+		packet.Initialize(rays.data() + offset, static_cast<uint32_t>(umath::min(rays.size() - offset, static_cast<size_t>(BvhRayPacket::SIZE))));
+		hits = {};
+		traverse_bvh_packet(snapshot->topLevelNodes, packet, packet.GetActiveMask(), [&snapshot, &topLevel, &packet, &hits](const BvhFlatNode &node, uint32_t rayMask) {
+			for(auto i = decltype(node.primitiveCount) {0u}; i < node.primitiveCount; ++i) {
+				auto entIdx = topLevel.primitive_indices[node.firstChildOrPrimitive + i];
+				auto &entData = *snapshot->entities[entIdx];
+				if(!entData.hEntity.valid())
+					continue;
+				intersect_bvh_packet(*entData.bvhData, packet, rayMask, hits, entIdx);
+			}
+		});
+		for(uint32_t i = 0; i < packet.GetCount(); ++i) {
+			if(!hits[i])
+				continue;
+			auto &entData = *snapshot->entities[hits[i]->sourceIndex];
+			auto &hitInfo = outHits[offset + i];
+			hitInfo = BvhHitInfo {};
+			hitInfo->entity = entData.hEntity;
+			entData.bvhData->GetHitInfo(*hits[i], *hitInfo);
+			++numHits;
+		}
+	}
+	return numHits;
+}
+
+static bool test_static_bvh_intersection_with_aabb(const StaticBvhSnapshot &snapshot, const Vector3 &min, const Vector3 &max, BvhIntersectionInfo *outIntersectionInfo)
+{
+	return test_static_bvh_intersection(
+	  snapshot, [&min, &max](const Vector3 &aabbMin, const Vector3 &aabbMax) -> bool { return umath::intersection::aabb_aabb(min, max, aabbMin, aabbMax) != umath::intersection::Intersect::Outside; },
+	  [&min, &max](const BvhData &bvhData, BvhIntersectionInfo *outIntersectionInfo, size_t primitiveOffset) -> bool { return test_bvh_intersection_with_aabb(bvhData, min, max, 0u, outIntersectionInfo, primitiveOffset); }, outIntersectionInfo);
+}
+static bool test_static_bvh_intersection_with_kdop(const StaticBvhSnapshot &snapshot, const std::vector<umath::Plane> &planes, BvhIntersectionInfo *outIntersectionInfo)
+{
+	return test_static_bvh_intersection(
+	  snapshot, [&planes](const Vector3 &aabbMin, const Vector3 &aabbMax) -> bool { return umath::intersection::aabb_in_plane_mesh(aabbMin, aabbMax, planes) != umath::intersection::Intersect::Outside; },
+	  [&planes](const BvhData &bvhData, BvhIntersectionInfo *outIntersectionInfo, size_t primitiveOffset) -> bool { return test_bvh_intersection_with_kdop(bvhData, planes, 0u, outIntersectionInfo, primitiveOffset); }, outIntersectionInfo);
+}
+
+bool BaseStaticBvhCacheComponent::IntersectionTestAabb(const Vector3 &min, const Vector3 &max) const
+{
+	auto snapshot = GetSnapshot();
+	return snapshot && !snapshot->entities.empty() && test_static_bvh_intersection_with_aabb(*snapshot, min, max, nullptr);
+}
+bool BaseStaticBvhCacheComponent::IntersectionTestAabb(const Vector3 &min, const Vector3 &max, BvhIntersectionInfo &outIntersectionInfo) const
+{
+	auto snapshot = GetSnapshot();
+	if(!snapshot || snapshot->entities.empty() || !test_static_bvh_intersection_with_aabb(*snapshot, min, max, &outIntersectionInfo))
+		return false;
+	outIntersectionInfo.source = snapshot;
+	return true;
+}
+bool BaseStaticBvhCacheComponent::IntersectionTestKDop(const std::vector<umath::Plane> &planes) const
 {
+	auto snapshot = GetSnapshot();
+	return snapshot && !snapshot->entities.empty() && test_static_bvh_intersection_with_kdop(*snapshot, planes, nullptr);
+}
+bool BaseStaticBvhCacheComponent::IntersectionTestKDop(const std::vector<umath::Plane> &planes, BvhIntersectionInfo &outIntersectionInfo) const
+{
+	auto snapshot = GetSnapshot();
+	if(!snapshot || snapshot->entities.empty() || !test_static_bvh_intersection_with_kdop(*snapshot, planes, &outIntersectionInfo))
+		return false;
+	outIntersectionInfo.source = snapshot;
+	return true;
+}
+
+static const BvhMeshRange *find_primitive_mesh_info(const StaticBvhSnapshot &snapshot, size_t primIdx)
+{
+	size_t localPrimIdx;
+	auto *entData = snapshot.FindEntityData(primIdx, localPrimIdx);
+	return entData ? entData->bvhData->FindMeshRange(localPrimIdx) : nullptr;
+}
+static std::optional<Vector3> get_vertex(const StaticBvhSnapshot &snapshot, size_t idx)
+{
+	size_t localPrimIdx;
+	auto *entData = snapshot.FindEntityData(idx / 3, localPrimIdx);
+	if(!entData)
+		return {};
+	auto &prim = entData->bvhData->primitives[localPrimIdx];
+	switch(idx % 3) {
+	case 0:
+		return *reinterpret_cast<const Vector3 *>(&prim.p0.values);
+	case 1:
+		{
+			auto p1 = prim.p1();
+			return *reinterpret_cast<const Vector3 *>(&p1.values);
+		}
+	case 2:
+		{
+			auto p2 = prim.p2();
+			return *reinterpret_cast<const Vector3 *>(&p2.values);
+		}
+	}
+	return {};
+}
+
+const BvhMeshRange *BaseStaticBvhCacheComponent::FindPrimitiveMeshInfo(size_t primIdx) const
+{
+	// Note: The snapshot is only replaced on the main thread when a build is published, so the returned
+	// range stays valid until the next tick. Use the overload with the intersection info to resolve the
+	// primitives of an intersection test against the snapshot the test was performed on.
+	auto snapshot = GetSnapshot();
+	return snapshot ? find_primitive_mesh_info(*snapshot, primIdx) : nullptr;
+}
+const BvhMeshRange *BaseStaticBvhCacheComponent::FindPrimitiveMeshInfo(const BvhIntersectionInfo &intersectionInfo, size_t primIdx) const
+{
+	if(!intersectionInfo.source)
+		return FindPrimitiveMeshInfo(primIdx);
+	return find_primitive_mesh_info(*std::static_pointer_cast<const StaticBvhSnapshot>(intersectionInfo.source), primIdx);
+}
+
+std::optional<Vector3> BaseStaticBvhCacheComponent::GetVertex(size_t idx) const
+{
+	auto snapshot = GetSnapshot();
+	return snapshot ? get_vertex(*snapshot, idx) : std::optional<Vector3> {};
+}
+std::optional<Vector3> BaseStaticBvhCacheComponent::GetVertex(const BvhIntersectionInfo &intersectionInfo, size_t idx) const
+{
+	if(!intersectionInfo.source)
+		return GetVertex(idx);
+	return get_vertex(*std::static_pointer_cast<const StaticBvhSnapshot>(intersectionInfo.source), idx);
+}
+
+void BaseStaticBvhCacheComponent::StartBuild()
+{
+	std::vector<StaticBvhBuildInput> inputs;
+	inputs.reserve(m_entities.size());
+	for(auto *c : m_entities) {
+		auto &ent = c->GetEntity();
+		inputs.push_back({});
+		auto &input = inputs.back();
+		input.hEntity = ent.GetHandle();
+		input.entity = &ent;
+		auto it = m_entityBvhData.find(&ent);
+		if(it != m_entityBvhData.end() && it->second && m_dirtyEntities.find(&ent) == m_dirtyEntities.end()) {
+			input.data = it->second;
+			continue;
+		}
+		// Meshes have to be collected on the main thread, the BVH itself is built in the background
+		CollectEntityMeshes(ent, input.meshes);
+		input.pose = ent.GetPose();
+		// The model extension data may only be accessed on the main thread, so the prebuilt hierarchy is loaded here
+		auto &mdl = ent.GetModel();
+		if(mdl && !input.meshes.empty()) {
+			input.prebuiltBvhKey = get_prebuilt_bvh_key(input.meshes);
+			input.prebuiltHierarchy = load_prebuilt_bvh(*mdl, input.prebuiltBvhKey);
+		}
+	}
+	m_dirtyEntities.clear();
+
 	if(!m_buildWorker) {
 		m_buildWorker = std::make_unique<FunctionalParallelWorker>();
 		m_buildWorker->Start();
 	}
+	m_buildInProgress = true;
+	m_buildWorker->ResetTask([this, inputs = std::move(inputs)](FunctionalParallelWorker &worker) mutable {
+		auto snapshot = build_static_bvh_snapshot(inputs, [&worker]() -> bool { return worker.IsTaskCancelled(); });
+		std::scoped_lock lock {m_bvhDataMutex};
+		if(snapshot && !worker.IsTaskCancelled())
+			m_pendingSnapshot = std::move(snapshot);
+		m_buildInProgress = false;
+	});
+}
+
+bool BaseStaticBvhCacheComponent::PublishBuildResult()
+{
+	std::shared_ptr<StaticBvhSnapshot> snapshot;
 	m_bvhDataMutex.lock();
-	m_bvhData = nullptr; // No longer valid
+	snapshot = std::move(m_pendingSnapshot);
+	m_pendingSnapshot = nullptr;
+	if(snapshot)
+		m_snapshot = snapshot;
 	m_bvhDataMutex.unlock();
-	m_buildWorker->ResetTask([this, meshes = std::move(meshes), meshPoses = std::move(meshPoses), meshToEntity = std::move(meshToEntity)](FunctionalParallelWorker &worker) {
-		std::vector<size_t> meshIndices;
-		auto bvhData = BaseBvhComponent::RebuildBvh(
-		  meshes, &meshPoses, [this]() -> bool { return m_buildWorker->IsTaskCancelled(); }, &meshIndices);
-		if(!bvhData)
-			return;
-		if(worker.IsTaskCancelled())
-			return;
-		auto &meshRanges = get_bvh_mesh_ranges(*bvhData);
-		for(uint32_t i = 0; auto &range : meshRanges) {
-			range.entity = meshToEntity[meshIndices[i++]];
-			if(worker.IsTaskCancelled())
-				return;
-		}
-		if(worker.IsTaskCancelled())
-			return;
-		m_bvhDataMutex.lock();
-		m_bvhData = std::move(bvhData);
-		m_bvhDataMutex.unlock();
-	});
+	if(!snapshot)
+		return false;
+	// Keep the new sub-BVHs around, so they can be re-used by the next build
+	for(auto &entData : snapshot->entities) {
+		if(!entData->hEntity.valid())
+			continue;
+		auto it = m_entityBvhData.find(entData->entity);
+		if(it != m_entityBvhData.end())
+			it->second = entData;
+	}
+	InvokeEventCallbacks(EVENT_ON_BVH_REBUILT);
+	return true;
+}
+
+void BaseStaticBvhCacheComponent::WaitForBuild()
+{
+	if(m_buildWorker && m_buildInProgress)
+		m_buildWorker->WaitForTask();
+	PublishBuildResult();
 }
 
+bool BaseStaticBvhCacheComponent::IsBuildInProgress() const { return m_buildInProgress; }
+
 void BaseStaticBvhCacheComponent::SetCacheDirty()
 {
+	for(auto *c : m_entities)
+		m_dirtyEntities.insert(&c->GetEntity());
 	m_staticBvhDirty = true;
 	SetTickPolicy(TickPolicy::Always);
-
-	if(m_buildWorker)
-		m_buildWorker->CancelTask();
-	m_bvhDataMutex.lock();
-	m_bvhData = nullptr;
-	m_bvhDataMutex.unlock();
 }
 void BaseStaticBvhCacheComponent::OnTick(double tDelta)
 {
-	SetTickPolicy(TickPolicy::Never);
 	UpdateBuild();
+	if(m_staticBvhDirty || m_buildInProgress)
+		return;
+	std::scoped_lock lock {m_bvhDataMutex};
+	if(!m_pendingSnapshot)
+		SetTickPolicy(TickPolicy::Never);
 }
 void BaseStaticBvhCacheComponent::UpdateBuild()
 {
-	if(!m_staticBvhDirty)
+	PublishBuildResult();
+	// Changes made while a build is running are picked up by the next build once the current one has completed
+	if(!m_staticBvhDirty || m_buildInProgress)
 		return;
 	m_staticBvhDirty = false;
-	TestRebuildBvh();
+	StartBuild();
 }
 void BaseStaticBvhCacheComponent::SetEntityDirty(BaseEntity &ent)
 {
-	// TODO: Only reload meshes for this entity (unless meshes themselves have changed)
-	SetCacheDirty();
+	if(m_entityBvhData.find(&ent) == m_entityBvhData.end())
+		return;
+	m_dirtyEntities.insert(&ent);
+	m_staticBvhDirty = true;
+	SetTickPolicy(TickPolicy::Always);
 }
 void BaseStaticBvhCacheComponent::AddEntity(BaseEntity &ent)
 {
@@ -205,8 +590,9 @@ void BaseStaticBvhCacheComponent::AddEntity(BaseEntity &ent)
 		return;
 	c->SetStaticBvhCacheComponent(this);
 	m_entities.insert(c);
+	m_entityBvhData[&ent] = nullptr;
 
-	SetCacheDirty();
+	SetEntityDirty(ent);
 	c->UpdateBvhStatus();
 }
 void BaseStaticBvhCacheComponent::RemoveEntity(BaseEntity &ent, bool removeFinal)
@@ -219,6 +605,10 @@ void BaseStaticBvhCacheComponent::RemoveEntity(BaseEntity &ent, bool removeFinal
 	auto it = m_entities.find(c);
 	if(it == m_entities.end())
 		return;
-	SetCacheDirty();
 	m_entities.erase(it);
+	m_entityBvhData.erase(&ent);
+	m_dirtyEntities.erase(&ent);
+	// Only the top-level BVH has to be rebuilt
+	m_staticBvhDirty = true;
+	SetTickPolicy(TickPolicy::Always);
 }
@@ -0,0 +1,84 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#include "stdafx_shared.h"
+#include "pragma/entities/components/component_event_dispatch_table.hpp"
+
+using namespace pragma;
+
+CallbackHandle &ComponentEventListenerList::push_back(const CallbackHandle &hCallback)
+{
+	if(m_overflow.empty()) {
+		if(m_numInline < INLINE_CAPACITY) {
+			m_inline[m_numInline] = hCallback;
+			return m_inline[m_numInline++];
+		}
+		m_overflow.reserve(INLINE_CAPACITY * 2);
+		for(auto i = decltype(m_numInline) {0u}; i < m_numInline; ++i) {
+			m_overflow.push_back(std::move(m_inline[i]));
+			m_inline[i] = {};
+		}
+		m_numInline = 0;
+	}
+	m_overflow.push_back(hCallback);
+	return m_overflow.back();
+}
+void ComponentEventListenerList::erase(size_t idx)
+{
+	if(!m_overflow.empty()) {
+		m_overflow.erase(m_overflow.begin() + idx);
+		return;
+	}
+	for(auto i = idx; (i + 1) < m_numInline; ++i)
+		m_inline[i] = std::move(m_inline[i + 1]);
+	m_inline[--m_numInline] = {};
+}
+std::optional<size_t> ComponentEventListenerList::find(const CallbackHandle &hCallback) const
+{
+	for(size_t i = 0; i < size(); ++i) {
+		if((*this)[i] == hCallback)
+			return i;
+	}
+	return {};
+}
+
+////////////
+
+template<typename T>
+static auto find_entry(T &entries, ComponentEventId eventId)
+{
+	return std::lower_bound(entries.begin(), entries.end(), eventId, [](const ComponentEventDispatchTable::Entry &entry, ComponentEventId eventId) { return entry.eventId < eventId; });
+}
+ComponentEventListenerList *ComponentEventDispatchTable::FindListeners(ComponentEventId eventId)
+{
+	if(!MayHaveListeners(eventId))
+		return nullptr;
+	auto it = find_entry(m_entries, eventId);
+	return (it != m_entries.end() && it->eventId == eventId) ? &it->listeners : nullptr;
+}
+ComponentEventListenerList &ComponentEventDispatchTable::GetListeners(ComponentEventId eventId)
+{
+	auto it = find_entry(m_entries, eventId);
+	if(it == m_entries.end() || it->eventId != eventId)
+		it = m_entries.insert(it, Entry {eventId, {}});
+	m_eventMask |= get_event_bit(eventId);
+	return it->listeners;
+}
+void ComponentEventDispatchTable::Erase(ComponentEventId eventId)
+{
+	auto it = find_entry(m_entries, eventId);
+	if(it == m_entries.end() || it->eventId != eventId)
+		return;
+	m_entries.erase(it);
+	m_eventMask = 0;
+	for(auto &entry : m_entries)
+		m_eventMask |= get_event_bit(entry.eventId);
+}
+void ComponentEventDispatchTable::Clear()
+{
+	m_entries.clear();
+	m_eventMask = 0;
+}
@@ -13,6 +13,7 @@
 #include "pragma/entities/attribute_specialization_type.hpp"
 #include "pragma/util/global_string_table.hpp"
 #include <udm.hpp>
+#include <mutex>
 
 using namespace pragma;
 
@@ -29,6 +30,19 @@ static ComponentEventId get_component_event_id(const std::string &name)
 	return id;
 }
 
+uint32_t pragma::detail::get_component_type_slot(std::type_index typeIndex)
+{
+	static std::mutex slotMutex;
+	static std::unordered_map<std::type_index, uint32_t> typeSlots;
+	std::scoped_lock lock {slotMutex};
+	auto it = typeSlots.find(typeIndex);
+	if(it != typeSlots.end())
+		return it->second;
+	auto slot = static_cast<uint32_t>(typeSlots.size());
+	typeSlots.insert(std::make_pair(typeIndex, slot));
+	return slot;
+}
+
 size_t pragma::get_component_member_name_hash(const char *name) { return get_component_member_name_hash(std::string {name}); }
 size_t pragma::get_component_member_name_hash(const std::string &name)
 {
@@ -186,6 +200,7 @@ ComponentInfo &ComponentInfo::operator=(const ComponentInfo &other)
 	flags = other.flags;
 	members = other.members;
 	memberNameToIndex = other.memberNameToIndex;
+	pool = other.pool;
 	onCreateCallbacks = nullptr;
 	if(other.onCreateCallbacks) {
 		onCreateCallbacks = std::make_unique<std::vector<CallbackHandle>>();
@@ -206,8 +221,9 @@ ComponentInfo &ComponentInfo::operator=(ComponentInfo &&other)
 	flags = other.flags, members = std::move(other.members);
 	memberNameToIndex = std::move(other.memberNameToIndex);
 	onCreateCallbacks = std::move(other.onCreateCallbacks);
+	pool = other.pool;
 #ifdef _MSVC_VER
-	static_assert(sizeof(*this) == 200);
+	static_assert(sizeof(*this) == 216);
 #endif
 	return *this;
 }
@@ -245,7 +261,7 @@ util::TSharedHandle<BaseEntityComponent> EntityComponentManager::CreateComponent
 	if(r == nullptr)
 		return nullptr;
 	r->m_componentId = info.id;
-	m_components.at(r->m_componentId).Push(*r);
+	m_components.at(r->m_componentId).Push(*r, (r->m_poolIndex != BaseEntityComponent::INVALID_POOL_INDEX) ? r->m_poolIndex : std::optional<std::size_t> {});
 	if(info.onCreateCallbacks) {
 		for(auto it = info.onCreateCallbacks->begin(); it != info.onCreateCallbacks->end();) {
 			auto &cb = *it;
@@ -315,7 +331,8 @@ CallbackHandle EntityComponentManager::AddCreationCallback(const std::string &co
 		id = PreRegisterComponentType(componentName);
 	return AddCreationCallback(id, onCreate);
 }
-ComponentId EntityComponentManager::RegisterComponentType(const std::string &name, const std::function<util::TSharedHandle<BaseEntityComponent>(BaseEntity &)> &factory, ComponentFlags flags, const std::type_index *typeIndex)
+ComponentId EntityComponentManager::RegisterComponentType(const std::string &name, const std::function<util::TSharedHandle<BaseEntityComponent>(BaseEntity &)> &factory, ComponentFlags flags, const std::type_index *typeIndex,
+  const std::shared_ptr<EntityComponentPool> &pool)
 {
 	if(typeIndex != nullptr) {
 		auto it = m_typeIndexToComponentId.find(*typeIndex);
@@ -328,6 +345,9 @@ ComponentId EntityComponentManager::RegisterComponentType(const std::string &nam
 		auto &pComponentInfo = *GetComponentInfo(componentId);
 		pComponentInfo.factory = factory;
 		pComponentInfo.flags = flags;
+		// Components created by the previous factory keep their own pool alive through their deleters
+		pComponentInfo.pool = pool;
+		m_components.at(componentId).SetUsePoolIndices(pool != nullptr);
 		OnComponentTypeRegistered(pComponentInfo);
 		return componentId;
 	}
@@ -341,6 +361,10 @@ ComponentId EntityComponentManager::RegisterComponentType(const std::string &nam
 	auto &componentInfo = m_componentInfos.at(componentId) = *itPre;
 	if(typeIndex != nullptr) {
 		m_typeIndexToComponentId.insert(std::make_pair(*typeIndex, componentId));
+		auto slot = detail::get_component_type_slot(*typeIndex);
+		if(slot >= m_typeSlotToComponentId.size())
+			m_typeSlotToComponentId.resize(slot + 1u, INVALID_COMPONENT_ID);
+		m_typeSlotToComponentId[slot] = componentId;
 		if(componentId >= m_componentIdToTypeIndex.size())
 			m_componentIdToTypeIndex.resize(componentId + 1u, nullptr);
 		m_componentIdToTypeIndex.at(componentId) = std::make_shared<std::type_index>(*typeIndex);
@@ -349,6 +373,8 @@ ComponentId EntityComponentManager::RegisterComponentType(const std::string &nam
 
 	componentInfo.factory = factory;
 	componentInfo.flags = flags;
+	componentInfo.pool = pool;
+	m_components.at(componentId).SetUsePoolIndices(pool != nullptr);
 	OnComponentTypeRegistered(componentInfo);
 	return componentInfo.id;
 }
@@ -489,12 +515,26 @@ const std::vector<BaseEntityComponent *> &EntityComponentManager::GetComponents(
 	count = info.GetCount();
 	return info.GetComponents();
 }
-void EntityComponentManager::DeregisterComponent(BaseEntityComponent &component) { m_components.at(component.GetComponentId()).Pop(component); }
+void EntityComponentManager::DeregisterComponent(BaseEntityComponent &component)
+{
+	auto index = (component.m_poolIndex != BaseEntityComponent::INVALID_POOL_INDEX) ? component.m_poolIndex : std::optional<std::size_t> {};
+	m_components.at(component.GetComponentId()).Pop(component, index);
+}
 
 ////////////////////
 
-void EntityComponentManager::ComponentContainerInfo::Push(BaseEntityComponent &component)
-{
+void EntityComponentManager::ComponentContainerInfo::Push(BaseEntityComponent &component, std::optional<std::size_t> index)
+{
+	assert(m_usePoolIndices == false || index.has_value());
+	if(m_usePoolIndices && index.has_value()) {
+		// Free slots are managed by the pool
+		if(*index >= m_components.size())
+			m_components.resize(*index + 1u, nullptr);
+		assert(m_components[*index] == nullptr);
+		m_components[*index] = &component;
+		m_count = umath::max(m_count, *index + 1u);
+		return;
+	}
 	if(m_freeIndices.empty() == false) {
 		auto idx = m_freeIndices.front();
 		m_freeIndices.pop();
@@ -518,12 +558,18 @@ void EntityComponentManager::ComponentContainerInfo::Push(BaseEntityComponent &c
 	m_components.push_back(&component);
 	++m_count;
 }
-void EntityComponentManager::ComponentContainerInfo::Pop(BaseEntityComponent &component)
+void EntityComponentManager::ComponentContainerInfo::Pop(BaseEntityComponent &component, std::optional<std::size_t> index)
 {
-	auto it = std::find_if(m_components.begin(), m_components.end(), [&component](const pragma::BaseEntityComponent *componentOther) { return &component == componentOther; });
-	if(it == m_components.end())
-		return;
-	auto idx = it - m_components.begin();
+	size_t idx;
+	if(index.has_value() && *index < m_components.size() && m_components[*index] == &component)
+		idx = *index;
+	else {
+		auto it = std::find_if(m_components.begin(), m_components.end(), [&component](const pragma::BaseEntityComponent *componentOther) { return &component == componentOther; });
+		if(it == m_components.end())
+			return;
+		idx = it - m_components.begin();
+		index = {};
+	}
 	m_components.at(idx) = nullptr;
 	if((idx + 1u) == m_count) {
 		while(idx > 0ull && m_components.at(idx) == nullptr) {
@@ -532,10 +578,30 @@ void EntityComponentManager::ComponentContainerInfo::Pop(BaseEntityComponent &co
 		}
 		if(idx == 0ull && m_components.front() == nullptr)
 			m_count = 0ull;
+		if(m_count == 0ull && m_usePoolIndices != m_poolIndicesRequested)
+			SetUsePoolIndices(m_poolIndicesRequested);
 	}
-	else
+	else if(!m_usePoolIndices)
 		m_freeIndices.push(idx);
 }
+void EntityComponentManager::ComponentContainerInfo::SetUsePoolIndices(bool usePoolIndices)
+{
+	m_poolIndicesRequested = usePoolIndices;
+	if(m_count == 0) {
+		m_usePoolIndices = usePoolIndices;
+		m_freeIndices = {};
+		return;
+	}
+	// The slot indices of a new pool would collide with the live components, so pool indices can only be used
+	// again once the container is empty. If the container was using pool indices, the unoccupied slots become free indices.
+	if(m_usePoolIndices) {
+		for(auto i = decltype(m_count) {0u}; i < m_count; ++i) {
+			if(m_components[i] == nullptr)
+				m_freeIndices.push(i);
+		}
+	}
+	m_usePoolIndices = false;
+}
 const std::vector<BaseEntityComponent *> &EntityComponentManager::ComponentContainerInfo::GetComponents() const { return m_components; }
 std::size_t EntityComponentManager::ComponentContainerInfo::GetCount() const { return m_count; }
 
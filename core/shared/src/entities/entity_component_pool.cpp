@@ -0,0 +1,60 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#include "stdafx_shared.h"
+#include "pragma/entities/entity_component_pool.hpp"
+#include <new>
+
+using namespace pragma;
+
+EntityComponentPool::EntityComponentPool(size_t elementSize, size_t alignment) : m_alignment {alignment}
+{
+	// Each element has to start at an aligned address
+	m_elementSize = ((elementSize + alignment - 1) / alignment) * alignment;
+}
+
+EntityComponentPool::~EntityComponentPool()
+{
+	for(auto *slab : m_slabs)
+		::operator delete(slab, std::align_val_t {m_alignment});
+}
+
+std::byte *EntityComponentPool::GetElement(uint32_t index) const { return m_slabs[index / SLAB_ELEMENT_COUNT] + (index % SLAB_ELEMENT_COUNT) * m_elementSize; }
+
+void *EntityComponentPool::Allocate(uint32_t &outIndex)
+{
+	std::scoped_lock lock {m_mutex};
+	if(m_freeIndices.empty()) {
+		auto *slab = static_cast<std::byte *>(::operator new(m_elementSize * SLAB_ELEMENT_COUNT, std::align_val_t {m_alignment}));
+		auto offset = static_cast<uint32_t>(m_slabs.size()) * SLAB_ELEMENT_COUNT;
+		m_slabs.push_back(slab);
+		for(uint32_t i = 0; i < SLAB_ELEMENT_COUNT; ++i)
+			m_freeIndices.push(offset + i);
+	}
+	outIndex = m_freeIndices.top();
+	m_freeIndices.pop();
+	++m_numAllocated;
+	return GetElement(outIndex);
+}
+
+void EntityComponentPool::Free(uint32_t index)
+{
+	std::scoped_lock lock {m_mutex};
+	assert(index < m_slabs.size() * SLAB_ELEMENT_COUNT);
+	m_freeIndices.push(index);
+	--m_numAllocated;
+}
+
+uint32_t EntityComponentPool::GetCapacity() const
+{
+	std::scoped_lock lock {m_mutex};
+	return static_cast<uint32_t>(m_slabs.size()) * SLAB_ELEMENT_COUNT;
+}
+uint32_t EntityComponentPool::GetAllocatedCount() const
+{
+	std::scoped_lock lock {m_mutex};
+	return m_numAllocated;
+}
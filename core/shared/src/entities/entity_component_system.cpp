@@ -101,9 +101,9 @@ pragma::ComponentHandle<pragma::BaseEntityComponent> BaseEntityComponentSystem::
 	if(m_components.size() == m_components.capacity())
 		m_components.reserve(m_components.size() + 5u);
 	m_components.push_back(ptrComponent);
-	auto it = m_componentLookupTable.find(componentId);
-	if(it == m_componentLookupTable.end())
-		m_componentLookupTable.insert(std::make_pair(componentId, ptrComponent));
+	auto it = std::lower_bound(m_componentLookupTable.begin(), m_componentLookupTable.end(), componentId, [](const ComponentLookupEntry &entry, ComponentId id) { return entry.componentId < id; });
+	if(it == m_componentLookupTable.end() || it->componentId != componentId)
+		m_componentLookupTable.insert(it, ComponentLookupEntry {componentId, ptrComponent});
 
 	ptrComponent->Initialize();
 
@@ -218,15 +218,15 @@ void BaseEntityComponentSystem::RemoveComponent(pragma::BaseEntityComponent &com
 	// Safe to free now
 	tmpHandle = util::TSharedHandle<BaseEntityComponent> {};
 
-	auto itType = m_componentLookupTable.find(componentId);
-	if(itType != m_componentLookupTable.end()) {
+	auto *entry = FindLookupEntry(componentId);
+	if(entry != nullptr) {
 		// Find a different component of the same type
 		auto it = std::find_if(m_components.begin(), m_components.end(), [componentId](const util::TSharedHandle<BaseEntityComponent> &ptrComponent) { return ptrComponent.valid() && ptrComponent->GetComponentId() == componentId; });
 		if(it == m_components.end()) {
-			m_componentLookupTable.erase(itType);
+			m_componentLookupTable.erase(m_componentLookupTable.begin() + (entry - m_componentLookupTable.data()));
 			return;
 		}
-		itType->second = *it;
+		entry->component = *it;
 	}
 }
 void BaseEntityComponentSystem::RemoveComponent(ComponentId componentId)
@@ -246,10 +246,15 @@ void BaseEntityComponentSystem::RemoveComponent(const std::string &name)
 }
 void BaseEntityComponentSystem::OnComponentAdded(BaseEntityComponent &component) {}
 void BaseEntityComponentSystem::OnComponentRemoved(BaseEntityComponent &component) {}
+const BaseEntityComponentSystem::ComponentLookupEntry *BaseEntityComponentSystem::FindLookupEntry(ComponentId componentId) const
+{
+	auto it = std::lower_bound(m_componentLookupTable.begin(), m_componentLookupTable.end(), componentId, [](const ComponentLookupEntry &entry, ComponentId id) { return entry.componentId < id; });
+	return (it != m_componentLookupTable.end() && it->componentId == componentId) ? &*it : nullptr;
+}
 bool pragma::BaseEntityComponentSystem::HasComponent(ComponentId componentId) const
 {
-	auto it = m_componentLookupTable.find(componentId);
-	return it != m_componentLookupTable.end() && it->second.expired() == false;
+	auto *entry = FindLookupEntry(componentId);
+	return entry != nullptr && entry->component.expired() == false;
 }
 
 const std::vector<util::TSharedHandle<BaseEntityComponent>> &BaseEntityComponentSystem::GetComponents() const { return const_cast<BaseEntityComponentSystem *>(this)->GetComponents(); }
@@ -257,10 +262,10 @@ std::vector<util::TSharedHandle<BaseEntityComponent>> &BaseEntityComponentSystem
 
 pragma::ComponentHandle<BaseEntityComponent> BaseEntityComponentSystem::FindComponent(ComponentId componentId) const
 {
-	auto it = m_componentLookupTable.find(componentId);
-	if(it == m_componentLookupTable.end())
+	auto *entry = FindLookupEntry(componentId);
+	if(entry == nullptr)
 		return {};
-	return it->second;
+	return entry->component;
 }
 pragma::ComponentHandle<BaseEntityComponent> BaseEntityComponentSystem::FindComponent(const std::string &name) const
 {
@@ -164,6 +164,7 @@ std::shared_ptr<pragma::animation::Animation> FWAD::ReadData(unsigned short mdlV
 		}
 		anim->AddFrame(frame);
 	}
+	anim->Compress();
 	//fclose(m_file);
 	return anim;
 }
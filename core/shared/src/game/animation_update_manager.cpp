@@ -14,8 +14,10 @@
 #include "pragma/entities/components/ik_solver_component.hpp"
 #include "pragma/entities/entity_iterator.hpp"
 #include "pragma/entities/entity_component_system_t.hpp"
+#include "pragma/util/job_system.hpp"
+#include "pragma/engine.h"
 
-pragma::AnimationUpdateManager::AnimationUpdateManager(Game &game) : game {game}, m_threadPool {10, "animation_update"}
+pragma::AnimationUpdateManager::AnimationUpdateManager(Game &game) : game {game}
 {
 	auto &componentManager = game.GetEntityComponentManager();
 	auto r = componentManager.GetComponentTypeId("animated", m_animatedComponentId);
@@ -38,19 +40,36 @@ void pragma::AnimationUpdateManager::UpdateEntityState(BaseEntity &ent)
 	if(panimaC.valid() && umath::is_flag_set(panimaC->GetStateFlags(),BaseEntityComponent::StateFlags::Removed))
 		panimaC = pragma::ComponentHandle<PanimaComponent>{};
 
-	auto it = std::find_if(m_animatedEntities.begin(), m_animatedEntities.end(), [&ent](const AnimatedEntity &animEnt) { return animEnt.entity == &ent; });
+	auto entIdx = ent.GetLocalIndex();
+	auto slot = (entIdx < m_entityIndexToSlot.size()) ? m_entityIndexToSlot[entIdx] : INVALID_SLOT;
 	if(animC.expired() && panimaC.expired()) {
-		if(it != m_animatedEntities.end())
-			m_animatedEntities.erase(it);
+		if(slot != INVALID_SLOT)
+			RemoveSlot(slot);
 		return;
 	}
-	if(it == m_animatedEntities.end()) {
+	if(slot == INVALID_SLOT) {
+		if(entIdx >= m_entityIndexToSlot.size())
+			m_entityIndexToSlot.resize(entIdx + 1, INVALID_SLOT);
+		slot = static_cast<uint32_t>(m_animatedEntities.size());
+		m_entityIndexToSlot[entIdx] = slot;
 		m_animatedEntities.push_back({});
-		it = m_animatedEntities.end() - 1;
 	}
-	it->entity = &ent;
-	it->animatedC = animC.get();
-	it->panimaC = panimaC.get();
+	auto &animEnt = m_animatedEntities[slot];
+	animEnt.entity = &ent;
+	animEnt.animatedC = animC.get();
+	animEnt.panimaC = panimaC.get();
+}
+void pragma::AnimationUpdateManager::RemoveSlot(uint32_t slot)
+{
+	// Swap with the last entry to keep the list dense
+	auto &animEnt = m_animatedEntities[slot];
+	m_entityIndexToSlot[animEnt.entity->GetLocalIndex()] = INVALID_SLOT;
+	auto lastSlot = static_cast<uint32_t>(m_animatedEntities.size() - 1);
+	if(slot != lastSlot) {
+		animEnt = m_animatedEntities[lastSlot];
+		m_entityIndexToSlot[animEnt.entity->GetLocalIndex()] = slot;
+	}
+	m_animatedEntities.pop_back();
 }
 const std::vector<pragma::AnimationUpdateManager::AnimatedEntity> &pragma::AnimationUpdateManager::GetAnimatedEntities() const { return m_animatedEntities; }
 void pragma::AnimationUpdateManager::UpdateEntityAnimationDrivers(double dt)
@@ -65,19 +84,47 @@ void pragma::AnimationUpdateManager::UpdateConstraints(double dt)
 }
 void pragma::AnimationUpdateManager::UpdateAnimations(double dt)
 {
+	// Events that are not marked as multi-threaded (*_MT) may call into Lua, so
+	// PreMaintainAnimations has to be called on the main thread.
+	m_maintainedEntities.clear();
+	m_maintainedEntities.reserve(m_animatedEntities.size());
 	for(auto &entInfo : m_animatedEntities) {
 		auto maintainAnimations = entInfo.animatedC ? entInfo.animatedC->PreMaintainAnimations(dt) : false;
 		if(maintainAnimations)
-			entInfo.animatedC->UpdateAnimations(dt);
+			m_maintainedEntities.push_back(entInfo.animatedC);
+	}
+
+	// The skeletal animation evaluation only invokes multi-threaded events and can
+	// be processed in parallel. Everything else is deferred by the components until
+	// FlushDeferredAnimationEvents.
+	auto numEntities = m_maintainedEntities.size();
+	if(numEntities <= ENTITIES_PER_JOB) {
+		for(auto *animatedC : m_maintainedEntities)
+			animatedC->UpdateAnimations(dt);
+	}
+	else {
+		auto &jobSystem = pragma::get_engine()->GetJobSystem();
+		for(auto offset = decltype(numEntities) {0u}; offset < numEntities; offset += ENTITIES_PER_JOB) {
+			auto end = std::min(offset + ENTITIES_PER_JOB, numEntities);
+			jobSystem.Schedule(
+			  [this, offset, end, dt]() {
+				  for(auto i = offset; i < end; ++i)
+					  m_maintainedEntities[i]->UpdateAnimations(dt);
+			  },
+			  &m_jobCounter);
+		}
+		jobSystem.Wait(m_jobCounter);
+	}
+	// Bone transform events and random animation selections have to be handled on the main thread
+	for(auto *animatedC : m_maintainedEntities)
+		animatedC->FlushDeferredAnimationEvents();
 
+	// Panima animations may apply values to arbitrary component properties
+	for(auto &entInfo : m_animatedEntities) {
 		if(entInfo.panimaC)
 			entInfo.panimaC->UpdateAnimations(dt);
-		//return nullptr;
-		//});
 	}
 
-	m_threadPool.WaitForCompletion();
-
 	// The remaining steps have to be executed on the main thread because
 	// they may affect arbitrary component properties or call listeners and events,
 	// which can't be guaranteed to be thread-safe in all cases.
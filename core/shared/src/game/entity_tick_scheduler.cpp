@@ -0,0 +1,148 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan */
+
+#include "stdafx_shared.h"
+#include "pragma/game/entity_tick_scheduler.hpp"
+#include "pragma/entities/components/base_entity_component.hpp"
+
+using namespace pragma;
+
+static constexpr size_t MIN_HEAP_COMPACTION_SIZE = 64;
+
+template<typename T>
+static bool compare_scheduled_entries(const T &a, const T &b)
+{
+	// Min-heap
+	return a.time > b.time;
+}
+
+void EntityTickScheduler::Add(BaseEntityComponent &component)
+{
+	assert(component.m_tickData.schedulerSlot == INVALID_SLOT);
+	uint32_t slot;
+	if(!m_freeSlots.empty()) {
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else {
+		slot = static_cast<uint32_t>(m_slots.size());
+		m_slots.push_back({});
+	}
+	auto &slotData = m_slots[slot];
+	slotData.component = &component;
+	slotData.state = State::Active;
+	m_active.push_back({slot, slotData.generation});
+	component.m_tickData.schedulerSlot = slot;
+	++m_numComponents;
+}
+
+void EntityTickScheduler::Remove(BaseEntityComponent &component)
+{
+	auto slot = component.m_tickData.schedulerSlot;
+	if(slot == INVALID_SLOT)
+		return;
+	FreeSlot(slot);
+	component.m_tickData.schedulerSlot = INVALID_SLOT;
+}
+
+void EntityTickScheduler::Reschedule(BaseEntityComponent &component)
+{
+	auto slot = component.m_tickData.schedulerSlot;
+	if(slot == INVALID_SLOT)
+		return;
+	// Active components check their next tick time every tick anyway
+	if(m_slots[slot].state == State::Scheduled)
+		Schedule(slot, component.GetNextTick());
+}
+
+void EntityTickScheduler::FreeSlot(uint32_t slot)
+{
+	auto &slotData = m_slots[slot];
+	if(slotData.state == State::Scheduled)
+		--m_numScheduled;
+	slotData.component = nullptr;
+	slotData.state = State::Free;
+	// Invalidates all existing entries for this slot
+	++slotData.generation;
+	m_freeSlots.push_back(slot);
+	--m_numComponents;
+}
+
+void EntityTickScheduler::Activate(uint32_t slot)
+{
+	auto &slotData = m_slots[slot];
+	if(slotData.state == State::Scheduled)
+		--m_numScheduled;
+	slotData.state = State::Active;
+	++slotData.generation;
+	m_active.push_back({slot, slotData.generation});
+}
+
+void EntityTickScheduler::Schedule(uint32_t slot, double time)
+{
+	auto &slotData = m_slots[slot];
+	if(slotData.state != State::Scheduled)
+		++m_numScheduled;
+	slotData.state = State::Scheduled;
+	++slotData.generation;
+	m_heap.push_back({time, slot, slotData.generation});
+	std::push_heap(m_heap.begin(), m_heap.end(), compare_scheduled_entries<ScheduledEntry>);
+}
+
+void EntityTickScheduler::PopDueComponents(double tCur)
+{
+	while(!m_heap.empty() && m_heap.front().time <= tCur) {
+		std::pop_heap(m_heap.begin(), m_heap.end(), compare_scheduled_entries<ScheduledEntry>);
+		auto entry = m_heap.back();
+		m_heap.pop_back();
+		if(IsValid(entry.slot, entry.generation))
+			Activate(entry.slot);
+	}
+}
+
+void EntityTickScheduler::CompactHeap()
+{
+	// Stale entries are usually discarded once they're due, but components that are rescheduled far into the future
+	// repeatedly could let them pile up
+	if(m_heap.size() < MIN_HEAP_COMPACTION_SIZE || m_heap.size() <= m_numScheduled * 2)
+		return;
+	m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(), [this](const ScheduledEntry &entry) { return !IsValid(entry.slot, entry.generation); }), m_heap.end());
+	std::make_heap(m_heap.begin(), m_heap.end(), compare_scheduled_entries<ScheduledEntry>);
+}
+
+void EntityTickScheduler::Tick(double tCur, double tDelta)
+{
+	PopDueComponents(tCur);
+
+	// Note: Components may be added (and are appended to m_active) or removed during the loop. Entries are
+	// never erased from the list directly, instead the remaining valid entries are compacted in-place.
+	size_t numKept = 0;
+	for(size_t i = 0; i < m_active.size(); ++i) {
+		auto entry = m_active[i];
+		if(!IsValid(entry.slot, entry.generation))
+			continue;
+		auto *c = m_slots[entry.slot].component;
+		if(tCur < c->GetNextTick()) {
+			Schedule(entry.slot, c->GetNextTick());
+			continue;
+		}
+		auto keepTicking = c->Tick(tDelta);
+		if(!IsValid(entry.slot, entry.generation))
+			continue; // Component has been removed during its tick
+		if(!keepTicking) {
+			Remove(*c);
+			continue;
+		}
+		if(tCur < c->GetNextTick()) {
+			Schedule(entry.slot, c->GetNextTick());
+			continue;
+		}
+		m_active[numKept++] = entry;
+	}
+	m_active.resize(numKept);
+
+	CompactHeap();
+}
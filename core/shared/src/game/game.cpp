@@ -26,6 +26,7 @@
 #include "pragma/console/engine_cvar.h"
 #include "pragma/game/game_callback.h"
 #include "pragma/game/animation_update_manager.hpp"
+#include "pragma/game/entity_tick_scheduler.hpp"
 #include "pragma/lua/luafunction_call.h"
 #include "pragma/addonsystem/addonsystem.h"
 #include "pragma/lua/lua_script_watcher.h"
@@ -200,6 +201,7 @@ Game::Game(NetworkState *state)
 	m_luaNetMessageIndex.push_back("invalid");
 	m_luaEnts = std::make_unique<LuaEntityManager>();
 	m_ammoTypes = std::make_unique<AmmoTypeManager>();
+	m_entityTickScheduler = std::make_unique<pragma::EntityTickScheduler>();
 
 	RegisterCallback<void>("Tick");
 	RegisterCallback<void>("Think");
@@ -657,10 +659,8 @@ void Game::Tick()
 	CallCallbacks("PrePhysicsSimulate");
 	CallLuaCallbacks("PrePhysicsSimulate");
 	StartProfilingStage(CPUProfilingPhase::PhysicsSimulation);
-	if(IsPhysicsSimulationEnabled() == true && m_physEnvironment) {
-		static int maxSteps = 1;
-		m_tPhysDeltaRemainder = m_physEnvironment->StepSimulation(CFloat(m_tDeltaTick + m_tPhysDeltaRemainder), maxSteps, CFloat(m_tDeltaTick));
-	}
+	if(IsPhysicsSimulationEnabled() == true && m_physEnvironment)
+		SimulatePhysics();
 	StopProfilingStage(CPUProfilingPhase::PhysicsSimulation);
 	CallCallbacks("PostPhysicsSimulate");
 	CallLuaCallbacks("PostPhysicsSimulate");
@@ -694,25 +694,7 @@ void Game::Tick()
 	// Perform some cleanup
 	pragma::BaseEntityComponentSystem::Cleanup();
 
-	auto &logicComponents = GetEntityTickComponents();
-	// Note: During the loop, new items may be appended to the end of logicComponents, but no elements
-	// may be erased from outside sources. If an element is removed, it's set to nullptr.
-	for(auto i = decltype(logicComponents.size()) {0u}; i < logicComponents.size();) {
-		auto *c = logicComponents[i];
-		if(c == nullptr) {
-			logicComponents.erase(logicComponents.begin() + i);
-			continue;
-		}
-		if(m_tCur < c->GetNextTick()) {
-			++i;
-			continue;
-		}
-		if(c->Tick(m_tDeltaTick) == false) {
-			logicComponents.erase(logicComponents.begin() + i);
-			continue;
-		}
-		++i;
-	}
+	m_entityTickScheduler->Tick(m_tCur, m_tDeltaTick);
 
 	StopProfilingStage(CPUProfilingPhase::GameObjectLogic);
 
@@ -725,6 +707,51 @@ void Game::Tick()
 }
 void Game::PostTick() { m_tLastTick = m_tCur; }
 
+void Game::SimulatePhysics()
+{
+	auto physicsRate = GetConVarFloat("sv_physics_simulation_rate");
+	auto maxSubsteps = static_cast<uint32_t>(umath::max(GetConVarInt("sv_physics_max_substeps"), 1));
+	m_physicsInterpolationEnabled = (physicsRate > 0.f);
+	m_physicsTimeStep = m_physicsInterpolationEnabled ? (GetTimeScale() / static_cast<double>(physicsRate)) : m_tDeltaTick;
+	m_lastPhysicsSubstepCount = 0;
+	m_tLastPhysicsStep = m_tCur;
+	if(m_physicsTimeStep <= 0.0)
+		return;
+	m_tPhysDeltaRemainder += m_tDeltaTick;
+	// The tolerance prevents a step from being skipped due to precision errors if the physics rate matches the tickrate
+	auto numSteps = static_cast<uint32_t>((m_tPhysDeltaRemainder + m_physicsTimeStep * 0.001) / m_physicsTimeStep);
+	if(numSteps > maxSubsteps) {
+		// We can't catch up, drop the remaining time instead of falling further and further behind
+		numSteps = maxSubsteps;
+		m_tPhysDeltaRemainder = numSteps * m_physicsTimeStep;
+	}
+	auto &awakePhysics = GetAwakePhysicsComponents();
+	for(auto i = decltype(numSteps) {0u}; i < numSteps; ++i) {
+		if(m_physicsInterpolationEnabled && i == numSteps - 1) {
+			// Only the state before the last step is required for interpolation
+			for(auto &hPhysC : awakePhysics) {
+				if(hPhysC.expired() || hPhysC->GetPhysicsType() == PHYSICSTYPE::NONE)
+					continue;
+				hPhysC->StorePreviousPhysicsPose(m_physicsStepIndex + 1);
+			}
+		}
+		m_physEnvironment->StepSimulation(CFloat(m_physicsTimeStep), 1, CFloat(m_physicsTimeStep));
+		m_tPhysDeltaRemainder -= m_physicsTimeStep;
+		++m_physicsStepIndex;
+	}
+	m_tPhysDeltaRemainder = umath::max(m_tPhysDeltaRemainder, 0.0);
+	m_lastPhysicsSubstepCount = numSteps;
+}
+
+float Game::GetPhysicsInterpolationFactor() const
+{
+	if(m_physicsTimeStep <= 0.0)
+		return 1.f;
+	// On the client, time also progresses between ticks
+	auto t = m_tPhysDeltaRemainder + umath::max(m_tCur - m_tLastPhysicsStep, 0.0);
+	return static_cast<float>(umath::clamp(t / m_physicsTimeStep, 0.0, 1.0));
+}
+
 void Game::SetGameFlags(GameFlags flags) { m_flags = flags; }
 Game::GameFlags Game::GetGameFlags() const { return m_flags; }
 
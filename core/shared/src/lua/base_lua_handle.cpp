@@ -14,6 +14,19 @@ void pragma::BaseLuaHandle::InvalidateHandle() { m_handle = {}; }
 void pragma::BaseLuaHandle::SetLuaObject(const luabind::object &o) { m_luaObj = o; }
 lua_State *pragma::BaseLuaHandle::GetLuaState() const { return m_luaObj.interpreter(); }
 void pragma::BaseLuaHandle::CallLuaMethod(const std::string &name) { CallLuaMethod<void>(name); }
+luabind::object pragma::BaseLuaHandle::ResolveLuaMethod(luabind::object o, const char *name)
+{
+	auto *l = o.interpreter();
+	if(!l)
+		return {};
+	luabind::object method = o[name];
+	if(!method)
+		return {};
+	method.push(l);
+	auto isLuaFunction = (lua_iscfunction(l, -1) == 0);
+	Lua::Pop(l, 1);
+	return isLuaFunction ? method : luabind::object {};
+}
 void pragma::BaseLuaHandle::PushLuaObject()
 {
 	auto *l = m_luaObj.interpreter();
@@ -465,6 +465,19 @@ static std::pair<bool, std::optional<std::vector<uint64_t>>> bvh_intersection_te
 		return std::pair<bool, std::optional<std::vector<uint64_t>>> {res, {}};
 	return std::pair<bool, std::optional<std::vector<uint64_t>>> {res, std::move(info.primitives)};
 }
+static Lua::tb<void> bvh_intersection_test_batch(lua_State *l, const pragma::BaseBvhComponent &bvhC, const std::vector<pragma::BvhRay> &rays)
+{
+	std::vector<std::optional<pragma::BvhHitInfo>> hits;
+	bvhC.IntersectionTestBatch(rays, hits);
+	auto t = luabind::newtable(l);
+	for(size_t i = 0; i < hits.size(); ++i) {
+		if(hits[i])
+			t[i + 1] = *hits[i];
+		else
+			t[i + 1] = false;
+	}
+	return t;
+}
 
 DEFINE_OSTREAM_OPERATOR_NAMESPACE_ALIAS(pragma, BaseEntityComponent);
 DEFINE_OSTREAM_OPERATOR_NAMESPACE_ALIAS(util, Path);
@@ -831,6 +844,32 @@ void pragma::lua::register_entity_component_classes(luabind::module_ &mod)
 		  std::cout << "Lua Overhead: " << (dt / 1'000'000.0) << "ms" << std::endl;
 	  });
 	defBvh.def("IntersectionTest", static_cast<std::optional<pragma::BvhHitInfo> (pragma::BaseBvhComponent::*)(const Vector3 &, const Vector3 &, float, float) const>(&pragma::BaseBvhComponent::IntersectionTest));
+	defBvh.def(
+	  "IntersectionTestBatch", +[](lua_State *l, const pragma::BaseBvhComponent &bvhC, const std::vector<Vector3> &origins, const std::vector<Vector3> &dirs, float minDist, float maxDist) -> Lua::tb<void> {
+		  if(origins.size() != dirs.size()) {
+			  Lua::Error(l, "Number of ray origins (" + std::to_string(origins.size()) + ") does not match number of ray directions (" + std::to_string(dirs.size()) + ")!");
+			  return luabind::newtable(l);
+		  }
+		  std::vector<pragma::BvhRay> rays;
+		  rays.reserve(origins.size());
+		  for(size_t i = 0; i < origins.size(); ++i)
+			  rays.push_back({origins[i], dirs[i], minDist, maxDist});
+		  return bvh_intersection_test_batch(l, bvhC, rays);
+	  });
+	defBvh.def(
+	  "IntersectionTestBatch",
+	  +[](lua_State *l, const pragma::BaseBvhComponent &bvhC, const std::vector<Vector3> &origins, const std::vector<Vector3> &dirs, const std::vector<float> &minDists, const std::vector<float> &maxDists) -> Lua::tb<void> {
+		  if(origins.size() != dirs.size() || origins.size() != minDists.size() || origins.size() != maxDists.size()) {
+			  Lua::Error(l,
+			    "Number of ray origins (" + std::to_string(origins.size()) + "), directions (" + std::to_string(dirs.size()) + "), min distances (" + std::to_string(minDists.size()) + ") and max distances (" + std::to_string(maxDists.size()) + ") have to match!");
+			  return luabind::newtable(l);
+		  }
+		  std::vector<pragma::BvhRay> rays;
+		  rays.reserve(origins.size());
+		  for(size_t i = 0; i < origins.size(); ++i)
+			  rays.push_back({origins[i], dirs[i], minDists[i], maxDists[i]});
+		  return bvh_intersection_test_batch(l, bvhC, rays);
+	  });
 	defBvh.def("IntersectionTestAabb", static_cast<bool (pragma::BaseBvhComponent::*)(const Vector3 &, const Vector3 &) const>(&pragma::BaseBvhComponent::IntersectionTestAabb));
 	defBvh.def(
 	  "IntersectionTestAabb", +[](const pragma::BaseBvhComponent &bvhC, const Vector3 &min, const Vector3 &max, BvhIntersectionFlags flags) -> std::pair<bool, std::optional<std::vector<uint64_t>>> {
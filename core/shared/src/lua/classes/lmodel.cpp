@@ -813,6 +813,7 @@ void Lua::Model::register_class(lua_State *l, luabind::class_<::Model> &classDef
 	                           .def("GetBoneWeight", static_cast<float (pragma::animation::Animation::*)(uint32_t) const>(&pragma::animation::Animation::GetBoneWeight))
 	                           .def("GetBoneWeights", &Lua::Animation::GetBoneWeights)
 	                           .def("ClearFrames", static_cast<void (*)(lua_State *, pragma::animation::Animation &)>([](lua_State *l, pragma::animation::Animation &anim) { anim.GetFrames().clear(); }))
+	                           .def("Compress", &pragma::animation::Animation::Compress)
 	                           /*.def("GetBoneId",static_cast<void(*)(lua_State*,pragma::animation::Animation&,uint32_t)>([](lua_State *l,pragma::animation::Animation &anim,uint32_t idx) {
 			auto &boneList = anim.GetBoneList();
 			if(idx >= boneList.size())
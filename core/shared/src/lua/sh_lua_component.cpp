@@ -29,6 +29,7 @@
 #include <sharedutils/datastream.h>
 #include <sharedutils/netpacket.hpp>
 #include <udm.hpp>
+#include <luabind/detail/class_rep.hpp>
 
 #define ENABLE_CUSTOM_SETTER_GETTER 0
 
@@ -37,6 +38,8 @@ struct ClassMembers {
 	ClassMembers(const luabind::object &classObject) : classObject {classObject} {}
 	luabind::object classObject;
 	std::vector<BaseLuaBaseEntityComponent::MemberInfo> memberDeclarations;
+	// Size of the values of all value members in the member data block of a component of this class
+	uint32_t valueDataSize = 0;
 };
 static std::unordered_map<lua_State *, std::vector<std::shared_ptr<ClassMembers>>> s_classMembers {};
 static std::vector<std::shared_ptr<ClassMembers>> &get_class_member_list(lua_State *l)
@@ -56,6 +59,78 @@ static ClassMembers *get_class_member_declarations(const luabind::object &classO
 	return (itClass != it->second.end()) ? itClass->get() : nullptr;
 }
 
+struct ClassMethods {
+	ClassMethods(const luabind::object &classObject) : classObject {classObject} {}
+	luabind::object classObject;
+	std::vector<luabind::object> methods;
+	// Only set for the methods of a component that shadows some of the class methods in its instance table
+	std::shared_ptr<ClassMethods> classMethods = nullptr;
+	// Set to false if the class has been re-registered, in which case the methods have to be resolved again
+	bool valid = true;
+	bool IsValid() const { return valid && (!classMethods || classMethods->valid); }
+};
+static std::unordered_map<lua_State *, std::vector<std::shared_ptr<ClassMethods>>> s_classMethods {};
+static constexpr std::array<const char *, 7> g_classMethodNames = {"Initialize", "OnTick", "OnRemove", "OnEntitySpawn", "OnEntityPostSpawn", "OnAttachedToEntity", "OnDetachedToEntity"};
+
+template<typename T>
+static constexpr bool is_dynamic_member_value_type()
+{
+	return is_valid_component_property_type_v<T> && udm::is_udm_type<T>();
+}
+// Class-declared members are also transmitted over the network, so they're restricted to types that can be written to a packet directly
+template<typename T>
+static constexpr bool is_class_member_value_type()
+{
+	return is_dynamic_member_value_type<T>() && (std::is_same_v<T, udm::String> || std::is_trivially_copyable_v<T>);
+}
+static bool get_member_value_layout(udm::Type type, size_t &outSize, size_t &outAlignment)
+{
+	auto valid = false;
+	udm::visit(type, [&outSize, &outAlignment, &valid](auto tag) {
+		using T = typename decltype(tag)::type;
+		if constexpr(is_dynamic_member_value_type<T>()) {
+			static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+			outSize = sizeof(T);
+			outAlignment = alignof(T);
+			valid = true;
+		}
+	});
+	return valid;
+}
+static udm::Type get_class_member_value_type(ents::EntityMemberType memberType, BaseLuaBaseEntityComponent::MemberFlags memberFlags)
+{
+	if((memberFlags & BaseLuaBaseEntityComponent::MemberFlags::PropertyBit) != BaseLuaBaseEntityComponent::MemberFlags::None || memberType == ents::EntityMemberType::Element || !ents::is_udm_member_type(memberType))
+		return udm::Type::Invalid;
+	auto type = ents::member_type_to_udm_type(memberType);
+	auto valid = false;
+	udm::visit(type, [&valid](auto tag) {
+		using T = typename decltype(tag)::type;
+		valid = is_class_member_value_type<T>();
+	});
+	return valid ? type : udm::Type::Invalid;
+}
+template<typename T>
+static bool string_to_member_value(const std::string &value, T &outValue)
+{
+	if constexpr(std::is_same_v<T, udm::String>)
+		outValue = value;
+	else if constexpr(std::is_same_v<T, udm::Boolean>)
+		outValue = util::to_boolean(value);
+	else if constexpr(std::is_floating_point_v<T>)
+		outValue = static_cast<T>(util::to_float(value));
+	else if constexpr(std::is_integral_v<T>)
+		outValue = static_cast<T>(util::to_int(value));
+	else if constexpr(std::is_same_v<T, udm::EulerAngles>)
+		outValue = EulerAngles {value};
+	else if constexpr(std::is_same_v<T, udm::Vector3>)
+		outValue = uvec::create(value);
+	else if constexpr(std::is_same_v<T, udm::Vector2> || std::is_same_v<T, udm::Vector4> || std::is_same_v<T, udm::Quaternion>)
+		ustring::string_to_array<Float, Double>(value, reinterpret_cast<float *>(&outValue), atof, sizeof(T) / sizeof(float));
+	else
+		return false;
+	return true;
+}
+
 static std::string get_member_name(const std::string &funcName)
 {
 	if(funcName.empty())
@@ -182,6 +257,18 @@ const pragma::BaseLuaBaseEntityComponent::MemberInfo *BaseLuaBaseEntityComponent
 	return &m_classMembers->memberDeclarations[memberInfo.userIndex];
 }
 
+template<typename T>
+static void set_class_member_value(BaseLuaBaseEntityComponent &component, const BaseLuaBaseEntityComponent::MemberInfo &memberInfo, const T &value)
+{
+	if(memberInfo.valueType == udm::Type::Invalid) {
+		component.GetLuaObject()[memberInfo.memberVariableName] = value;
+		return;
+	}
+	auto *ptr = component.GetClassMemberValue(memberInfo);
+	if(ptr)
+		*static_cast<T *>(ptr) = value;
+}
+
 template<typename T>
 static void init_pose_type_meta_data(const ComponentMemberInfo &memberInfo, BaseLuaBaseEntityComponent &component, BaseLuaBaseEntityComponent::MemberInfo &info)
 {
@@ -328,7 +415,11 @@ std::optional<ComponentMemberInfo> pragma::lua::get_component_member_info(lua_St
 				else {
 					constexpr auto getter = +[](const ComponentMemberInfo &memberInfo, BaseLuaBaseEntityComponent &component, T &value) {
 						auto *info = component.GetLuaMemberInfo(const_cast<ComponentMemberInfo &>(memberInfo));
-						if constexpr(Lua::is_native_type<T>)
+						if(info->valueType != udm::Type::Invalid) {
+							auto *ptr = component.GetClassMemberValue(*info);
+							value = ptr ? *static_cast<T *>(ptr) : T {};
+						}
+						else if constexpr(Lua::is_native_type<T>)
 							value = luabind::object_cast_nothrow<T>(component.GetLuaObject()[info->memberVariableName], T {});
 						else {
 							auto *v = luabind::object_cast_nothrow<T *>(component.GetLuaObject()[info->memberVariableName], static_cast<T *>(nullptr));
@@ -342,7 +433,7 @@ std::optional<ComponentMemberInfo> pragma::lua::get_component_member_info(lua_St
 						return create_component_member_info<BaseLuaBaseEntityComponent, T,
 						  [](const ComponentMemberInfo &memberInfo, BaseLuaBaseEntityComponent &component, const T &value) {
 							  auto *info = component.GetLuaMemberInfo(const_cast<ComponentMemberInfo &>(memberInfo));
-							  component.GetLuaObject()[info->memberVariableName] = value;
+							  set_class_member_value(component, *info, value);
 						  },
 						  getter>(std::move(tmpMemberName));
 					}
@@ -351,7 +442,7 @@ std::optional<ComponentMemberInfo> pragma::lua::get_component_member_info(lua_St
 						  [](const ComponentMemberInfo &memberInfo, BaseLuaBaseEntityComponent &component, const T &value) {
 							  auto *info = component.GetLuaMemberInfo(const_cast<ComponentMemberInfo &>(memberInfo));
 							  auto &o = component.GetLuaObject();
-							  o[info->memberVariableName] = value;
+							  set_class_member_value(component, *info, value);
 							  if(info->onChange)
 								  info->onChange(o);
 						  },
@@ -507,9 +598,20 @@ BaseLuaBaseEntityComponent::MemberIndex BaseLuaBaseEntityComponent::RegisterMemb
 		if(componentMemberInfo.has_value()) {
 			(*it)->memberDeclarations.push_back({functionName, memberName, get_component_member_name_hash(memberName), memberVarName, memberType, initialValue, memberFlags, std::move(onChange), std::move(componentMemberInfo)});
 			itMember = (*it)->memberDeclarations.end() - 1;
+
+			// Value members are appended to the member data layout of the class
+			size_t size = 0;
+			size_t alignment = 1;
+			auto valueType = get_class_member_value_type(memberType, memberFlags);
+			if(valueType != udm::Type::Invalid && get_member_value_layout(valueType, size, alignment)) {
+				itMember->valueType = valueType;
+				itMember->valueOffset = static_cast<uint32_t>((((*it)->valueDataSize + alignment - 1) / alignment) * alignment);
+				(*it)->valueDataSize = itMember->valueOffset + static_cast<uint32_t>(size);
+			}
 		}
 	}
 	auto idx = itMember - (*it)->memberDeclarations.begin();
+	auto isValueMember = (itMember != (*it)->memberDeclarations.end() && itMember->valueType != udm::Type::Invalid);
 
 	auto oEnumValues = attributes["enumValues"];
 	if(oEnumValues) {
@@ -523,6 +625,29 @@ BaseLuaBaseEntityComponent::MemberIndex BaseLuaBaseEntityComponent::RegisterMemb
 		}
 	}
 
+	if(isValueMember) {
+		// Value members are not stored in the Lua object, so existing scripts accessing 'self.m_<name>' directly are routed to the
+		// member data block through a luabind property in the class table. Like the getter, reading the property returns a copy.
+		auto strIdx = std::to_string(idx);
+		std::string err;
+		if(Lua::PushLuaFunctionFromString(l, "function(self) return self:GetClassMemberValue(" + strIdx + ") end", "EntityComponentMemberGetter", err) == false)
+			Con::cwar << "Unable to register member variable '" << memberVarName << "' for entity component: " << err << Con::endl;
+		else if(Lua::PushLuaFunctionFromString(l, "function(self,value) self:SetClassMemberValue(" + strIdx + ",value) end", "EntityComponentMemberSetter", err) == false) {
+			Lua::Pop(l, 1);
+			Con::cwar << "Unable to register member variable '" << memberVarName << "' for entity component: " << err << Con::endl;
+		}
+		else {
+			lua_pushcclosure(l, &luabind::detail::property_tag, 2); /* 1 */
+			auto idxProperty = Lua::GetStackTop(l);
+			oClass.push(l); /* 2 */
+			auto idxObject = Lua::GetStackTop(l);
+			Lua::PushString(l, memberVarName); /* 3 */
+			Lua::PushValue(l, idxProperty);    /* 4 */
+			Lua::SetTableValue(l, idxObject);  /* 2 */
+			Lua::Pop(l, 2);                    /* 0 */
+		}
+	}
+
 	static_assert(umath::to_integral(pragma::ents::EntityMemberType::VersionIndex) == 0);
 	std::string getterName = "Get";
 	auto bProperty = (memberFlags & MemberFlags::PropertyBit) != MemberFlags::None;
@@ -536,7 +661,9 @@ BaseLuaBaseEntityComponent::MemberIndex BaseLuaBaseEntityComponent::RegisterMemb
 		}
 		else
 #endif
-		{
+		if(isValueMember)
+			getter = "function(self) return self:GetClassMemberValue(" + std::to_string(idx) + ")";
+		else {
 			getter = "function(self) return self." + memberVarName;
 			if(memberType == ents::EntityMemberType::Entity)
 				getter += ":GetEntity()";
@@ -612,11 +739,15 @@ BaseLuaBaseEntityComponent::MemberIndex BaseLuaBaseEntityComponent::RegisterMemb
 			}
 			else if(memberType == ents::EntityMemberType::MultiEntity)
 				throw std::runtime_error {"Not yet implemented!"};
-			setter += "self." + memberVarName;
-			if(bProperty)
-				setter += ":Set(value)";
-			else
-				setter += " = value";
+			if(isValueMember)
+				setter += "self:SetClassMemberValue(" + std::to_string(idx) + ",value)";
+			else {
+				setter += "self." + memberVarName;
+				if(bProperty)
+					setter += ":Set(value)";
+				else
+					setter += " = value";
+			}
 		}
 		if((memberFlags & MemberFlags::TransmitOnChange) == MemberFlags::TransmitOnChange || (memberFlags & MemberFlags::OutputBit) != MemberFlags::None || itMember->onChange)
 			setter += " self:OnMemberValueChanged(" + std::to_string(idx) + ")";
@@ -668,16 +799,114 @@ std::vector<BaseLuaBaseEntityComponent::MemberInfo> *BaseLuaBaseEntityComponent:
 }
 void BaseLuaBaseEntityComponent::ClearMembers(lua_State *l)
 {
+	InvalidateClassMethods(l);
 	auto it = s_classMembers.find(l);
 	if(it == s_classMembers.end())
 		return;
 	s_classMembers.erase(it);
 }
+void BaseLuaBaseEntityComponent::InvalidateClassMethods(lua_State *l)
+{
+	auto it = s_classMethods.find(l);
+	if(it == s_classMethods.end())
+		return;
+	// Components that still hold a reference will re-resolve their methods on the next call
+	for(auto &classMethods : it->second)
+		classMethods->valid = false;
+	s_classMethods.erase(it);
+}
+void BaseLuaBaseEntityComponent::ResolveClassMethods()
+{
+	// If the methods have been invalidated, the component still belongs to the same class object, even if a new class has
+	// been registered under the same name since
+	luabind::object classObject;
+	if(m_classMethods)
+		classObject = m_classMethods->classObject;
+	else {
+		auto *o = GetClassObject();
+		if(o)
+			classObject = *o;
+	}
+	m_classMethods = nullptr;
+	auto *l = GetLuaState();
+	if(!classObject || !l)
+		return;
+	auto &classMethods = s_classMethods[l];
+	auto it = std::find_if(classMethods.begin(), classMethods.end(), [&classObject](const std::shared_ptr<ClassMethods> &methods) { return classObject == methods->classObject; });
+	if(it != classMethods.end()) {
+		m_classMethods = *it;
+		return;
+	}
+	// The methods are looked up in the class table, so the result doesn't depend on the instance that
+	// happens to be resolved first. Methods shadowed by an instance are handled by ResolveInstanceMethods.
+	auto methods = std::make_shared<ClassMethods>(classObject);
+	methods->methods.reserve(g_classMethodNames.size());
+	for(auto *name : g_classMethodNames)
+		methods->methods.push_back(ResolveLuaMethod(classObject, name));
+	classMethods.push_back(methods);
+	m_classMethods = methods;
+}
+static bool is_same_method(const luabind::object &a, const luabind::object &b)
+{
+	auto aValid = static_cast<bool>(a);
+	if(aValid != static_cast<bool>(b))
+		return false;
+	return !aValid || a == b;
+}
+void BaseLuaBaseEntityComponent::ResolveInstanceMethods()
+{
+	if(!m_classMethods)
+		return;
+	auto classMethods = m_classMethods->classMethods ? m_classMethods->classMethods : m_classMethods;
+	m_classMethods = classMethods;
+	std::shared_ptr<ClassMethods> instanceMethods = nullptr;
+	for(auto i = decltype(g_classMethodNames.size()) {0u}; i < g_classMethodNames.size(); ++i) {
+		auto *name = g_classMethodNames[i];
+		auto method = ResolveLuaMethod(GetLuaObject(), name);
+		if(is_same_method(method, classMethods->methods[i]))
+			continue;
+		// The method may have been added to the class after the methods were resolved, in which case all instances benefit from the update
+		auto classMethod = ResolveLuaMethod(classMethods->classObject, name);
+		if(is_same_method(method, classMethod)) {
+			classMethods->methods[i] = classMethod;
+			continue;
+		}
+		if(!instanceMethods) {
+			instanceMethods = std::make_shared<ClassMethods>(*classMethods);
+			instanceMethods->classMethods = classMethods;
+		}
+		instanceMethods->methods[i] = method;
+	}
+	if(instanceMethods)
+		m_classMethods = instanceMethods;
+}
+const luabind::object &BaseLuaBaseEntityComponent::GetClassMethod(LuaMethod method)
+{
+	if(!m_classMethods || !m_classMethods->IsValid()) [[unlikely]] {
+		ResolveClassMethods();
+		ResolveInstanceMethods();
+		if(!m_classMethods) {
+			static luabind::object nilMethod {};
+			return nilMethod;
+		}
+	}
+	return m_classMethods->methods[umath::to_integral(method)];
+}
+template<typename... TARGS>
+void BaseLuaBaseEntityComponent::CallClassMethod(LuaMethod method, TARGS... args)
+{
+	CallResolvedLuaMethod<void, TARGS...>(GetClassMethod(method), std::forward<TARGS>(args)...);
+}
 void BaseLuaBaseEntityComponent::SetupLua(const luabind::object &o) { SetLuaObject(o); }
 
 ////////////////
 
 BaseLuaBaseEntityComponent::BaseLuaBaseEntityComponent(BaseEntity &ent) : pragma::BaseEntityComponent(ent) {}
+BaseLuaBaseEntityComponent::~BaseLuaBaseEntityComponent()
+{
+	ClearDynamicMemberValues();
+	ClearClassMemberValues();
+}
 
 void BaseLuaBaseEntityComponent::InitializeLuaObject(lua_State *l) {}
 
@@ -719,7 +948,9 @@ void BaseLuaBaseEntityComponent::Initialize()
 	if(m_networkedMemberInfo != nullptr)
 		m_networkedMemberInfo->netEvSetMember = SetupNetEvent("set_member_value");
 
-	CallLuaMethod("Initialize");
+	CallClassMethod(LuaMethod::Initialize);
+	// Initialize may have assigned methods to the instance table
+	ResolveInstanceMethods();
 
 	PushLuaObject(); /* 1 */
 	auto t = Lua::GetStackTop(l);
@@ -730,13 +961,15 @@ void BaseLuaBaseEntityComponent::Initialize()
 	Lua::Pop(l, 2); /* 0 */
 
 	auto &ent = GetEntity();
-	CallLuaMethod("OnAttachedToEntity");
+	CallClassMethod(LuaMethod::OnAttachedToEntity);
 	pragma::BaseEntityComponent::Initialize();
 }
 
 void BaseLuaBaseEntityComponent::InitializeMembers(const std::vector<BaseLuaBaseEntityComponent::MemberInfo> &members)
 {
+	ClearClassMemberValues();
 	m_members = members;
+	InitializeClassMemberValues();
 	auto &o = GetLuaObject();
 	auto *l = o.interpreter();
 	o.push(l); /* 1 */
@@ -745,16 +978,19 @@ void BaseLuaBaseEntityComponent::InitializeMembers(const std::vector<BaseLuaBase
 	auto idxMember = 0u;
 	for(auto &member : members) {
 		auto &memberVarName = member.memberVariableName;
-		Lua::PushString(l, memberVarName); /* 2 */
+		// Value members live in the member data block and are accessed through their getter, setter and the m_<name> class property
+		if(member.valueType == udm::Type::Invalid) {
+			Lua::PushString(l, memberVarName); /* 2 */
 
-		if((member.flags & MemberFlags::PropertyBit) != MemberFlags::None)
-			Lua::PushNewAnyProperty(l, detail::member_type_to_util_type(member.type), member.initialValue); /* 3 */
-		else
-			Lua::PushAny(l, detail::member_type_to_util_type(member.type), member.initialValue); /* 3 */
-		if(Lua::IsNil(l, -1) && ents::is_udm_member_type(member.type))
-			Con::cwar << "Invalid member type '" << magic_enum::enum_name(member.type) << "' for member '" << member.functionName << "' of entity component '" << GetEntity().GetNetworkState()->GetGameState()->GetEntityComponentManager().GetComponentInfo(GetComponentId())->name
-			          << "'! Ignoring..." << Con::endl;
-		Lua::SetTableValue(l, t); /* 1 */
+			if((member.flags & MemberFlags::PropertyBit) != MemberFlags::None)
+				Lua::PushNewAnyProperty(l, detail::member_type_to_util_type(member.type), member.initialValue); /* 3 */
+			else
+				Lua::PushAny(l, detail::member_type_to_util_type(member.type), member.initialValue); /* 3 */
+			if(Lua::IsNil(l, -1) && ents::is_udm_member_type(member.type))
+				Con::cwar << "Invalid member type '" << magic_enum::enum_name(member.type) << "' for member '" << member.functionName << "' of entity component '" << GetEntity().GetNetworkState()->GetGameState()->GetEntityComponentManager().GetComponentInfo(GetComponentId())->name
+				          << "'! Ignoring..." << Con::endl;
+			Lua::SetTableValue(l, t); /* 1 */
+		}
 
 		if((member.flags & MemberFlags::NetworkedBit) != MemberFlags::None) {
 			if(m_networkedMemberInfo == nullptr)
@@ -795,8 +1031,7 @@ void BaseLuaBaseEntityComponent::InitializeMembers(const std::vector<BaseLuaBase
 			auto it = m_memberNameToIndex.find(kvData.key);
 			if(it == m_memberNameToIndex.end())
 				return util::EventReply::Unhandled;
-			auto &member = m_members.at(it->second);
-			SetMemberValue(member, string_to_any(*GetEntity().GetNetworkState()->GetGameState(), kvData.value, detail::member_type_to_util_type(member.type)));
+			SetMemberValue(m_members.at(it->second), kvData.value);
 			return util::EventReply::Handled;
 		});
 	}
@@ -809,29 +1044,23 @@ void BaseLuaBaseEntityComponent::InitializeMembers(const std::vector<BaseLuaBase
 			auto it = m_memberNameToIndex.find(input);
 			if(it == m_memberNameToIndex.end())
 				return util::EventReply::Unhandled;
-			auto &member = m_members.at(it->second);
-			SetMemberValue(member, string_to_any(*GetEntity().GetNetworkState()->GetGameState(), ioData.data, detail::member_type_to_util_type(member.type)));
+			SetMemberValue(m_members.at(it->second), ioData.data);
 			return util::EventReply::Handled;
 		});
 	}
 }
 
-void BaseLuaBaseEntityComponent::OnTick(double dt) { CallLuaMethod<void, double>("OnTick", dt); }
+void BaseLuaBaseEntityComponent::OnTick(double dt) { CallClassMethod<double>(LuaMethod::OnTick, dt); }
 
 void BaseLuaBaseEntityComponent::InitializeMember(const MemberInfo &memberInfo) {}
 
-std::any *BaseLuaBaseEntityComponent::GetDynamicMemberValue(ComponentMemberIndex memberIndex, ents::EntityMemberType &outType)
+void *BaseLuaBaseEntityComponent::GetDynamicMemberValue(ComponentMemberIndex memberIndex, udm::Type &outType)
 {
-	auto *info = GetMemberInfo(memberIndex);
+	auto *info = GetDynamicMemberInfo(memberIndex);
 	if(!info)
 		return nullptr;
-	if(memberIndex < m_dynamicMemberStartOffset)
-		return nullptr;
-	memberIndex -= m_dynamicMemberStartOffset;
-	if(memberIndex >= m_dynamicMembers.size() || !m_dynamicMembers[memberIndex].enabled)
-		return nullptr;
 	outType = info->type;
-	return &m_dynamicMembers[memberIndex].value;
+	return m_memberData.get() + info->offset;
 }
 
 void BaseLuaBaseEntityComponent::ReserveMembers(uint32_t count) { DynamicMemberRegister::ReserveMembers(count); }
@@ -860,11 +1089,134 @@ ComponentMemberIndex BaseLuaBaseEntityComponent::RegisterMember(const ComponentM
 		info->onChange = onChange;
 	return idx;
 }
-void BaseLuaBaseEntityComponent::ClearMembers() { DynamicMemberRegister::ClearMembers(); }
+void BaseLuaBaseEntityComponent::ClearMembers()
+{
+	DynamicMemberRegister::ClearMembers();
+	ClearDynamicMemberValues();
+}
 void BaseLuaBaseEntityComponent::RemoveMember(ComponentMemberIndex idx) { DynamicMemberRegister::RemoveMember(idx); }
 void BaseLuaBaseEntityComponent::RemoveMember(const std::string &name) { DynamicMemberRegister::RemoveMember(name); }
 void BaseLuaBaseEntityComponent::UpdateMemberNameMap() { DynamicMemberRegister::UpdateMemberNameMap(); }
 
+static void destroy_dynamic_member_value(udm::Type type, std::byte *ptr)
+{
+	udm::visit(type, [ptr](auto tag) {
+		using T = typename decltype(tag)::type;
+		if constexpr(is_dynamic_member_value_type<T>())
+			std::destroy_at(reinterpret_cast<T *>(ptr));
+	});
+}
+static void move_member_value(udm::Type type, std::byte *src, std::byte *dst)
+{
+	udm::visit(type, [src, dst](auto tag) {
+		using T = typename decltype(tag)::type;
+		if constexpr(is_dynamic_member_value_type<T>()) {
+			new(dst) T {std::move(*reinterpret_cast<T *>(src))};
+			std::destroy_at(reinterpret_cast<T *>(src));
+		}
+	});
+}
+uint32_t BaseLuaBaseEntityComponent::AllocateDynamicMemberValue(udm::Type type)
+{
+	size_t size = 0;
+	size_t alignment = 1;
+	get_member_value_layout(type, size, alignment);
+	auto offset = static_cast<uint32_t>(((m_memberDataSize + alignment - 1) / alignment) * alignment);
+	ReserveMemberData(offset + static_cast<uint32_t>(size));
+	m_memberDataSize = offset + static_cast<uint32_t>(size);
+	return offset;
+}
+void BaseLuaBaseEntityComponent::ReserveMemberData(uint32_t size, uint32_t dynamicMemberShift)
+{
+	if(size <= m_memberDataCapacity && dynamicMemberShift == 0)
+		return;
+	auto newCapacity = std::max(size, m_memberDataCapacity * 2);
+	auto newData = std::unique_ptr<std::byte[]> {new std::byte[newCapacity]};
+	// Class member offsets don't change. Dynamic members are moved by dynamicMemberShift, which is only non-zero if they
+	// were registered before the class members were initialized.
+	for(auto &member : m_members) {
+		if(member.valueType != udm::Type::Invalid && member.valueOffset < m_classMemberDataSize)
+			move_member_value(member.valueType, m_memberData.get() + member.valueOffset, newData.get() + member.valueOffset);
+	}
+	for(auto &member : m_dynamicMembers) {
+		if(!member.enabled)
+			continue;
+		move_member_value(member.type, m_memberData.get() + member.offset, newData.get() + member.offset + dynamicMemberShift);
+		member.offset += dynamicMemberShift;
+	}
+	m_memberData = std::move(newData);
+	m_memberDataCapacity = newCapacity;
+}
+void BaseLuaBaseEntityComponent::InitializeClassMemberValues()
+{
+	uint32_t classDataSize = 0;
+	for(auto &member : m_members) {
+		size_t size = 0;
+		size_t alignment = 1;
+		if(member.valueType != udm::Type::Invalid && get_member_value_layout(member.valueType, size, alignment))
+			classDataSize = std::max(classDataSize, member.valueOffset + static_cast<uint32_t>(size));
+	}
+	if(classDataSize == 0)
+		return;
+	// Dynamic members are appended to the class members, so any that already exist have to be moved behind them
+	uint32_t dynamicMemberShift = 0;
+	if(m_memberDataSize > 0) {
+		constexpr uint32_t maxAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+		dynamicMemberShift = ((classDataSize + maxAlignment - 1) / maxAlignment) * maxAlignment;
+	}
+	auto dataSize = (m_memberDataSize > 0) ? (m_memberDataSize + dynamicMemberShift) : classDataSize;
+	ReserveMemberData(dataSize, dynamicMemberShift);
+	m_memberDataSize = dataSize;
+	for(auto &member : m_members) {
+		if(member.valueType == udm::Type::Invalid)
+			continue;
+		auto *ptr = m_memberData.get() + member.valueOffset;
+		udm::visit(member.valueType, [&member, ptr](auto tag) {
+			using T = typename decltype(tag)::type;
+			if constexpr(is_class_member_value_type<T>()) {
+				auto *initialValue = std::any_cast<T>(&member.initialValue);
+				new(ptr) T {initialValue ? *initialValue : T {}};
+			}
+		});
+	}
+	m_classMemberDataSize = classDataSize;
+}
+void BaseLuaBaseEntityComponent::ClearClassMemberValues()
+{
+	if(m_classMemberDataSize == 0)
+		return;
+	for(auto &member : m_members) {
+		if(member.valueType != udm::Type::Invalid && member.valueOffset < m_classMemberDataSize)
+			destroy_dynamic_member_value(member.valueType, m_memberData.get() + member.valueOffset);
+	}
+	m_classMemberDataSize = 0;
+	if(std::find_if(m_dynamicMembers.begin(), m_dynamicMembers.end(), [](const DynamicMemberInfo &member) { return member.enabled; }) == m_dynamicMembers.end())
+		m_memberDataSize = 0;
+}
+void BaseLuaBaseEntityComponent::ClearDynamicMemberValues()
+{
+	for(auto &member : m_dynamicMembers) {
+		if(member.enabled)
+			destroy_dynamic_member_value(member.type, m_memberData.get() + member.offset);
+	}
+	m_dynamicMembers.clear();
+	m_memberDataSize = m_classMemberDataSize;
+}
+void *BaseLuaBaseEntityComponent::GetClassMemberValue(const MemberInfo &memberInfo)
+{
+	if(memberInfo.valueType == udm::Type::Invalid || memberInfo.valueOffset >= m_classMemberDataSize)
+		return nullptr;
+	return m_memberData.get() + memberInfo.valueOffset;
+}
+void *BaseLuaBaseEntityComponent::GetClassMemberValue(MemberIndex memberIndex, udm::Type &outType)
+{
+	if(memberIndex >= m_members.size())
+		return nullptr;
+	auto &member = m_members[memberIndex];
+	outType = member.valueType;
+	return GetClassMemberValue(member);
+}
+
 void BaseLuaBaseEntityComponent::OnMemberRegistered(const ComponentMemberInfo &memberInfo, ComponentMemberIndex index)
 {
 	DynamicMemberRegister::OnMemberRegistered(memberInfo, index);
@@ -876,16 +1228,25 @@ void BaseLuaBaseEntityComponent::OnMemberRegistered(const ComponentMemberInfo &m
 		index -= m_dynamicMemberStartOffset;
 		if(index >= m_dynamicMembers.size())
 			m_dynamicMembers.resize(index + 1);
+		if(m_dynamicMembers[index].enabled) {
+			destroy_dynamic_member_value(m_dynamicMembers[index].type, m_memberData.get() + m_dynamicMembers[index].offset);
+			m_dynamicMembers[index].enabled = false;
+		}
+		auto type = pragma::ents::member_type_to_udm_type(memberInfo.type);
+		auto offset = AllocateDynamicMemberValue(type);
 		auto &dynMember = m_dynamicMembers[index];
-		dynMember.enabled = true;
-		udm::visit(pragma::ents::member_type_to_udm_type(memberInfo.type), [&memberInfo, &dynMember](auto tag) {
+		auto *ptr = m_memberData.get() + offset;
+		udm::visit(type, [&memberInfo, &dynMember, ptr](auto tag) {
 			using T = typename decltype(tag)::type;
-			if constexpr(is_valid_component_property_type_v<T>) {
+			if constexpr(is_dynamic_member_value_type<T>()) {
 				T def;
 				memberInfo.GetDefault<T>(def);
-				dynMember.value = def;
+				new(ptr) T {std::move(def)};
+				dynMember.enabled = true;
 			}
 		});
+		dynMember.type = type;
+		dynMember.offset = offset;
 	}
 }
 void BaseLuaBaseEntityComponent::OnMemberRemoved(const ComponentMemberInfo &memberInfo, ComponentMemberIndex index)
@@ -894,10 +1255,14 @@ void BaseLuaBaseEntityComponent::OnMemberRemoved(const ComponentMemberInfo &memb
 	if(index < m_dynamicMemberStartOffset)
 		return;
 	index -= m_dynamicMemberStartOffset;
-	if(index >= m_dynamicMembers.size())
+	if(index >= m_dynamicMembers.size() || !m_dynamicMembers[index].enabled)
 		return;
-	m_dynamicMembers[index].enabled = false;
-	m_dynamicMembers[index].value = {};
+	auto &dynMember = m_dynamicMembers[index];
+	destroy_dynamic_member_value(dynMember.type, m_memberData.get() + dynMember.offset);
+	dynMember.enabled = false;
+	// The space of removed values is only reclaimed once all dynamic members have been removed
+	if(std::find_if(m_dynamicMembers.begin(), m_dynamicMembers.end(), [](const DynamicMemberInfo &member) { return member.enabled; }) == m_dynamicMembers.end())
+		m_memberDataSize = m_classMemberDataSize;
 }
 
 std::optional<ComponentMemberIndex> BaseLuaBaseEntityComponent::DoGetMemberIndex(const std::string &name) const
@@ -1000,16 +1365,28 @@ util::EventReply BaseLuaBaseEntityComponent::HandleEvent(ComponentEventId eventI
 void BaseLuaBaseEntityComponent::OnAttached(BaseEntity &ent)
 {
 	pragma::BaseEntityComponent::OnAttached(ent);
-	CallLuaMethod("OnAttachedToEntity");
+	CallClassMethod(LuaMethod::OnAttachedToEntity);
 }
 void BaseLuaBaseEntityComponent::OnDetached(BaseEntity &ent)
 {
 	pragma::BaseEntityComponent::OnDetached(ent);
-	CallLuaMethod("OnDetachedToEntity");
+	CallClassMethod(LuaMethod::OnDetachedToEntity);
 }
 
 std::any BaseLuaBaseEntityComponent::GetMemberValue(const MemberInfo &memberInfo) const
 {
+	if(memberInfo.valueType != udm::Type::Invalid) {
+		auto *ptr = GetClassMemberValue(memberInfo);
+		if(!ptr)
+			return {};
+		return udm::visit(memberInfo.valueType, [ptr](auto tag) -> std::any {
+			using T = typename decltype(tag)::type;
+			if constexpr(is_class_member_value_type<T>())
+				return *static_cast<const T *>(ptr);
+			else
+				return {};
+		});
+	}
 	auto &o = const_cast<BaseLuaBaseEntityComponent *>(this)->GetLuaObject();
 	auto *l = o.interpreter();
 	o.push(l); /* 1 */
@@ -1029,6 +1406,22 @@ std::any BaseLuaBaseEntityComponent::GetMemberValue(const MemberInfo &memberInfo
 void BaseLuaBaseEntityComponent::SetMemberValue(const MemberInfo &memberInfo, const std::any &value) const
 {
 	auto &o = const_cast<BaseLuaBaseEntityComponent *>(this)->GetLuaObject();
+	if(memberInfo.valueType != udm::Type::Invalid) {
+		auto *ptr = const_cast<BaseLuaBaseEntityComponent *>(this)->GetClassMemberValue(memberInfo);
+		if(!ptr)
+			return;
+		udm::visit(memberInfo.valueType, [ptr, &value](auto tag) {
+			using T = typename decltype(tag)::type;
+			if constexpr(is_class_member_value_type<T>()) {
+				auto *v = std::any_cast<T>(&value);
+				if(v)
+					*static_cast<T *>(ptr) = *v;
+			}
+		});
+		if(memberInfo.onChange)
+			memberInfo.onChange(o);
+		return;
+	}
 	auto *l = o.interpreter();
 	o.push(l); /* 1 */
 	auto t = Lua::GetStackTop(l);
@@ -1047,6 +1440,68 @@ void BaseLuaBaseEntityComponent::SetMemberValue(const MemberInfo &memberInfo, co
 		memberInfo.onChange(o);
 }
 
+void BaseLuaBaseEntityComponent::SetMemberValue(const MemberInfo &memberInfo, const std::string &value)
+{
+	if(memberInfo.valueType == udm::Type::Invalid) {
+		SetMemberValue(memberInfo, string_to_any(*GetEntity().GetNetworkState()->GetGameState(), value, detail::member_type_to_util_type(memberInfo.type)));
+		return;
+	}
+	auto *ptr = GetClassMemberValue(memberInfo);
+	if(!ptr)
+		return;
+	udm::visit(memberInfo.valueType, [ptr, &value](auto tag) {
+		using T = typename decltype(tag)::type;
+		if constexpr(is_class_member_value_type<T>())
+			string_to_member_value<T>(value, *static_cast<T *>(ptr));
+	});
+	if(memberInfo.onChange)
+		memberInfo.onChange(GetLuaObject());
+}
+
+void BaseLuaBaseEntityComponent::WriteMemberValue(NetPacket &packet, const MemberInfo &memberInfo) const
+{
+	if(memberInfo.valueType == udm::Type::Invalid) {
+		Lua::WriteAny(packet, detail::member_type_to_util_type(memberInfo.type), GetMemberValue(memberInfo));
+		return;
+	}
+	auto *ptr = GetClassMemberValue(memberInfo);
+	udm::visit(memberInfo.valueType, [&packet, ptr](auto tag) {
+		using T = typename decltype(tag)::type;
+		if constexpr(is_class_member_value_type<T>()) {
+			auto value = ptr ? *static_cast<const T *>(ptr) : T {};
+			if constexpr(std::is_same_v<T, udm::String>)
+				packet->WriteString(value);
+			else
+				packet->Write<T>(value);
+		}
+	});
+}
+
+void BaseLuaBaseEntityComponent::ReadMemberValue(NetPacket &packet, const MemberInfo &memberInfo)
+{
+	if(memberInfo.valueType == udm::Type::Invalid) {
+		std::any value;
+		Lua::ReadAny(packet, detail::member_type_to_util_type(memberInfo.type), value);
+		SetMemberValue(memberInfo, value);
+		return;
+	}
+	auto *ptr = GetClassMemberValue(memberInfo);
+	udm::visit(memberInfo.valueType, [&packet, ptr](auto tag) {
+		using T = typename decltype(tag)::type;
+		if constexpr(is_class_member_value_type<T>()) {
+			T value;
+			if constexpr(std::is_same_v<T, udm::String>)
+				value = packet->ReadString();
+			else
+				value = packet->Read<T>();
+			if(ptr)
+				*static_cast<T *>(ptr) = std::move(value);
+		}
+	});
+	if(memberInfo.onChange)
+		memberInfo.onChange(GetLuaObject());
+}
+
 static void write_value(udm::LinkedPropertyWrapperArg udm, const std::any &value, util::VarType type)
 {
 	switch(type) {
@@ -1290,8 +1745,20 @@ void BaseLuaBaseEntityComponent::Save(udm::LinkedPropertyWrapperArg udm)
 	for(auto &member : m_members) {
 		if((member.flags & MemberFlags::StoreBit) == MemberFlags::None)
 			continue;
+		auto udmMember = udm["members." + member.functionName];
+		if(member.valueType != udm::Type::Invalid) {
+			auto *ptr = GetClassMemberValue(member);
+			if(!ptr)
+				continue;
+			udm::visit(member.valueType, [&udmMember, ptr](auto tag) {
+				using T = typename decltype(tag)::type;
+				if constexpr(is_class_member_value_type<T>())
+					udmMember = *static_cast<const T *>(ptr);
+			});
+			continue;
+		}
 		auto value = GetMemberValue(member);
-		write_value(udm["members." + member.functionName], value, detail::member_type_to_util_type(member.type));
+		write_value(udmMember, value, detail::member_type_to_util_type(member.type));
 	}
 	CallLuaMethod<void, udm::LinkedPropertyWrapper>("Save", udm);
 }
@@ -1302,12 +1769,25 @@ void BaseLuaBaseEntityComponent::Load(udm::LinkedPropertyWrapperArg udm, uint32_
 	for(auto &member : m_members) {
 		if((member.flags & MemberFlags::StoreBit) == MemberFlags::None)
 			continue;
-		std::any value;
 		auto udmMember = udm["members." + member.functionName];
-		if(udmMember) {
-			read_value(game, udmMember, value, detail::member_type_to_util_type(member.type));
-			SetMemberValue(member, value);
+		if(!udmMember)
+			continue;
+		if(member.valueType != udm::Type::Invalid) {
+			auto *ptr = GetClassMemberValue(member);
+			if(!ptr)
+				continue;
+			udm::visit(member.valueType, [&udmMember, ptr](auto tag) {
+				using T = typename decltype(tag)::type;
+				if constexpr(is_class_member_value_type<T>())
+					udmMember(*static_cast<T *>(ptr));
+			});
+			if(member.onChange)
+				member.onChange(GetLuaObject());
+			continue;
 		}
+		std::any value;
+		read_value(game, udmMember, value, detail::member_type_to_util_type(member.type));
+		SetMemberValue(member, value);
 	}
 	CallLuaMethod<void, udm::LinkedPropertyWrapper, uint32_t>("Load", udm, version);
 }
@@ -1316,19 +1796,19 @@ uint32_t BaseLuaBaseEntityComponent::GetVersion() const { return m_version; }
 void BaseLuaBaseEntityComponent::OnEntitySpawn()
 {
 	BaseEntityComponent::OnEntitySpawn();
-	CallLuaMethod("OnEntitySpawn");
+	CallClassMethod(LuaMethod::OnEntitySpawn);
 }
 
 void BaseLuaBaseEntityComponent::OnEntityPostSpawn()
 {
 	BaseEntityComponent::OnEntityPostSpawn();
-	CallLuaMethod("OnEntityPostSpawn");
+	CallClassMethod(LuaMethod::OnEntityPostSpawn);
 }
 
 void BaseLuaBaseEntityComponent::OnRemove()
 {
 	pragma::BaseEntityComponent::OnRemove();
-	CallLuaMethod("OnRemove");
+	CallClassMethod(LuaMethod::OnRemove);
 }
 
 void BaseLuaBaseEntityComponent::SetNetworked(bool b) { m_bShouldTransmitNetData = b; }
@@ -1616,6 +2096,58 @@ void Lua::register_base_entity_component(luabind::module_ &modEnts)
 		    return hNewComponent;
 	    }));
 	classDef.def("OnMemberValueChanged", &pragma::BaseLuaBaseEntityComponent::OnMemberValueChanged);
+	// Used by the generated getters and setters of class-declared value members, as well as the 'm_<name>' properties.
+	// Values are returned by copy, so modifying a returned vector or matrix in place (e.g. 'self:GetPos():Set(...)')
+	// does not change the member; the setter has to be called with the modified value instead.
+	classDef.def(
+	  "GetClassMemberValue", +[](lua_State *l, pragma::BaseLuaBaseEntityComponent &hComponent, uint32_t memberIndex) -> std::optional<Lua::udm_type> {
+		  udm::Type type;
+		  auto *ptr = hComponent.GetClassMemberValue(memberIndex, type);
+		  if(!ptr)
+			  return {};
+		  return udm::visit(type, [l, ptr](auto tag) -> std::optional<Lua::udm_type> {
+			  using T = typename decltype(tag)::type;
+			  if constexpr(is_class_member_value_type<T>())
+				  return Lua::udm_type {luabind::object {l, *static_cast<T *>(ptr)}};
+			  else
+				  return {};
+		  });
+	  });
+	classDef.def(
+	  "SetClassMemberValue", +[](lua_State *l, pragma::BaseLuaBaseEntityComponent &hComponent, uint32_t memberIndex, Lua::udm_type value) {
+		  udm::Type type;
+		  auto *ptr = hComponent.GetClassMemberValue(memberIndex, type);
+		  if(!ptr)
+			  return;
+		  auto valid = true;
+		  udm::visit(type, [&value, ptr, &valid](auto tag) {
+			  using T = typename decltype(tag)::type;
+			  if constexpr(is_class_member_value_type<T>()) {
+				  if constexpr(Lua::is_native_type<T>) {
+					  auto luaType = luabind::type(value);
+					  if constexpr(std::is_same_v<T, udm::Boolean>)
+						  valid = (luaType == LUA_TBOOLEAN);
+					  else if constexpr(std::is_same_v<T, udm::String>)
+						  valid = (luaType == LUA_TSTRING);
+					  else
+						  valid = (luaType == LUA_TNUMBER);
+					  if(valid)
+						  *static_cast<T *>(ptr) = luabind::object_cast_nothrow<T>(value, T {});
+				  }
+				  else {
+					  auto *v = luabind::object_cast_nothrow<T *>(value, static_cast<T *>(nullptr));
+					  if(v)
+						  *static_cast<T *>(ptr) = *v;
+					  else
+						  valid = false;
+				  }
+			  }
+		  });
+		  if(!valid) {
+			  Con::cwar << "Attempted to assign value of type '" << lua_typename(l, luabind::type(value)) << "' to member " << memberIndex << " of type '" << magic_enum::enum_name(type) << "' of entity component '"
+			            << hComponent.GetEntity().GetNetworkState()->GetGameState()->GetEntityComponentManager().GetComponentInfo(hComponent.GetComponentId())->name << "'! Ignoring..." << Con::endl;
+		  }
+	  });
 	classDef.scope[luabind::def(
 	  "RegisterMember", +[](lua_State *l, const Lua::classObject &o, const std::string &memberName, pragma::ents::EntityMemberType memberType, Lua::udm_type oDefault, const Lua::map<std::string, void> &attributes, pragma::BaseLuaBaseEntityComponent::MemberFlags memberFlags) {
 		  auto anyInitialValue = Lua::GetAnyValue(l, detail::member_type_to_util_type(memberType), 4);
@@ -1686,13 +2218,14 @@ BaseLuaBaseEntityComponent::MemberInfo::MemberInfo(const std::string &functionNa
 
 BaseLuaBaseEntityComponent::MemberInfo::MemberInfo(const MemberInfo &other)
     : functionName(other.functionName), memberName(other.memberName), memberNameHash(other.memberNameHash), memberVariableName(other.memberVariableName), type(other.type), initialValue(other.initialValue), flags(other.flags), onChange(other.onChange),
-      transformCompositeInfo(other.transformCompositeInfo ? std::make_unique<TransformCompositeInfo>(*other.transformCompositeInfo) : nullptr), componentMemberInfo(other.componentMemberInfo)
+      transformCompositeInfo(other.transformCompositeInfo ? std::make_unique<TransformCompositeInfo>(*other.transformCompositeInfo) : nullptr), componentMemberInfo(other.componentMemberInfo), valueType(other.valueType), valueOffset(other.valueOffset)
 {
 }
 
 BaseLuaBaseEntityComponent::MemberInfo::MemberInfo(MemberInfo &&other)
     : functionName(std::move(other.functionName)), memberName(std::move(other.memberName)), memberNameHash(std::move(other.memberNameHash)), memberVariableName(std::move(other.memberVariableName)), type(std::move(other.type)), initialValue(std::move(other.initialValue)),
-      flags(std::move(other.flags)), onChange(std::move(other.onChange)), transformCompositeInfo(std::move(other.transformCompositeInfo)), componentMemberInfo(std::move(other.componentMemberInfo))
+      flags(std::move(other.flags)), onChange(std::move(other.onChange)), transformCompositeInfo(std::move(other.transformCompositeInfo)), componentMemberInfo(std::move(other.componentMemberInfo)),
+      valueType(other.valueType), valueOffset(other.valueOffset)
 {
 	other.transformCompositeInfo = nullptr;
 }
@@ -1709,6 +2242,8 @@ BaseLuaBaseEntityComponent::MemberInfo &BaseLuaBaseEntityComponent::MemberInfo::
 	onChange = other.onChange;
 	transformCompositeInfo = other.transformCompositeInfo ? std::make_unique<TransformCompositeInfo>(*other.transformCompositeInfo) : nullptr;
 	componentMemberInfo = other.componentMemberInfo;
+	valueType = other.valueType;
+	valueOffset = other.valueOffset;
 	return *this;
 }
 
@@ -1724,6 +2259,8 @@ BaseLuaBaseEntityComponent::MemberInfo &BaseLuaBaseEntityComponent::MemberInfo::
 	onChange = std::move(other.onChange);
 	transformCompositeInfo = std::move(other.transformCompositeInfo);
 	componentMemberInfo = std::move(other.componentMemberInfo);
+	valueType = other.valueType;
+	valueOffset = other.valueOffset;
 	other.transformCompositeInfo = nullptr;
 	return *this;
 }
@@ -7,6 +7,7 @@
 
 #include "stdafx_shared.h"
 #include "pragma/lua/classes/ldef_entity.h"
+#include "pragma/lua/sh_lua_component.hpp"
 
 void LuaEntityManager::RegisterEntity(std::string className, luabind::object &o, const std::vector<pragma::ComponentId> &components)
 {
@@ -40,6 +41,7 @@ void LuaEntityManager::RegisterComponent(std::string className, luabind::object
 {
 	ustring::to_lower(className);
 	m_components[className] = o;
+	pragma::BaseLuaBaseEntityComponent::InvalidateClassMethods(o.interpreter());
 }
 luabind::object *LuaEntityManager::GetComponentClassObject(std::string className)
 {
@@ -8,10 +8,12 @@
 #include "stdafx_shared.h"
 #include "pragma/model/animation/animation.hpp"
 #include "pragma/model/animation/activities.h"
+#include "pragma/model/animation/compressed_animation.hpp"
 #include "pragma/logging.hpp"
 #include <udm.hpp>
 #include <mathutil/umath.h>
 #include <panima/skeleton.hpp>
+#include <sharedutils/scope_guard.h>
 
 decltype(pragma::animation::Animation::s_activityEnumRegister) pragma::animation::Animation::s_activityEnumRegister;
 decltype(pragma::animation::Animation::s_eventEnumRegister) pragma::animation::Animation::s_eventEnumRegister;
@@ -56,33 +58,38 @@ static void copy_safe(const T0 &src, T1 &dst, uint32_t srcStartIndex, uint32_t d
 	memcpy(memPtr1, memPtr0, count * sizeof(typename T0::value_type));
 }
 
-template<typename T>
-static void apply_channel_animation_values(udm::LinkedPropertyWrapper &udmProp, float fps, const std::vector<float> &times, const std::vector<std::shared_ptr<Frame>> &frames, const std::function<void(Frame &, const T &)> &applyValue)
+template<typename T, class TTrack>
+static void apply_channel_animation_values(udm::LinkedPropertyWrapper &udmProp, float fps, const std::vector<float> &times, uint32_t numFrames, TTrack &track)
 {
 	if(fps == 0.f)
 		return;
 	std::vector<T> values;
 	udmProp(values);
+
+	// Expand the track to one value per frame, then re-compress it once all channel values have been applied
+	std::vector<T> frameValues;
+	frameValues.resize(numFrames);
+	for(auto i = decltype(numFrames) {0u}; i < numFrames; ++i)
+		frameValues[i] = track.GetValue(i);
 	auto stepTime = 1.f / fps;
 	for(auto i = decltype(times.size()) {0u}; i < times.size(); ++i) {
 		auto t = times[i];
-		auto frameEnd = umath::round(t * fps);
+		auto frameEnd = static_cast<int32_t>(umath::round(t * fps));
 		auto frameStart = frameEnd;
 		if(i > 0) {
 			auto tPrev = times[i - 1];
 			auto dt = t - tPrev;
-			auto nFrames = umath::round(dt / stepTime);
+			auto nFrames = static_cast<int32_t>(umath::round(dt / stepTime));
 			assert(nFrames > 0);
 			if(nFrames > 0)
 				frameStart = frameEnd - (nFrames - 1);
 		}
 		else if(i == 0 && times.size() == 1)
-			frameEnd = frames.size() - 1;
-		for(auto frameIdx = frameStart; frameIdx <= frameEnd; ++frameIdx) {
-			auto &frame = frames[frameIdx];
-			applyValue(*frame, values[i]);
-		}
+			frameEnd = static_cast<int32_t>(numFrames) - 1;
+		for(auto frameIdx = std::max(frameStart, 0); frameIdx <= frameEnd && frameIdx < static_cast<int32_t>(numFrames); ++frameIdx)
+			frameValues[frameIdx] = values[i];
 	}
+	track.Compress(frameValues);
 }
 
 bool pragma::animation::Animation::LoadFromAssetData(const udm::AssetData &data, std::string &outErr, const panima::Skeleton *optSkeleton, const Frame *optReference)
@@ -277,34 +284,38 @@ bool pragma::animation::Animation::LoadFromAssetData(const udm::AssetData &data,
 				}
 			}
 		}
+		Compress();
 	}
 	else {
-		auto numFrames = umath::round(duration * m_fps);
-		m_frames.resize(numFrames);
+		// Channel values are written to the compressed curves directly, without creating any frames
+		auto numFrames = static_cast<uint32_t>(std::max(static_cast<int32_t>(umath::round(duration * m_fps)), 0));
+		auto compressed = std::make_shared<CompressedAnimation>(numFrames, static_cast<uint32_t>(m_boneIds.size()));
 		auto isGesture = umath::is_flag_set(m_flags, FAnim::Gesture);
-		for(auto &frame : m_frames) {
-			frame = Frame::Create(m_boneIds.size());
-			if(isGesture || !optReference || !optSkeleton)
-				continue;
+		if(!isGesture && optReference && optSkeleton) {
 			auto &refBones = optSkeleton->GetBones();
 			for(auto boneIdx = decltype(refBones.size()) {0u}; boneIdx < refBones.size(); ++boneIdx) {
 				auto it = m_boneIdMap.find(boneIdx);
 				if(it == m_boneIdMap.end())
 					continue;
-				auto localBoneId = it->second;
+				auto *tracks = compressed->GetBoneTracks(it->second);
+				if(!tracks)
+					continue;
 				auto *pos = optReference->GetBonePosition(boneIdx);
 				if(pos)
-					frame->SetBonePosition(localBoneId, *pos);
+					tracks->position.SetConstant(*pos);
 
 				auto *rot = optReference->GetBoneOrientation(boneIdx);
 				if(rot)
-					frame->SetBoneOrientation(localBoneId, *rot);
+					tracks->rotation.SetConstant(*rot);
 
 				auto *scale = optReference->GetBoneScale(boneIdx);
-				if(scale)
-					frame->SetBoneScale(localBoneId, *scale);
+				if(scale) {
+					tracks->scale.SetConstant(*scale);
+					compressed->SetHasScales(true);
+				}
 			}
 		}
+		std::vector<Vector2> moveOffsets;
 		auto udmChannels = udm["channels"];
 		for(auto udmChannel : udmChannels) {
 			uint16_t nodeId = 0;
@@ -322,27 +333,35 @@ bool pragma::animation::Animation::LoadFromAssetData(const udm::AssetData &data,
 			udmChannel["property"](property);
 
 			auto udmValues = udmChannel["values"];
-			if(property == "position") {
-				apply_channel_animation_values<Vector3>(udmValues, m_fps, times, m_frames, [localBoneId](Frame &frame, const Vector3 &val) { frame.SetBonePosition(localBoneId, val); });
-			}
-			else if(property == "rotation") {
-				apply_channel_animation_values<Quat>(udmValues, m_fps, times, m_frames, [localBoneId](Frame &frame, const Quat &val) { frame.SetBoneOrientation(localBoneId, val); });
-			}
-			else if(property == "scale") {
-				apply_channel_animation_values<Vector3>(udmValues, m_fps, times, m_frames, [localBoneId](Frame &frame, const Vector3 &val) { frame.SetBoneScale(localBoneId, val); });
-			}
-			else if(property == "offset") {
+			if(property == "offset") {
 				// TODO
-				std::vector<Vector2> moveOffsets;
-				udmValues(moveOffsets);
+				std::vector<Vector2> channelMoveOffsets;
+				udmValues(channelMoveOffsets);
+				moveOffsets.resize(numFrames);
 				for(auto i = decltype(times.size()) {0u}; i < times.size(); ++i) {
 					auto t = times[i];
-					auto frameIdx = umath::round(t * m_fps);
-					auto &frame = m_frames[frameIdx];
-					frame->SetMoveOffset(moveOffsets[i]);
+					auto frameIdx = static_cast<int32_t>(umath::round(t * m_fps));
+					if(frameIdx >= 0 && frameIdx < static_cast<int32_t>(numFrames))
+						moveOffsets[frameIdx] = channelMoveOffsets[i];
 				}
+				continue;
+			}
+			auto *tracks = compressed->GetBoneTracks(localBoneId);
+			if(!tracks)
+				continue;
+			if(property == "position")
+				apply_channel_animation_values<Vector3>(udmValues, m_fps, times, numFrames, tracks->position);
+			else if(property == "rotation")
+				apply_channel_animation_values<Quat>(udmValues, m_fps, times, numFrames, tracks->rotation);
+			else if(property == "scale") {
+				apply_channel_animation_values<Vector3>(udmValues, m_fps, times, numFrames, tracks->scale);
+				compressed->SetHasScales(true);
 			}
 		}
+		if(!moveOffsets.empty())
+			compressed->SetMoveOffsets(std::move(moveOffsets));
+		m_frames.clear();
+		std::atomic_store(&m_compressed, std::shared_ptr<const CompressedAnimation> {compressed});
 	}
 
 	auto udmEvents = udm["events"];
@@ -488,6 +507,9 @@ static void write_channel_value(std::shared_ptr<Channel> &channel, uint32_t numF
 
 bool pragma::animation::Animation::Save(udm::AssetDataArg outData, std::string &outErr, const Frame *optReference)
 {
+	// Saving requires the frames, they're only decompressed temporarily and the animation stays compressed
+	util::ScopeGuard sgCompressed {[this, compressed = GetCompressedData()]() { RestoreCompressedData(compressed); }};
+	DecompressFrames();
 	outData.SetAssetType(PANIM_IDENTIFIER);
 	outData.SetAssetVersion(PANIM_VERSION);
 	auto udm = *outData;
@@ -725,6 +747,8 @@ bool pragma::animation::Animation::Save(udm::AssetDataArg outData, std::string &
 
 bool pragma::animation::Animation::SaveLegacy(VFilePtrReal &f)
 {
+	util::ScopeGuard sgCompressed {[this, compressed = GetCompressedData()]() { RestoreCompressedData(compressed); }};
+	DecompressFrames();
 	f->Write<uint32_t>(PRAGMA_ANIMATION_VERSION);
 	auto offsetToLen = f->Tell();
 	f->Write<uint64_t>(0);
@@ -849,6 +873,8 @@ pragma::animation::Animation::Animation(const Animation &other, ShareMode share)
 	m_fadeIn = (other.m_fadeIn != nullptr) ? std::make_unique<float>(*other.m_fadeIn) : nullptr;
 	m_fadeOut = (other.m_fadeOut != nullptr) ? std::make_unique<float>(*other.m_fadeOut) : nullptr;
 
+	// The compressed data is immutable and can always be shared. Only one of the representations exists at a time.
+	m_compressed = other.GetCompressedData();
 	if((share & ShareMode::Frames) != ShareMode::None)
 		m_frames = other.m_frames;
 	else {
@@ -869,14 +895,19 @@ pragma::animation::Animation::Animation(const Animation &other, ShareMode share)
 		}
 	}
 #ifdef _MSC_VER
-	static_assert(sizeof(Animation) == 312, "Update this function when making changes to this class!");
+	static_assert(sizeof(Animation) == 328, "Update this function when making changes to this class!");
 #endif
 }
 
-void pragma::animation::Animation::Reverse() { std::reverse(m_frames.begin(), m_frames.end()); }
+void pragma::animation::Animation::Reverse()
+{
+	DecompressFrames();
+	std::reverse(m_frames.begin(), m_frames.end());
+}
 
 void pragma::animation::Animation::Rotate(const panima::Skeleton &skeleton, const Quat &rot)
 {
+	DecompressFrames();
 	uvec::rotate(&m_renderBounds.first, rot);
 	uvec::rotate(&m_renderBounds.second, rot);
 	for(auto &frame : m_frames)
@@ -884,6 +915,7 @@ void pragma::animation::Animation::Rotate(const panima::Skeleton &skeleton, cons
 }
 void pragma::animation::Animation::Translate(const panima::Skeleton &skeleton, const Vector3 &t)
 {
+	DecompressFrames();
 	m_renderBounds.first += t;
 	m_renderBounds.second += t;
 	for(auto &frame : m_frames)
@@ -892,6 +924,7 @@ void pragma::animation::Animation::Translate(const panima::Skeleton &skeleton, c
 
 void pragma::animation::Animation::Scale(const Vector3 &scale)
 {
+	DecompressFrames();
 	m_renderBounds.first *= scale;
 	m_renderBounds.second *= scale;
 	for(auto &frame : m_frames)
@@ -911,7 +944,9 @@ int32_t pragma::animation::Animation::LookupBone(uint32_t boneId) const
 void pragma::animation::Animation::CalcRenderBounds(Model &mdl)
 {
 	m_renderBounds = {{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()}, {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()}};
-	for(auto &frame : m_frames) {
+	auto numFrames = GetFrameCount();
+	for(auto i = decltype(numFrames) {0u}; i < numFrames; ++i) {
+		auto frame = ReadFrame(i);
 		auto frameBounds = frame->CalcRenderBounds(*this, mdl);
 		for(uint8_t j = 0; j < 3; ++j) {
 			if(frameBounds.first[j] < m_renderBounds.first[j])
@@ -930,10 +965,42 @@ void pragma::animation::Animation::CalcRenderBounds(Model &mdl)
 const std::pair<Vector3, Vector3> &pragma::animation::Animation::GetRenderBounds() const { return m_renderBounds; }
 void pragma::animation::Animation::SetRenderBounds(const Vector3 &min, const Vector3 &max) { m_renderBounds = {min, max}; }
 
-std::vector<std::shared_ptr<Frame>> &pragma::animation::Animation::GetFrames() { return m_frames; }
+std::vector<std::shared_ptr<Frame>> &pragma::animation::Animation::GetFrames()
+{
+	DecompressFrames();
+	return m_frames;
+}
+
+std::shared_ptr<const pragma::animation::CompressedAnimation> pragma::animation::Animation::GetCompressedData() const { return std::atomic_load(&m_compressed); }
+void pragma::animation::Animation::Compress()
+{
+	if(GetCompressedData())
+		return;
+	std::atomic_store(&m_compressed, std::shared_ptr<const CompressedAnimation> {CompressedAnimation::Create(m_frames, GetBoneCount())});
+	m_frames.clear();
+}
+void pragma::animation::Animation::DecompressFrames()
+{
+	auto compressed = GetCompressedData();
+	if(!compressed)
+		return;
+	auto numFrames = compressed->GetFrameCount();
+	m_frames.resize(numFrames);
+	for(auto i = decltype(numFrames) {0u}; i < numFrames; ++i)
+		m_frames[i] = compressed->Decompress(i);
+	std::atomic_store(&m_compressed, std::shared_ptr<const CompressedAnimation> {});
+}
+void pragma::animation::Animation::RestoreCompressedData(const std::shared_ptr<const CompressedAnimation> &compressed)
+{
+	if(!compressed)
+		return;
+	m_frames.clear();
+	std::atomic_store(&m_compressed, compressed);
+}
 
 void pragma::animation::Animation::Localize(const panima::Skeleton &skeleton)
 {
+	DecompressFrames();
 	for(auto it = m_frames.begin(); it != m_frames.end(); ++it)
 		(*it)->Localize(*this, skeleton);
 }
@@ -982,7 +1049,8 @@ float pragma::animation::Animation::GetDuration() const
 {
 	if(m_fps == 0)
 		return 0.f;
-	return float(m_frames.size()) / float(m_fps);
+	auto compressed = GetCompressedData();
+	return float(compressed ? compressed->GetFrameCount() : m_frames.size()) / float(m_fps);
 }
 
 FAnim pragma::animation::Animation::GetFlags() const { return m_flags; }
@@ -1028,16 +1096,35 @@ void pragma::animation::Animation::ReserveBoneIds(uint32_t count)
 	m_boneIdMap.reserve(count);
 }
 
-void pragma::animation::Animation::AddFrame(std::shared_ptr<Frame> frame) { m_frames.push_back(frame); }
+void pragma::animation::Animation::AddFrame(std::shared_ptr<Frame> frame)
+{
+	DecompressFrames();
+	m_frames.push_back(frame);
+}
 
 std::shared_ptr<Frame> pragma::animation::Animation::GetFrame(unsigned int ID)
 {
+	DecompressFrames();
 	if(ID >= m_frames.size())
 		return nullptr;
 	return m_frames[ID];
 }
 
-unsigned int pragma::animation::Animation::GetFrameCount() { return CUInt32(m_frames.size()); }
+std::shared_ptr<const Frame> pragma::animation::Animation::ReadFrame(unsigned int ID) const
+{
+	auto compressed = GetCompressedData();
+	if(compressed)
+		return (ID < compressed->GetFrameCount()) ? compressed->Decompress(ID) : nullptr;
+	if(ID >= m_frames.size())
+		return nullptr;
+	return m_frames[ID];
+}
+
+unsigned int pragma::animation::Animation::GetFrameCount() const
+{
+	auto compressed = GetCompressedData();
+	return compressed ? compressed->GetFrameCount() : CUInt32(m_frames.size());
+}
 
 unsigned int pragma::animation::Animation::GetBoneCount() { return CUInt32(m_boneIds.size()); }
 
@@ -1083,15 +1170,18 @@ void pragma::animation::Animation::SetBoneWeight(uint32_t boneId, float weight)
 
 bool pragma::animation::Animation::operator==(const Animation &other) const
 {
-	if(m_frames.size() != other.m_frames.size() || m_boneWeights.size() != other.m_boneWeights.size() || static_cast<bool>(m_fadeIn) != static_cast<bool>(other.m_fadeIn) || static_cast<bool>(m_fadeOut) != static_cast<bool>(other.m_fadeOut) || m_events.size() != other.m_events.size())
+	auto numFrames = GetFrameCount();
+	if(numFrames != other.GetFrameCount() || m_boneWeights.size() != other.m_boneWeights.size() || static_cast<bool>(m_fadeIn) != static_cast<bool>(other.m_fadeIn) || static_cast<bool>(m_fadeOut) != static_cast<bool>(other.m_fadeOut) || m_events.size() != other.m_events.size())
 		return false;
 	if(m_fadeIn && umath::abs(*m_fadeIn - *other.m_fadeIn) > 0.001f)
 		return false;
 	if(m_fadeOut && umath::abs(*m_fadeOut - *other.m_fadeOut) > 0.001f)
 		return false;
-	for(auto i = decltype(m_frames.size()) {0u}; i < m_frames.size(); ++i) {
-		if(*m_frames[i] != *other.m_frames[i])
-			return false;
+	if(GetCompressedData() == nullptr || GetCompressedData() != other.GetCompressedData()) {
+		for(auto i = decltype(numFrames) {0u}; i < numFrames; ++i) {
+			if(*ReadFrame(i) != *other.ReadFrame(i))
+				return false;
+		}
 	}
 	for(auto &pair : m_events) {
 		if(other.m_events.find(pair.first) == other.m_events.end())
@@ -1102,7 +1192,7 @@ bool pragma::animation::Animation::operator==(const Animation &other) const
 			return false;
 	}
 #ifdef _MSC_VER
-	static_assert(sizeof(Animation) == 312, "Update this function when making changes to this class!");
+	static_assert(sizeof(Animation) == 328, "Update this function when making changes to this class!");
 #endif
 	return m_boneIds == other.m_boneIds && m_boneIdMap == other.m_boneIdMap && m_flags == other.m_flags && m_activity == other.m_activity && m_activityWeight == other.m_activityWeight && uvec::cmp(m_renderBounds.first, other.m_renderBounds.first)
 	  && uvec::cmp(m_renderBounds.second, other.m_renderBounds.second) && m_blendController == other.m_blendController;
@@ -0,0 +1,100 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/model/animation/bone_pose_blend.hpp"
+#include <panima/skeleton.hpp>
+#include <panima/bone.hpp>
+
+void pragma::animation::blend_bone_poses(const umath::Transform *src, const umath::Transform *dst, umath::Transform *out, const float *factors, size_t count)
+{
+	// 'out' may alias 'src' or 'dst', each pose is read completely before it is written
+	for(auto i = decltype(count) {0u}; i < count; ++i) {
+		auto t = factors[i];
+		auto &srcPos = src[i].GetOrigin();
+		auto &dstPos = dst[i].GetOrigin();
+		auto &srcRot = src[i].GetRotation();
+		auto &dstRot = dst[i].GetRotation();
+
+		// Slerp approximation (see "Approximating slerp", A. Kapoulkine); Max. error is around 1e-4 radians
+		auto ca = srcRot.x * dstRot.x + srcRot.y * dstRot.y + srcRot.z * dstRot.z + srcRot.w * dstRot.w;
+		auto d = std::fabs(ca);
+		auto a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+		auto b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+		auto k = a * (t - 0.5f) * (t - 0.5f) + b;
+		auto ot = t + t * (t - 0.5f) * (t - 1.f) * k;
+
+		auto lt = 1.f - ot;
+		auto rt = (ca < 0.f) ? -ot : ot; // Interpolate along the shortest path
+		Quat rot;
+		rot.x = srcRot.x * lt + dstRot.x * rt;
+		rot.y = srcRot.y * lt + dstRot.y * rt;
+		rot.z = srcRot.z * lt + dstRot.z * rt;
+		rot.w = srcRot.w * lt + dstRot.w * rt;
+		auto invLen = 1.f / std::sqrt(rot.x * rot.x + rot.y * rot.y + rot.z * rot.z + rot.w * rot.w);
+		rot.x *= invLen;
+		rot.y *= invLen;
+		rot.z *= invLen;
+		rot.w *= invLen;
+
+		auto pos = srcPos + (dstPos - srcPos) * t;
+		out[i].SetOrigin(pos);
+		out[i].SetRotation(rot);
+	}
+}
+void pragma::animation::blend_bone_scales(const Vector3 *src, const Vector3 *dst, Vector3 *out, const float *factors, size_t count)
+{
+	for(auto i = decltype(count) {0u}; i < count; ++i) {
+		auto t = factors[i];
+		out[i] = src[i] + (dst[i] - src[i]) * t;
+	}
+}
+
+void pragma::animation::FlatBoneHierarchy::Clear()
+{
+	m_skeleton = nullptr;
+	m_boneCount = 0;
+	m_entries.clear();
+}
+bool pragma::animation::FlatBoneHierarchy::IsValid(const panima::Skeleton &skeleton) const { return m_skeleton == &skeleton && m_boneCount == skeleton.GetBoneCount(); }
+void pragma::animation::FlatBoneHierarchy::Build(panima::Skeleton &skeleton)
+{
+	m_skeleton = &skeleton;
+	m_boneCount = skeleton.GetBoneCount();
+	m_entries.clear();
+	m_entries.reserve(m_boneCount);
+	std::function<void(const std::unordered_map<uint32_t, std::shared_ptr<panima::Bone>> &, uint32_t)> add;
+	add = [this, &add](const std::unordered_map<uint32_t, std::shared_ptr<panima::Bone>> &bones, uint32_t parentIndex) {
+		for(auto &pair : bones) {
+			auto idx = static_cast<uint32_t>(m_entries.size());
+			m_entries.push_back({pair.first, parentIndex});
+			add(pair.second->children, idx);
+			m_entries[idx].subtreeEnd = static_cast<uint32_t>(m_entries.size());
+		}
+	};
+	add(skeleton.GetRootBones(), INVALID_BONE);
+}
+void pragma::animation::FlatBoneHierarchy::ComputeGlobalTransforms(std::vector<umath::ScaledTransform> &transforms) const
+{
+	auto numEntries = static_cast<uint32_t>(m_entries.size());
+	for(auto i = decltype(numEntries) {0u}; i < numEntries;) {
+		auto &entry = m_entries[i];
+		if(entry.boneId >= transforms.size()) {
+			// Skip the entire sub-tree, its descendants can't be transformed without this bone
+			i = entry.subtreeEnd;
+			continue;
+		}
+		if(entry.parentIndex != INVALID_BONE) {
+			// Parents always precede their children, so the parent transform is already in entity space
+			auto &tParent = transforms[m_entries[entry.parentIndex].boneId];
+			auto &t = transforms[entry.boneId];
+			t.SetOrigin(t.GetOrigin() * tParent.GetScale());
+			t = tParent * t;
+		}
+		++i;
+	}
+}
@@ -0,0 +1,231 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/model/animation/compressed_animation.hpp"
+#include "pragma/model/animation/frame.h"
+
+static constexpr float QUANTIZATION_RANGE = static_cast<float>(std::numeric_limits<uint16_t>::max());
+static uint16_t quantize_unit(float v) { return static_cast<uint16_t>(std::lroundf(std::clamp(v, 0.f, 1.f) * QUANTIZATION_RANGE)); }
+static float dequantize_unit(uint16_t v) { return v / QUANTIZATION_RANGE; }
+
+// Smallest three encoding: The component with the largest absolute value is dropped and reconstructed from the other three,
+// which are guaranteed to lie within [-1/sqrt(2),1/sqrt(2)].
+static constexpr float SMALLEST_THREE_RANGE = 0.70710678f;
+static uint64_t encode_rotation(const Quat &rot)
+{
+	auto n = uquat::get_normal(rot);
+	std::array<float, 4> c {n.x, n.y, n.z, n.w};
+	uint32_t largest = 0;
+	for(uint32_t i = 1; i < c.size(); ++i) {
+		if(std::fabs(c[i]) > std::fabs(c[largest]))
+			largest = i;
+	}
+	auto sign = (c[largest] < 0.f) ? -1.f : 1.f;
+	uint64_t packed = largest;
+	uint32_t shift = 2;
+	for(uint32_t i = 0; i < c.size(); ++i) {
+		if(i == largest)
+			continue;
+		auto v = (c[i] * sign) / SMALLEST_THREE_RANGE * 0.5f + 0.5f;
+		packed |= static_cast<uint64_t>(quantize_unit(v)) << shift;
+		shift += 16;
+	}
+	return packed;
+}
+static Quat decode_rotation(uint64_t packed)
+{
+	auto largest = static_cast<uint32_t>(packed & 3u);
+	std::array<float, 4> c {};
+	auto sqrSum = 0.f;
+	uint32_t shift = 2;
+	for(uint32_t i = 0; i < c.size(); ++i) {
+		if(i == largest)
+			continue;
+		auto v = (dequantize_unit(static_cast<uint16_t>(packed >> shift)) - 0.5f) * 2.f * SMALLEST_THREE_RANGE;
+		c[i] = v;
+		sqrSum += v * v;
+		shift += 16;
+	}
+	c[largest] = std::sqrt(std::max(1.f - sqrSum, 0.f));
+	Quat rot;
+	rot.x = c[0];
+	rot.y = c[1];
+	rot.z = c[2];
+	rot.w = c[3];
+	return uquat::get_normal(rot);
+}
+
+void pragma::animation::CompressedAnimation::Vector3Track::SetConstant(const Vector3 &value)
+{
+	min = value;
+	extent = {};
+	keys.clear();
+}
+void pragma::animation::CompressedAnimation::Vector3Track::Compress(const std::vector<Vector3> &values)
+{
+	if(values.empty()) {
+		SetConstant({});
+		return;
+	}
+	Vector3 vmin {std::numeric_limits<float>::max()};
+	Vector3 vmax {std::numeric_limits<float>::lowest()};
+	for(auto &v : values) {
+		vmin = glm::min(vmin, v);
+		vmax = glm::max(vmax, v);
+	}
+	auto range = vmax - vmin;
+	if(range.x < CONSTANT_EPSILON && range.y < CONSTANT_EPSILON && range.z < CONSTANT_EPSILON) {
+		SetConstant(values.front());
+		return;
+	}
+	min = vmin;
+	extent = range;
+	keys.resize(values.size());
+	for(auto i = decltype(values.size()) {0u}; i < values.size(); ++i) {
+		for(uint8_t j = 0; j < 3; ++j)
+			keys[i][j] = (extent[j] > 0.f) ? quantize_unit((values[i][j] - min[j]) / extent[j]) : 0;
+	}
+}
+Vector3 pragma::animation::CompressedAnimation::Vector3Track::GetValue(uint32_t frameIdx) const
+{
+	if(IsConstant())
+		return min;
+	auto &key = keys[std::min<size_t>(frameIdx, keys.size() - 1)];
+	return {min.x + dequantize_unit(key[0]) * extent.x, min.y + dequantize_unit(key[1]) * extent.y, min.z + dequantize_unit(key[2]) * extent.z};
+}
+size_t pragma::animation::CompressedAnimation::Vector3Track::GetMemorySize() const { return keys.size() * sizeof(keys.front()); }
+
+void pragma::animation::CompressedAnimation::RotationTrack::SetConstant(const Quat &value)
+{
+	constant = value;
+	keys.clear();
+}
+void pragma::animation::CompressedAnimation::RotationTrack::Compress(const std::vector<Quat> &values)
+{
+	if(values.empty()) {
+		SetConstant(uquat::identity());
+		return;
+	}
+	auto &first = values.front();
+	auto isConstant = std::all_of(values.begin(), values.end(), [&first](const Quat &rot) { return std::fabs(glm::dot(rot, first)) > 1.f - CONSTANT_EPSILON; });
+	if(isConstant) {
+		SetConstant(first);
+		return;
+	}
+	keys.resize(values.size());
+	for(auto i = decltype(values.size()) {0u}; i < values.size(); ++i)
+		keys[i] = encode_rotation(values[i]);
+}
+Quat pragma::animation::CompressedAnimation::RotationTrack::GetValue(uint32_t frameIdx) const
+{
+	if(IsConstant())
+		return constant;
+	return decode_rotation(keys[std::min<size_t>(frameIdx, keys.size() - 1)]);
+}
+size_t pragma::animation::CompressedAnimation::RotationTrack::GetMemorySize() const { return keys.size() * sizeof(keys.front()); }
+
+std::shared_ptr<pragma::animation::CompressedAnimation> pragma::animation::CompressedAnimation::Create(const std::vector<std::shared_ptr<Frame>> &frames, uint32_t numBones)
+{
+	auto numFrames = static_cast<uint32_t>(frames.size());
+	auto anim = std::make_shared<CompressedAnimation>(numFrames, numBones);
+	std::vector<Vector3> positions;
+	std::vector<Quat> rotations;
+	std::vector<Vector3> scales;
+	positions.resize(numFrames);
+	rotations.resize(numFrames);
+	scales.resize(numFrames);
+	for(auto &frame : frames) {
+		if(frame->HasScaleTransforms())
+			anim->m_hasScales = true;
+	}
+	for(auto boneIdx = decltype(numBones) {0u}; boneIdx < numBones; ++boneIdx) {
+		for(auto frameIdx = decltype(numFrames) {0u}; frameIdx < numFrames; ++frameIdx) {
+			auto &frame = *frames[frameIdx];
+			auto *t = frame.GetBoneTransform(boneIdx);
+			positions[frameIdx] = t ? t->GetOrigin() : Vector3 {};
+			rotations[frameIdx] = t ? t->GetRotation() : uquat::identity();
+			auto *scale = frame.GetBoneScale(boneIdx);
+			scales[frameIdx] = scale ? *scale : Vector3 {1.f, 1.f, 1.f};
+		}
+		auto &tracks = anim->m_bones[boneIdx];
+		tracks.position.Compress(positions);
+		tracks.rotation.Compress(rotations);
+		tracks.scale.Compress(scales);
+	}
+
+	auto hasMoveOffsets = std::any_of(frames.begin(), frames.end(), [](const std::shared_ptr<Frame> &frame) { return frame->GetMoveOffset() != nullptr; });
+	if(hasMoveOffsets) {
+		std::vector<Vector2> moveOffsets;
+		moveOffsets.reserve(numFrames);
+		for(auto &frame : frames) {
+			auto *moveOffset = frame->GetMoveOffset();
+			moveOffsets.push_back(moveOffset ? *moveOffset : Vector2 {});
+		}
+		anim->SetMoveOffsets(std::move(moveOffsets));
+	}
+	return anim;
+}
+
+pragma::animation::CompressedAnimation::CompressedAnimation(uint32_t numFrames, uint32_t numBones) : m_numFrames {numFrames}
+{
+	m_bones.resize(numBones);
+	for(auto &tracks : m_bones)
+		tracks.scale.SetConstant({1.f, 1.f, 1.f});
+}
+pragma::animation::CompressedAnimation::BoneTracks *pragma::animation::CompressedAnimation::GetBoneTracks(uint32_t boneIdx) { return (boneIdx < m_bones.size()) ? &m_bones[boneIdx] : nullptr; }
+const pragma::animation::CompressedAnimation::BoneTracks *pragma::animation::CompressedAnimation::GetBoneTracks(uint32_t boneIdx) const { return const_cast<CompressedAnimation *>(this)->GetBoneTracks(boneIdx); }
+
+void pragma::animation::CompressedAnimation::SetMoveOffsets(std::vector<Vector2> &&moveOffsets)
+{
+	m_moveOffsets = std::move(moveOffsets);
+	if(!m_moveOffsets.empty())
+		m_moveOffsets.resize(m_numFrames);
+}
+std::optional<Vector2> pragma::animation::CompressedAnimation::GetMoveOffset(uint32_t frameIdx) const
+{
+	if(frameIdx >= m_moveOffsets.size())
+		return {};
+	return m_moveOffsets[frameIdx];
+}
+
+void pragma::animation::CompressedAnimation::SampleFrame(uint32_t frameIdx, std::vector<umath::Transform> &outPoses, std::vector<Vector3> &outScales) const
+{
+	auto numBones = m_bones.size();
+	outPoses.resize(numBones);
+	outScales.resize(numBones);
+	for(auto i = decltype(numBones) {0u}; i < numBones; ++i) {
+		auto &tracks = m_bones[i];
+		auto &pose = outPoses[i];
+		pose.SetOrigin(tracks.position.GetValue(frameIdx));
+		pose.SetRotation(tracks.rotation.GetValue(frameIdx));
+		outScales[i] = tracks.scale.GetValue(frameIdx);
+	}
+}
+std::shared_ptr<Frame> pragma::animation::CompressedAnimation::Decompress(uint32_t frameIdx) const
+{
+	auto numBones = static_cast<uint32_t>(m_bones.size());
+	auto frame = Frame::Create(numBones);
+	for(auto i = decltype(numBones) {0u}; i < numBones; ++i) {
+		auto &tracks = m_bones[i];
+		frame->SetBonePosition(i, tracks.position.GetValue(frameIdx));
+		frame->SetBoneOrientation(i, tracks.rotation.GetValue(frameIdx));
+		if(m_hasScales)
+			frame->SetBoneScale(i, tracks.scale.GetValue(frameIdx));
+	}
+	auto moveOffset = GetMoveOffset(frameIdx);
+	if(moveOffset)
+		frame->SetMoveOffset(*moveOffset);
+	return frame;
+}
+size_t pragma::animation::CompressedAnimation::GetMemorySize() const
+{
+	auto size = sizeof(*this) + m_bones.size() * sizeof(BoneTracks) + m_moveOffsets.size() * sizeof(Vector2);
+	for(auto &tracks : m_bones)
+		size += tracks.position.GetMemorySize() + tracks.rotation.GetMemorySize() + tracks.scale.GetMemorySize();
+	return size;
+}
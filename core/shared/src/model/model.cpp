@@ -411,7 +411,7 @@ bool Model::GetLocalBonePosition(uint32_t animId, uint32_t frameId, uint32_t bon
 	auto anim = GetAnimation(animId);
 	if(anim == nullptr)
 		return false;
-	auto frame = anim->GetFrame(frameId);
+	auto frame = anim->ReadFrame(frameId);
 	if(frame == nullptr)
 		return false;
 	auto *pos = frame->GetBonePosition(boneId);
@@ -190,6 +190,7 @@ void Model::Merge(const Model &other, MergeFlags flags)
 
 					// Fill up all bone transforms for this animation that
 					// might be missing but needed for the reference pose.
+					auto wasCompressed = (anim->GetCompressedData() != nullptr);
 					for(auto &frame : anim->GetFrames()) {
 						auto numBonesFrame = frame->GetBoneCount();
 						frame->SetBoneCount(numBones);
@@ -203,6 +204,8 @@ void Model::Merge(const Model &other, MergeFlags flags)
 								frame->SetBoneScale(boneId, *boneScale);
 						}
 					}
+					if(wasCompressed)
+						anim->Compress();
 				}
 			}
 		}
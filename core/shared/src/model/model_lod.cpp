@@ -0,0 +1,81 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/model/model.h"
+#include "pragma/model/modelmesh.h"
+#include <set>
+
+bool Model::GenerateLODs(const std::vector<float> &triangleRatios, const std::vector<float> &distances, float maxError, std::vector<float> *outAchievedRatios)
+{
+	if(triangleRatios.size() != distances.size())
+		return false;
+	// Mesh groups which are used by LOD 0. Ordered, so the generated mesh groups are always added in the same order.
+	std::set<uint32_t> baseGroupIds;
+	auto addBaseGroup = [this, &baseGroupIds](uint32_t groupId) {
+		if(groupId < m_meshGroups.size())
+			baseGroupIds.insert(groupId);
+	};
+	for(auto groupId : m_baseMeshes)
+		addBaseGroup(groupId);
+	for(auto &bg : m_bodyGroups) {
+		for(auto groupId : bg.meshGroups)
+			addBaseGroup(groupId);
+	}
+	if(baseGroupIds.empty())
+		return false;
+	uint64_t baseTriangleCount = 0;
+	for(auto groupId : baseGroupIds) {
+		for(auto &mesh : m_meshGroups[groupId]->GetMeshes()) {
+			for(auto &subMesh : mesh->GetSubMeshes())
+				baseTriangleCount += subMesh->GetTriangleCount();
+		}
+	}
+	if(outAchievedRatios) {
+		outAchievedRatios->clear();
+		outAchievedRatios->reserve(triangleRatios.size());
+	}
+
+	for(auto i = decltype(triangleRatios.size()) {0u}; i < triangleRatios.size(); ++i) {
+		auto lod = static_cast<uint32_t>(i + 1);
+		auto ratio = umath::clamp(triangleRatios[i], 0.f, 1.f);
+		std::unordered_map<uint32_t, uint32_t> replaceIds;
+		uint64_t lodTriangleCount = 0;
+		for(auto groupId : baseGroupIds) {
+			// Copy of the pointer, AddMeshGroup may re-allocate the mesh group list
+			auto srcGroup = m_meshGroups[groupId];
+			uint32_t lodGroupId;
+			auto lodGroup = AddMeshGroup(srcGroup->GetName() + "_lod" + std::to_string(lod), lodGroupId);
+			auto &lodMeshes = lodGroup->GetMeshes();
+			lodMeshes.clear();
+			for(auto &mesh : srcGroup->GetMeshes()) {
+				auto lodMesh = CreateMesh();
+				lodMesh->SetReferenceId(mesh->GetReferenceId());
+				for(auto &subMesh : mesh->GetSubMeshes()) {
+					auto targetTriangleCount = umath::max(static_cast<uint32_t>(subMesh->GetTriangleCount() * ratio), static_cast<uint32_t>(1));
+					auto lodSubMesh = subMesh->Simplify(targetTriangleCount, maxError);
+					// Meshes which can't be simplified (e.g. lines) are shared with LOD 0
+					if(lodSubMesh == nullptr)
+						lodSubMesh = subMesh;
+					lodTriangleCount += lodSubMesh->GetTriangleCount();
+					lodMesh->AddSubMesh(lodSubMesh);
+				}
+				lodMesh->Update(ModelUpdateFlags::All);
+				lodMeshes.push_back(lodMesh);
+			}
+			replaceIds[groupId] = lodGroupId;
+		}
+		auto *lodInfo = AddLODInfo(lod, distances[i], replaceIds);
+		// AddLODInfo keeps existing replacements for the same mesh groups
+		for(auto &pair : replaceIds)
+			lodInfo->meshReplacements[pair.first] = pair.second;
+		if(outAchievedRatios)
+			outAchievedRatios->push_back((baseTriangleCount > 0) ? static_cast<float>(static_cast<double>(lodTriangleCount) / static_cast<double>(baseTriangleCount)) : 1.f);
+	}
+	Update(ModelUpdateFlags::UpdatePrimitiveCounts);
+	return true;
+}
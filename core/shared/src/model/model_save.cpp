@@ -380,6 +380,26 @@ bool Model::LoadFromAssetData(Game &game, const udm::AssetData &data, std::strin
 
 	udm["baseMeshGroups"].GetBlobData(m_baseMeshes);
 
+	// LODs
+	auto udmLods = udm["lods"];
+	auto numLods = udmLods.GetSize();
+	m_lods.clear();
+	m_lods.reserve(numLods);
+	for(auto i = decltype(numLods) {0u}; i < numLods; ++i) {
+		auto udmLod = udmLods[i];
+		LODInfo lodInfo {};
+		udmLod["lod"](lodInfo.lod);
+		udmLod["distance"](lodInfo.distance);
+		std::vector<uint32_t> srcMeshGroups;
+		std::vector<uint32_t> dstMeshGroups;
+		udmLod["sourceMeshGroups"](srcMeshGroups);
+		udmLod["replacementMeshGroups"](dstMeshGroups);
+		auto numReplacements = umath::min(srcMeshGroups.size(), dstMeshGroups.size());
+		for(auto j = decltype(numReplacements) {0u}; j < numReplacements; ++j)
+			lodInfo.meshReplacements[srcMeshGroups[j]] = dstMeshGroups[j];
+		m_lods.push_back(std::move(lodInfo));
+	}
+
 	// Material groups
 	auto &texGroups = GetTextureGroups();
 	auto udmTexGroups = udm["skins"];
@@ -774,6 +794,27 @@ bool Model::Save(Game &game, udm::AssetDataArg outData, std::string &outErr)
 
 	udm["baseMeshGroups"] = m_baseMeshes;
 
+	auto &lods = GetLODs();
+	if(!lods.empty()) {
+		auto udmLods = udm.AddArray("lods", lods.size());
+		for(auto i = decltype(lods.size()) {0u}; i < lods.size(); ++i) {
+			auto &lodInfo = lods[i];
+			auto udmLod = udmLods[i];
+			udmLod["lod"] = lodInfo.lod;
+			udmLod["distance"] = lodInfo.distance;
+			std::vector<uint32_t> srcMeshGroups;
+			std::vector<uint32_t> dstMeshGroups;
+			srcMeshGroups.reserve(lodInfo.meshReplacements.size());
+			dstMeshGroups.reserve(lodInfo.meshReplacements.size());
+			for(auto &pair : lodInfo.meshReplacements) {
+				srcMeshGroups.push_back(pair.first);
+				dstMeshGroups.push_back(pair.second);
+			}
+			udmLod["sourceMeshGroups"] = srcMeshGroups;
+			udmLod["replacementMeshGroups"] = dstMeshGroups;
+		}
+	}
+
 	auto &texGroups = GetTextureGroups();
 	auto udmTexGroups = udm.AddArray("skins", texGroups.size());
 	for(auto i = decltype(texGroups.size()) {0u}; i < texGroups.size(); ++i) {
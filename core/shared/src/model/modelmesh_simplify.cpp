@@ -0,0 +1,404 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/model/modelmesh.h"
+#include <sharedutils/util_hash.hpp>
+#include <udm.hpp>
+
+// Symmetric 4x4 matrix of the quadric error metric (Garland & Heckbert), weighted by the area of the planes it has been built from
+struct SimplifyQuadric {
+	static SimplifyQuadric FromPlane(const Vector3 &n, double d, double weight)
+	{
+		SimplifyQuadric q {};
+		q.a2 = n.x * n.x * weight;
+		q.ab = n.x * n.y * weight;
+		q.ac = n.x * n.z * weight;
+		q.ad = n.x * d * weight;
+		q.b2 = n.y * n.y * weight;
+		q.bc = n.y * n.z * weight;
+		q.bd = n.y * d * weight;
+		q.c2 = n.z * n.z * weight;
+		q.cd = n.z * d * weight;
+		q.d2 = d * d * weight;
+		q.weight = weight;
+		return q;
+	}
+	SimplifyQuadric &operator+=(const SimplifyQuadric &other)
+	{
+		a2 += other.a2;
+		ab += other.ab;
+		ac += other.ac;
+		ad += other.ad;
+		b2 += other.b2;
+		bc += other.bc;
+		bd += other.bd;
+		c2 += other.c2;
+		cd += other.cd;
+		d2 += other.d2;
+		weight += other.weight;
+		return *this;
+	}
+	SimplifyQuadric operator+(const SimplifyQuadric &other) const
+	{
+		auto q = *this;
+		q += other;
+		return q;
+	}
+	// Returns the mean squared distance of p to the planes of the quadric
+	double Evaluate(const Vector3 &p) const
+	{
+		if(weight <= 0.0)
+			return 0.0;
+		double x = p.x;
+		double y = p.y;
+		double z = p.z;
+		auto err = a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) + 2.0 * (ad * x + bd * y + cd * z) + d2;
+		return umath::abs(err) / weight;
+	}
+	double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0, b2 = 0.0, bc = 0.0, bd = 0.0, c2 = 0.0, cd = 0.0, d2 = 0.0;
+	double weight = 0.0;
+};
+
+struct SimplifyPositionHash {
+	// Adding 0 turns -0 into +0, which compare equal but would have different hashes
+	size_t operator()(const Vector3 &p) const { return util::hash_combine<size_t>(util::hash_combine<size_t>(std::hash<float> {}(p.x + 0.f), std::hash<float> {}(p.y + 0.f)), std::hash<float> {}(p.z + 0.f)); }
+};
+
+// Collapse of one position into another
+struct SimplifyCollapse {
+	uint32_t from;
+	uint32_t to;
+	double cost;
+};
+
+static uint64_t get_simplify_edge_key(uint32_t posA, uint32_t posB)
+{
+	if(posA > posB)
+		std::swap(posA, posB);
+	return (static_cast<uint64_t>(posA) << 32) | posB;
+}
+
+// Open borders are weighted more than the surface, so the silhouette of the mesh is preserved as long as possible
+constexpr double SIMPLIFY_BORDER_WEIGHT = 10.0;
+// Collapses which would rotate an adjacent triangle by more than ~78 degrees are rejected
+constexpr float SIMPLIFY_MIN_NORMAL_COS = 0.2f;
+
+std::shared_ptr<ModelSubMesh> ModelSubMesh::Simplify(uint32_t targetTriangleCount, float maxError) const
+{
+	if(GetGeometryType() != GeometryType::Triangles)
+		return nullptr;
+	auto &verts = GetVertices();
+	auto numVerts = static_cast<uint32_t>(verts.size());
+	std::vector<Index32> indices;
+	GetIndices(indices);
+
+	// Vertices with the same position but different attributes (UV or normal seams) are split in the vertex data.
+	// The simplifier works on positions. Collapsing a position merges each of its vertices into the vertex at the target
+	// position it shares a triangle with, so seams can be collapsed along the seam without mixing the attributes of both sides.
+	std::vector<uint32_t> posIds(numVerts);
+	uint32_t numPositions = 0;
+	{
+		std::unordered_map<Vector3, uint32_t, SimplifyPositionHash> posToId;
+		posToId.reserve(numVerts);
+		for(auto i = decltype(numVerts) {0u}; i < numVerts; ++i)
+			posIds[i] = posToId.insert(std::make_pair(verts[i].position, static_cast<uint32_t>(posToId.size()))).first->second;
+		numPositions = static_cast<uint32_t>(posToId.size());
+	}
+	// Vertices of each position
+	std::vector<uint32_t> posVertOffsets(numPositions + 1, 0);
+	std::vector<uint32_t> posVerts(numVerts);
+	for(auto posId : posIds)
+		++posVertOffsets[posId + 1];
+	for(auto i = decltype(numPositions) {0u}; i < numPositions; ++i)
+		posVertOffsets[i + 1] += posVertOffsets[i];
+	{
+		auto offsets = posVertOffsets;
+		for(auto i = decltype(numVerts) {0u}; i < numVerts; ++i)
+			posVerts[offsets[posIds[i]]++] = i;
+	}
+
+	std::vector<SimplifyQuadric> quadrics(numPositions);
+	auto getTriangleNormal = [&verts](uint32_t i0, uint32_t i1, uint32_t i2) { return uvec::cross(verts[i1].position - verts[i0].position, verts[i2].position - verts[i0].position); };
+	for(size_t i = 0; i < indices.size(); i += 3) {
+		auto n = getTriangleNormal(indices[i], indices[i + 1], indices[i + 2]);
+		auto l = uvec::length(n);
+		if(l == 0.f)
+			continue;
+		n /= l;
+		auto &p0 = verts[indices[i]].position;
+		auto q = SimplifyQuadric::FromPlane(n, -uvec::dot(n, p0), l * 0.5f);
+		for(uint8_t j = 0; j < 3; ++j)
+			quadrics[posIds[indices[i + j]]] += q;
+	}
+
+	// Edges which are only used by one triangle, and positions which are part of such an edge
+	std::unordered_set<uint64_t> borderEdges;
+	std::vector<bool> borderPositions;
+	// Positions which are never removed, i.e. positions on non-manifold edges (more than two triangles)
+	std::vector<bool> lockedPositions(numPositions, false);
+	auto updateBorders = [&](bool addBorderQuadrics) {
+		std::unordered_map<uint64_t, uint32_t> edgeCounts;
+		edgeCounts.reserve(indices.size());
+		for(size_t i = 0; i < indices.size(); i += 3) {
+			for(uint8_t j = 0; j < 3; ++j)
+				++edgeCounts[get_simplify_edge_key(posIds[indices[i + j]], posIds[indices[i + (j + 1) % 3]])];
+		}
+		borderEdges.clear();
+		borderPositions.assign(numPositions, false);
+		for(size_t i = 0; i < indices.size(); i += 3) {
+			for(uint8_t j = 0; j < 3; ++j) {
+				auto ia = indices[i + j];
+				auto ib = indices[i + (j + 1) % 3];
+				auto posA = posIds[ia];
+				auto posB = posIds[ib];
+				auto count = edgeCounts[get_simplify_edge_key(posA, posB)];
+				if(count > 2) {
+					lockedPositions[posA] = true;
+					lockedPositions[posB] = true;
+					continue;
+				}
+				if(count != 1)
+					continue;
+				borderEdges.insert(get_simplify_edge_key(posA, posB));
+				borderPositions[posA] = true;
+				borderPositions[posB] = true;
+				if(!addBorderQuadrics)
+					continue;
+				// Plane through the edge, perpendicular to the triangle
+				auto &pa = verts[ia].position;
+				auto e = verts[ib].position - pa;
+				auto n = uvec::cross(e, getTriangleNormal(indices[i], indices[i + 1], indices[i + 2]));
+				auto l = uvec::length(n);
+				if(l == 0.f)
+					continue;
+				n /= l;
+				auto q = SimplifyQuadric::FromPlane(n, -uvec::dot(n, pa), uvec::dot(e, e) * SIMPLIFY_BORDER_WEIGHT);
+				quadrics[posA] += q;
+				quadrics[posB] += q;
+			}
+		}
+	};
+	updateBorders(true);
+
+	Vector3 min, max;
+	GetBounds(min, max);
+	auto maxErrorSqr = std::numeric_limits<double>::max();
+	if(maxError < std::numeric_limits<float>::max()) {
+		// The error is relative to the mesh extents
+		auto absError = static_cast<double>(maxError) * uvec::length(max - min);
+		maxErrorSqr = absError * absError;
+	}
+
+	auto numTris = static_cast<uint32_t>(indices.size() / 3);
+	std::vector<uint32_t> triOffsets;
+	std::vector<uint32_t> vertTris;
+	std::vector<SimplifyCollapse> collapses;
+	std::vector<bool> touched;
+	std::vector<uint32_t> candidates;
+	constexpr auto INVALID_VERTEX = std::numeric_limits<uint32_t>::max();
+	// Returns the vertex at position posTo which v would be merged into, or INVALID_VERTEX if v doesn't share a triangle with
+	// exactly one vertex at that position
+	auto findCollapseTarget = [&](uint32_t v, uint32_t posTo) {
+		auto target = INVALID_VERTEX;
+		for(auto i = triOffsets[v]; i < triOffsets[v + 1]; ++i) {
+			auto triIdx = vertTris[i] * 3;
+			for(uint8_t j = 0; j < 3; ++j) {
+				auto w = indices[triIdx + j];
+				if(posIds[w] != posTo || w == target)
+					continue;
+				if(target != INVALID_VERTEX)
+					return INVALID_VERTEX;
+				target = w;
+			}
+		}
+		return target;
+	};
+	auto isCollapseAllowed = [&](uint32_t posFrom, uint32_t posTo) {
+		if(posFrom == posTo || lockedPositions[posFrom])
+			return false;
+		// Border vertices may only move along the border
+		if(borderPositions[posFrom] && borderEdges.find(get_simplify_edge_key(posFrom, posTo)) == borderEdges.end())
+			return false;
+		// Every vertex of a seam has to have its own counterpart at the target position, otherwise the collapse would tear the
+		// mesh apart or merge vertices from different sides of the seam
+		for(auto i = posVertOffsets[posFrom]; i < posVertOffsets[posFrom + 1]; ++i) {
+			auto v = posVerts[i];
+			if(triOffsets[v] != triOffsets[v + 1] && findCollapseTarget(v, posTo) == INVALID_VERTEX)
+				return false;
+		}
+		return true;
+	};
+	while(numTris > targetTriangleCount) {
+		// Triangles adjacent to each vertex
+		triOffsets.assign(numVerts + 1, 0);
+		for(auto idx : indices)
+			++triOffsets[idx + 1];
+		for(auto i = decltype(numVerts) {0u}; i < numVerts; ++i)
+			triOffsets[i + 1] += triOffsets[i];
+		vertTris.resize(indices.size());
+		{
+			auto offsets = triOffsets;
+			for(size_t i = 0; i < indices.size(); ++i)
+				vertTris[offsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		// Cheapest collapse of each position into one of its neighbors. The cost is the error of the combined quadric of
+		// both positions at the target position.
+		collapses.clear();
+		for(auto posFrom = decltype(numPositions) {0u}; posFrom < numPositions; ++posFrom) {
+			candidates.clear();
+			for(auto i = posVertOffsets[posFrom]; i < posVertOffsets[posFrom + 1]; ++i) {
+				auto v = posVerts[i];
+				for(auto k = triOffsets[v]; k < triOffsets[v + 1]; ++k) {
+					auto triIdx = vertTris[k] * 3;
+					for(uint8_t j = 0; j < 3; ++j) {
+						auto posTo = posIds[indices[triIdx + j]];
+						if(posTo != posFrom && std::find(candidates.begin(), candidates.end(), posTo) == candidates.end())
+							candidates.push_back(posTo);
+					}
+				}
+			}
+			SimplifyCollapse best {posFrom, posFrom, std::numeric_limits<double>::max()};
+			for(auto posTo : candidates) {
+				if(!isCollapseAllowed(posFrom, posTo))
+					continue;
+				auto cost = (quadrics[posFrom] + quadrics[posTo]).Evaluate(verts[posVerts[posVertOffsets[posTo]]].position);
+				if(cost < best.cost)
+					best = {posFrom, posTo, cost};
+			}
+			if(best.to != posFrom && best.cost <= maxErrorSqr)
+				collapses.push_back(best);
+		}
+		if(collapses.empty())
+			break;
+		std::sort(collapses.begin(), collapses.end(), [](const SimplifyCollapse &a, const SimplifyCollapse &b) { return a.cost < b.cost; });
+
+		// Apply as many collapses as possible. Positions whose neighborhood has changed are skipped until the next pass,
+		// since their adjacency and the flip test would be out of date.
+		touched.assign(numPositions, false);
+		uint32_t numRemoved = 0;
+		uint32_t numCollapses = 0;
+		std::vector<std::pair<uint32_t, uint32_t>> vertCollapses;
+		for(auto &collapse : collapses) {
+			if(numTris - numRemoved <= targetTriangleCount)
+				break;
+			if(touched[collapse.from] || touched[collapse.to])
+				continue;
+			auto &posTo = verts[posVerts[posVertOffsets[collapse.to]]].position;
+			vertCollapses.clear();
+			uint32_t numRemovedByCollapse = 0;
+			auto flipped = false;
+			for(auto k = posVertOffsets[collapse.from]; k < posVertOffsets[collapse.from + 1] && !flipped; ++k) {
+				auto from = posVerts[k];
+				if(triOffsets[from] == triOffsets[from + 1])
+					continue;
+				auto to = findCollapseTarget(from, collapse.to);
+				vertCollapses.push_back({from, to});
+				for(auto i = triOffsets[from]; i < triOffsets[from + 1]; ++i) {
+					auto triIdx = vertTris[i] * 3;
+					auto i0 = indices[triIdx];
+					auto i1 = indices[triIdx + 1];
+					auto i2 = indices[triIdx + 2];
+					if(i0 == to || i1 == to || i2 == to) {
+						++numRemovedByCollapse;
+						continue;
+					}
+					std::array<Vector3, 3> positions {verts[i0].position, verts[i1].position, verts[i2].position};
+					auto nOld = uvec::cross(positions[1] - positions[0], positions[2] - positions[0]);
+					for(uint8_t j = 0; j < 3; ++j) {
+						if(indices[triIdx + j] == from)
+							positions[j] = posTo;
+					}
+					auto nNew = uvec::cross(positions[1] - positions[0], positions[2] - positions[0]);
+					if(uvec::dot(nOld, nNew) <= SIMPLIFY_MIN_NORMAL_COS * uvec::length(nOld) * uvec::length(nNew)) {
+						flipped = true;
+						break;
+					}
+				}
+			}
+			if(flipped)
+				continue;
+			for(auto &[from, to] : vertCollapses) {
+				for(auto i = triOffsets[from]; i < triOffsets[from + 1]; ++i) {
+					auto triIdx = vertTris[i] * 3;
+					for(uint8_t j = 0; j < 3; ++j) {
+						auto &idx = indices[triIdx + j];
+						touched[posIds[idx]] = true;
+						if(idx == from)
+							idx = to;
+					}
+				}
+			}
+			quadrics[collapse.to] += quadrics[collapse.from];
+			numRemoved += numRemovedByCollapse;
+			++numCollapses;
+		}
+		if(numCollapses == 0)
+			break;
+
+		// Remove the triangles which have become degenerate
+		size_t numIndices = 0;
+		for(size_t i = 0; i < indices.size(); i += 3) {
+			auto i0 = indices[i];
+			auto i1 = indices[i + 1];
+			auto i2 = indices[i + 2];
+			if(i0 == i1 || i1 == i2 || i0 == i2)
+				continue;
+			indices[numIndices++] = i0;
+			indices[numIndices++] = i1;
+			indices[numIndices++] = i2;
+		}
+		indices.resize(numIndices);
+		numTris = static_cast<uint32_t>(indices.size() / 3);
+		updateBorders(false);
+	}
+
+	// Remove all vertices which aren't referenced anymore
+	std::vector<uint32_t> newVertIndices(numVerts, std::numeric_limits<uint32_t>::max());
+	std::vector<uint32_t> usedVerts;
+	usedVerts.reserve(numVerts);
+	for(auto &idx : indices) {
+		auto &newIdx = newVertIndices[idx];
+		if(newIdx == std::numeric_limits<uint32_t>::max()) {
+			newIdx = static_cast<uint32_t>(usedVerts.size());
+			usedVerts.push_back(idx);
+		}
+		idx = newIdx;
+	}
+	auto compact = [&usedVerts, numVerts](auto &data) {
+		if(data.size() != numVerts)
+			return;
+		std::remove_reference_t<decltype(data)> newData;
+		newData.reserve(usedVerts.size());
+		for(auto idx : usedVerts)
+			newData.push_back(data[idx]);
+		data = std::move(newData);
+	};
+
+	auto mesh = Copy(true);
+	// The simplified mesh is a new mesh and the extension data (e.g. lightmap data) refers to the geometry of the original one
+	mesh->SetUuid(util::generate_uuid_v4());
+	mesh->m_extensions = udm::Property::Create(udm::Type::Element);
+	compact(mesh->GetVertices());
+	compact(mesh->GetAlphas());
+	compact(mesh->GetVertexWeights());
+	compact(mesh->GetExtendedVertexWeights());
+	for(auto &pair : mesh->GetUVSets())
+		compact(pair.second);
+	if(usedVerts.size() < MAX_INDEX16) {
+		std::vector<Index16> indices16;
+		indices16.reserve(indices.size());
+		for(auto idx : indices)
+			indices16.push_back(static_cast<Index16>(idx));
+		mesh->SetIndices(indices16);
+	}
+	else
+		mesh->SetIndices(indices);
+	mesh->Update(ModelUpdateFlags::UpdateBounds | ModelUpdateFlags::UpdatePrimitiveCounts);
+	return mesh;
+}
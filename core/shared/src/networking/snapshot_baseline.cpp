@@ -0,0 +1,225 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/networking/snapshot_baseline.hpp"
+
+// Every field is described by two bits in the field mask
+enum class FieldEncoding : uint8_t {
+	Unchanged = 0u,
+	Delta8,
+	Delta16,
+	Absolute,
+};
+static constexpr uint32_t FIELD_POSITION = 0u;
+static constexpr uint32_t FIELD_VELOCITY = 1u;
+static constexpr uint32_t FIELD_ANGULAR_VELOCITY = 2u;
+static constexpr uint32_t FIELD_ROTATION = 3u;
+
+static int32_t quantize(float v, float precision)
+{
+	auto q = std::llround(static_cast<double>(v) / static_cast<double>(precision));
+	return static_cast<int32_t>(std::clamp<long long>(q, std::numeric_limits<int32_t>::lowest(), std::numeric_limits<int32_t>::max()));
+}
+
+template<typename T, size_t N>
+static FieldEncoding get_field_encoding(const std::array<T, N> &values, const std::array<T, N> &base)
+{
+	int64_t maxDelta = 0;
+	for(auto i = decltype(N) {0u}; i < N; ++i)
+		maxDelta = std::max(maxDelta, std::abs(static_cast<int64_t>(values[i]) - static_cast<int64_t>(base[i])));
+	if(maxDelta == 0)
+		return FieldEncoding::Unchanged;
+	if(maxDelta <= std::numeric_limits<int8_t>::max())
+		return FieldEncoding::Delta8;
+	if(maxDelta <= std::numeric_limits<int16_t>::max())
+		return FieldEncoding::Delta16;
+	return FieldEncoding::Absolute;
+}
+
+template<typename T, size_t N>
+static void write_field(NetPacket &packet, FieldEncoding encoding, const std::array<T, N> &values, const std::array<T, N> &base)
+{
+	for(auto i = decltype(N) {0u}; i < N; ++i) {
+		auto delta = static_cast<int64_t>(values[i]) - static_cast<int64_t>(base[i]);
+		switch(encoding) {
+		case FieldEncoding::Unchanged:
+			break;
+		case FieldEncoding::Delta8:
+			packet->Write<int8_t>(static_cast<int8_t>(delta));
+			break;
+		case FieldEncoding::Delta16:
+			packet->Write<int16_t>(static_cast<int16_t>(delta));
+			break;
+		case FieldEncoding::Absolute:
+			packet->Write<T>(values[i]);
+			break;
+		}
+	}
+}
+
+template<typename T, size_t N>
+static void read_field(NetPacket &packet, FieldEncoding encoding, std::array<T, N> &values, const std::array<T, N> &base)
+{
+	for(auto i = decltype(N) {0u}; i < N; ++i) {
+		switch(encoding) {
+		case FieldEncoding::Unchanged:
+			values[i] = base[i];
+			break;
+		case FieldEncoding::Delta8:
+			values[i] = static_cast<T>(static_cast<int64_t>(base[i]) + packet->Read<int8_t>());
+			break;
+		case FieldEncoding::Delta16:
+			values[i] = static_cast<T>(static_cast<int64_t>(base[i]) + packet->Read<int16_t>());
+			break;
+		case FieldEncoding::Absolute:
+			values[i] = packet->Read<T>();
+			break;
+		}
+	}
+}
+
+static Vector3 dequantize(const std::array<int32_t, 3> &v, float precision) { return Vector3 {v[0] * precision, v[1] * precision, v[2] * precision}; }
+static std::array<int32_t, 3> quantize(const Vector3 &v, float precision) { return {quantize(v.x, precision), quantize(v.y, precision), quantize(v.z, precision)}; }
+
+pragma::networking::SnapshotObjectState pragma::networking::SnapshotObjectState::Quantize(const Vector3 &pos, const Vector3 &vel, const Vector3 &angVel, const Quat &rot)
+{
+	SnapshotObjectState state {};
+	state.position = ::quantize(pos, POSITION_PRECISION);
+	state.velocity = ::quantize(vel, VELOCITY_PRECISION);
+	state.angularVelocity = ::quantize(angVel, ANGULAR_VELOCITY_PRECISION);
+	auto n = uquat::get_normal(rot);
+	constexpr auto scale = static_cast<float>(std::numeric_limits<int16_t>::max());
+	state.rotation = {static_cast<int16_t>(std::lroundf(n.w * scale)), static_cast<int16_t>(std::lroundf(n.x * scale)), static_cast<int16_t>(std::lroundf(n.y * scale)), static_cast<int16_t>(std::lroundf(n.z * scale))};
+	return state;
+}
+Vector3 pragma::networking::SnapshotObjectState::GetPosition() const { return ::dequantize(position, POSITION_PRECISION); }
+Vector3 pragma::networking::SnapshotObjectState::GetVelocity() const { return ::dequantize(velocity, VELOCITY_PRECISION); }
+Vector3 pragma::networking::SnapshotObjectState::GetAngularVelocity() const { return ::dequantize(angularVelocity, ANGULAR_VELOCITY_PRECISION); }
+Quat pragma::networking::SnapshotObjectState::GetRotation() const
+{
+	constexpr auto scale = 1.f / static_cast<float>(std::numeric_limits<int16_t>::max());
+	Quat rot {rotation[0] * scale, rotation[1] * scale, rotation[2] * scale, rotation[3] * scale};
+	if(uquat::length_sqr(rot) == 0.f)
+		return uquat::identity();
+	return uquat::get_normal(rot);
+}
+
+void pragma::networking::SnapshotObjectState::WriteDelta(NetPacket &packet, const SnapshotObjectState *base) const
+{
+	static const SnapshotObjectState zero {};
+	auto &baseState = base ? *base : zero;
+	std::array<FieldEncoding, 4> encodings {get_field_encoding(position, baseState.position), get_field_encoding(velocity, baseState.velocity), get_field_encoding(angularVelocity, baseState.angularVelocity), get_field_encoding(rotation, baseState.rotation)};
+	uint8_t mask = 0;
+	for(auto i = decltype(encodings.size()) {0u}; i < encodings.size(); ++i)
+		mask |= umath::to_integral(encodings[i]) << (i * 2);
+	packet->Write<uint8_t>(mask);
+	write_field(packet, encodings[FIELD_POSITION], position, baseState.position);
+	write_field(packet, encodings[FIELD_VELOCITY], velocity, baseState.velocity);
+	write_field(packet, encodings[FIELD_ANGULAR_VELOCITY], angularVelocity, baseState.angularVelocity);
+	write_field(packet, encodings[FIELD_ROTATION], rotation, baseState.rotation);
+}
+pragma::networking::SnapshotObjectState pragma::networking::SnapshotObjectState::ReadDelta(NetPacket &packet, const SnapshotObjectState *base)
+{
+	static const SnapshotObjectState zero {};
+	auto &baseState = base ? *base : zero;
+	auto mask = packet->Read<uint8_t>();
+	auto getEncoding = [mask](uint32_t field) { return static_cast<FieldEncoding>((mask >> (field * 2)) & 3u); };
+	SnapshotObjectState state {};
+	read_field(packet, getEncoding(FIELD_POSITION), state.position, baseState.position);
+	read_field(packet, getEncoding(FIELD_VELOCITY), state.velocity, baseState.velocity);
+	read_field(packet, getEncoding(FIELD_ANGULAR_VELOCITY), state.angularVelocity, baseState.angularVelocity);
+	read_field(packet, getEncoding(FIELD_ROTATION), state.rotation, baseState.rotation);
+	return state;
+}
+
+const pragma::networking::SnapshotObjectState *pragma::networking::SnapshotEntityState::FindPhysicsObject(size_t idx) const { return (idx < physicsObjects.size()) ? &physicsObjects[idx] : nullptr; }
+
+const pragma::networking::SnapshotEntityState *pragma::networking::SnapshotBaseline::FindEntity(uint32_t entIdx) const
+{
+	auto it = entities.find(entIdx);
+	return (it != entities.end()) ? &it->second : nullptr;
+}
+
+pragma::networking::SnapshotBaseline *pragma::networking::SnapshotBaselineRing::Find(uint8_t snapshotId)
+{
+	auto &baseline = m_baselines[snapshotId % BASELINE_COUNT];
+	return (baseline.valid && baseline.snapshotId == snapshotId) ? &baseline : nullptr;
+}
+const pragma::networking::SnapshotBaseline *pragma::networking::SnapshotBaselineRing::Find(uint8_t snapshotId) const
+{
+	auto &baseline = m_baselines[snapshotId % BASELINE_COUNT];
+	return (baseline.valid && baseline.snapshotId == snapshotId) ? &baseline : nullptr;
+}
+void pragma::networking::SnapshotBaselineRing::Store(SnapshotBaseline &&baseline)
+{
+	auto idx = baseline.snapshotId % BASELINE_COUNT;
+	m_baselines[idx] = std::move(baseline);
+	m_baselines[idx].valid = true;
+}
+void pragma::networking::SnapshotBaselineRing::RemoveEntity(uint32_t entIdx)
+{
+	for(auto &baseline : m_baselines)
+		baseline.entities.erase(entIdx);
+}
+void pragma::networking::SnapshotBaselineRing::Clear()
+{
+	for(auto &baseline : m_baselines) {
+		baseline.valid = false;
+		baseline.entities.clear();
+	}
+}
+
+void pragma::networking::SnapshotAcknowledgedStates::Acknowledge(SnapshotBaseline &baseline)
+{
+	if(baseline.acknowledged)
+		return;
+	baseline.acknowledged = true;
+	// Acknowledgements are transmitted unreliably and may arrive out of order
+	for(auto &[entIdx, entState] : baseline.entities) {
+		auto &state = m_entities[entIdx];
+		if(state.snapshotIndex > baseline.snapshotIndex)
+			continue;
+		state.snapshotIndex = baseline.snapshotIndex;
+		state.state = std::move(entState);
+	}
+	baseline.entities.clear();
+}
+const pragma::networking::SnapshotEntityState *pragma::networking::SnapshotAcknowledgedStates::FindBase(uint32_t entIdx, uint64_t snapshotIndex, uint8_t &outAge) const
+{
+	auto it = m_entities.find(entIdx);
+	if(it == m_entities.end() || it->second.snapshotIndex >= snapshotIndex)
+		return nullptr;
+	// The client only keeps the states of the last BASELINE_COUNT snapshots
+	auto age = snapshotIndex - it->second.snapshotIndex;
+	if(age >= SnapshotBaselineRing::BASELINE_COUNT)
+		return nullptr;
+	outAge = static_cast<uint8_t>(age);
+	return &it->second.state;
+}
+void pragma::networking::SnapshotAcknowledgedStates::RemoveEntity(uint32_t entIdx) { m_entities.erase(entIdx); }
+void pragma::networking::SnapshotAcknowledgedStates::Clear() { m_entities.clear(); }
+
+const pragma::networking::SnapshotEntityState *pragma::networking::SnapshotEntityHistory::Find(uint32_t entIdx, uint8_t snapshotId) const
+{
+	auto it = m_entities.find(entIdx);
+	if(it == m_entities.end())
+		return nullptr;
+	auto &entries = it->second;
+	auto itEntry = std::find_if(entries.begin(), entries.end(), [snapshotId](const Entry &entry) { return entry.snapshotId == snapshotId; });
+	return (itEntry != entries.end()) ? &itEntry->state : nullptr;
+}
+void pragma::networking::SnapshotEntityHistory::Store(uint32_t entIdx, uint8_t snapshotId, SnapshotEntityState &&state)
+{
+	// States that are older than BASELINE_COUNT snapshots will never be referenced by the server again.
+	// Snapshot ids wrap around, so this also discards states with the same id from an earlier cycle.
+	auto &entries = m_entities[entIdx];
+	entries.erase(std::remove_if(entries.begin(), entries.end(), [snapshotId](const Entry &entry) { return static_cast<uint8_t>(snapshotId - entry.snapshotId) >= SnapshotBaselineRing::BASELINE_COUNT || entry.snapshotId == snapshotId; }), entries.end());
+	entries.push_back({snapshotId, std::move(state)});
+}
+void pragma::networking::SnapshotEntityHistory::RemoveEntity(uint32_t entIdx) { m_entities.erase(entIdx); }
+void pragma::networking::SnapshotEntityHistory::Clear() { m_entities.clear(); }
@@ -16,6 +16,7 @@
 #include "pragma/entities/baseentity.h"
 #include "pragma/physics/physobj.h"
 #include "pragma/physics/raytraces.h"
+#include "pragma/physics/trace_batch.hpp"
 #include "pragma/physics/raycallback/physraycallbackfilter.hpp"
 #include "pragma/audio/alsound_type.h"
 #include "pragma/model/modelmesh.h"
@@ -25,6 +26,8 @@
 #include "pragma/physics/physsoftbodyinfo.hpp"
 #include "pragma/entities/components/base_physics_component.hpp"
 #include "pragma/entities/trigger/base_trigger_touch.hpp"
+#include "pragma/util/job_system.hpp"
+#include "pragma/engine.h"
 
 std::vector<std::string> pragma::physics::IEnvironment::GetAvailablePhysicsEngines()
 {
@@ -263,6 +266,44 @@ pragma::physics::IEnvironment::RemainingDeltaTime pragma::physics::IEnvironment:
 	return DoStepSimulation(timeStep, maxSubSteps, fixedTimeStep);
 }
 
+Bool pragma::physics::IEnvironment::ExecuteQuery(TraceQueryType type, const TraceData &data, std::vector<TraceResult> *optOutResults) const
+{
+	switch(type) {
+	case TraceQueryType::Overlap:
+		return Overlap(data, optOutResults);
+	case TraceQueryType::RayCast:
+		return RayCast(data, optOutResults);
+	case TraceQueryType::Sweep:
+		return Sweep(data, optOutResults);
+	}
+	return false;
+}
+
+void pragma::physics::IEnvironment::DoTraceBatch(TraceQueryType type, TraceBatch &batch, TraceBatchFlags flags) const
+{
+	auto numQueries = batch.GetQueryCount();
+	auto executeRange = [this, type, &batch](uint32_t start, uint32_t end) {
+		for(auto i = start; i < end; ++i)
+			batch.SetHit(i, ExecuteQuery(type, batch.GetQuery(i), &batch.GetResults(i)));
+	};
+	constexpr uint32_t QUERIES_PER_JOB = 16;
+	if(!umath::is_flag_set(flags, TraceBatchFlags::Parallel) || numQueries <= QUERIES_PER_JOB) {
+		executeRange(0, numQueries);
+		return;
+	}
+	auto &jobSystem = pragma::get_engine()->GetJobSystem();
+	pragma::JobCounter counter {};
+	for(uint32_t start = 0; start < numQueries; start += QUERIES_PER_JOB) {
+		auto end = umath::min(start + QUERIES_PER_JOB, numQueries);
+		jobSystem.Schedule([&executeRange, start, end]() { executeRange(start, end); }, &counter);
+	}
+	jobSystem.Wait(counter);
+}
+
+void pragma::physics::IEnvironment::OverlapBatch(TraceBatch &batch, TraceBatchFlags flags) const { DoTraceBatch(TraceQueryType::Overlap, batch, flags); }
+void pragma::physics::IEnvironment::RayCastBatch(TraceBatch &batch, TraceBatchFlags flags) const { DoTraceBatch(TraceQueryType::RayCast, batch, flags); }
+void pragma::physics::IEnvironment::SweepBatch(TraceBatch &batch, TraceBatchFlags flags) const { DoTraceBatch(TraceQueryType::Sweep, batch, flags); }
+
 bool PhysSoftBodyInfo::operator==(const PhysSoftBodyInfo &other) const
 {
 	return poseMatchingCoefficient == other.poseMatchingCoefficient && anchorsHardness == other.anchorsHardness && dragCoefficient == other.dragCoefficient && rigidContactsHardness == other.rigidContactsHardness && softContactsHardness == other.softContactsHardness
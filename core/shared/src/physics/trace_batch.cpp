@@ -0,0 +1,34 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/physics/trace_batch.hpp"
+
+void pragma::physics::TraceBatch::Reserve(uint32_t numQueries)
+{
+	m_queries.reserve(numQueries);
+	m_results.reserve(numQueries);
+	m_hits.reserve(numQueries);
+}
+
+void pragma::physics::TraceBatch::Clear() { m_numQueries = 0; }
+
+uint32_t pragma::physics::TraceBatch::AddQuery(const TraceData &data)
+{
+	auto idx = m_numQueries++;
+	if(idx < m_queries.size()) {
+		// Re-use the storage of a previous query
+		m_queries[idx] = data;
+		m_results[idx].clear();
+		m_hits[idx] = 0;
+		return idx;
+	}
+	m_queries.push_back(data);
+	m_results.push_back({});
+	m_hits.push_back(0);
+	return idx;
+}
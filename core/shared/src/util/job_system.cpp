@@ -0,0 +1,401 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/util/job_system.hpp"
+
+struct pragma::JobSystem::Job {
+	// Counter of the job tree this job belongs to. Parents can't complete before their children, so the chain is always valid.
+	JobCounter *GetRootCounter() const
+	{
+		auto *job = this;
+		while(job->parent)
+			job = job->parent;
+		return job->counter;
+	}
+	Function function;
+	Job *parent = nullptr;
+	JobCounter *counter = nullptr;
+	// The job itself plus the number of child jobs that haven't completed yet
+	std::atomic<uint32_t> unfinished = 1;
+	// Jobs from the job pool are returned to the pool instead of being deleted
+	bool pooled = false;
+};
+
+// Chase-Lev deque. Only the owning worker may push and pop (from the bottom), any thread may steal (from the top).
+class pragma::JobSystem::WorkStealingQueue {
+  public:
+	static constexpr int64_t CAPACITY = 4'096;
+	static_assert((CAPACITY & (CAPACITY - 1)) == 0);
+	bool Push(Job *job)
+	{
+		auto b = m_bottom.load(std::memory_order_relaxed);
+		auto t = m_top.load(std::memory_order_acquire);
+		if(b - t >= CAPACITY)
+			return false;
+		m_jobs[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+	Job *Pop()
+	{
+		auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+		m_bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto t = m_top.load(std::memory_order_relaxed);
+		if(t > b) {
+			m_bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		auto *job = m_jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if(t == b) {
+			// Last item, race against stealing threads
+			if(!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			m_bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+	Job *Steal()
+	{
+		auto t = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto b = m_bottom.load(std::memory_order_acquire);
+		if(t >= b)
+			return nullptr;
+		auto *job = m_jobs[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if(!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return job;
+	}
+  private:
+	alignas(64) std::atomic<int64_t> m_top = 0;
+	alignas(64) std::atomic<int64_t> m_bottom = 0;
+	std::array<std::atomic<Job *>, CAPACITY> m_jobs {};
+};
+
+// Bounded multi-producer/multi-consumer queue (Vyukov). Used for jobs scheduled from threads that aren't workers, and as free list of the job pool.
+class pragma::JobSystem::JobQueue {
+  public:
+	static constexpr size_t CAPACITY = 4'096;
+	static_assert((CAPACITY & (CAPACITY - 1)) == 0);
+	JobQueue()
+	{
+		for(auto i = decltype(CAPACITY) {0u}; i < CAPACITY; ++i)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	bool Push(Job *job)
+	{
+		auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+		for(;;) {
+			auto &cell = m_cells[pos & (CAPACITY - 1)];
+			auto seq = cell.sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+			if(diff == 0) {
+				if(m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.job = job;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if(diff < 0)
+				return false; // Full
+			else
+				pos = m_enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	Job *Pop()
+	{
+		auto pos = m_dequeuePos.load(std::memory_order_relaxed);
+		for(;;) {
+			auto &cell = m_cells[pos & (CAPACITY - 1)];
+			auto seq = cell.sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+			if(diff == 0) {
+				if(m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					auto *job = cell.job;
+					cell.sequence.store(pos + CAPACITY, std::memory_order_release);
+					return job;
+				}
+			}
+			else if(diff < 0)
+				return nullptr; // Empty
+			else
+				pos = m_dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+  private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		Job *job = nullptr;
+	};
+	std::array<Cell, CAPACITY> m_cells;
+	alignas(64) std::atomic<size_t> m_enqueuePos = 0;
+	alignas(64) std::atomic<size_t> m_dequeuePos = 0;
+};
+
+struct pragma::JobSystem::Worker {
+	WorkStealingQueue queue;
+	std::thread thread;
+};
+
+static thread_local const pragma::JobSystem *g_currentJobSystem = nullptr;
+static thread_local uint32_t g_currentWorkerIndex = pragma::JobSystem::INVALID_WORKER_INDEX;
+static thread_local void *g_currentJob = nullptr;
+
+// Maximum number of jobs of other threads that are skipped in the injection queue while looking for a job to help with
+static constexpr uint32_t MAX_INJECTION_QUEUE_SCAN = 16;
+
+pragma::JobSystem::JobSystem(uint32_t numWorkers, const std::string &name) : m_injectionQueue {std::make_unique<JobQueue>()}, m_jobPool {std::make_unique<Job[]>(JobQueue::CAPACITY)}, m_freeJobs {std::make_unique<JobQueue>()}
+{
+	for(auto i = decltype(JobQueue::CAPACITY) {0u}; i < JobQueue::CAPACITY; ++i) {
+		auto &job = m_jobPool[i];
+		job.pooled = true;
+		m_freeJobs->Push(&job);
+	}
+	numWorkers = std::max(numWorkers, 1u);
+	m_workers.reserve(numWorkers);
+	for(auto i = decltype(numWorkers) {0u}; i < numWorkers; ++i)
+		m_workers.push_back(std::make_unique<Worker>());
+	// All workers have to exist before any of them can start stealing
+	for(auto i = decltype(numWorkers) {0u}; i < numWorkers; ++i) {
+		auto &worker = *m_workers[i];
+		worker.thread = std::thread {[this, i]() { RunWorker(i); }};
+		util::set_thread_name(worker.thread, "job_" + name);
+	}
+}
+
+pragma::JobSystem::~JobSystem()
+{
+	m_running = false;
+	m_wakeEpoch.fetch_add(1);
+	m_wakeEpoch.notify_all();
+	for(auto &worker : m_workers) {
+		if(worker->thread.joinable())
+			worker->thread.join();
+	}
+	// Execute whatever may still be left over, so that no counter is left pending
+	while(auto *job = FindJob(INVALID_WORKER_INDEX))
+		Execute(job);
+}
+
+uint32_t pragma::JobSystem::GetCurrentWorkerIndex() const { return (g_currentJobSystem == this) ? g_currentWorkerIndex : INVALID_WORKER_INDEX; }
+
+pragma::JobSystem::Job *pragma::JobSystem::AllocateJob(Function &&f)
+{
+	auto *job = m_freeJobs->Pop();
+	if(!job)
+		job = new Job {}; // The pool is exhausted
+	job->function = std::move(f);
+	job->parent = nullptr;
+	job->counter = nullptr;
+	job->unfinished.store(1, std::memory_order_relaxed);
+	return job;
+}
+
+void pragma::JobSystem::FreeJob(Job *job)
+{
+	// Release the captured state right away, not when the job is re-used
+	job->function = nullptr;
+	if(!job->pooled) {
+		delete job;
+		return;
+	}
+	m_freeJobs->Push(job);
+}
+
+void pragma::JobSystem::Schedule(Function f, JobCounter *counter)
+{
+	auto *job = AllocateJob(std::move(f));
+	job->counter = counter;
+	if(counter)
+		counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+	Submit(job);
+}
+
+void pragma::JobSystem::ScheduleChild(Function f)
+{
+	auto *parent = (g_currentJobSystem == this) ? static_cast<Job *>(g_currentJob) : nullptr;
+	auto *job = AllocateJob(std::move(f));
+	job->parent = parent;
+	if(parent)
+		parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+	Submit(job);
+}
+
+void pragma::JobSystem::Submit(Job *job)
+{
+	auto workerIdx = GetCurrentWorkerIndex();
+	auto pushed = (workerIdx != INVALID_WORKER_INDEX) ? m_workers[workerIdx]->queue.Push(job) : m_injectionQueue->Push(job);
+	if(!pushed) {
+		// Queue is full, execute the job immediately instead
+		Execute(job);
+		return;
+	}
+	WakeWorkers();
+}
+
+void pragma::JobSystem::WakeWorkers()
+{
+	m_wakeEpoch.fetch_add(1);
+	if(m_numSleepingWorkers.load() > 0)
+		m_wakeEpoch.notify_one();
+}
+
+pragma::JobSystem::Job *pragma::JobSystem::FindJob(uint32_t workerIdx)
+{
+	if(workerIdx != INVALID_WORKER_INDEX) {
+		if(auto *job = m_workers[workerIdx]->queue.Pop())
+			return job;
+	}
+	if(auto *job = m_injectionQueue->Pop())
+		return job;
+	// Start with the neighbor to avoid all threads stealing from the same worker
+	auto numWorkers = static_cast<uint32_t>(m_workers.size());
+	auto start = (workerIdx != INVALID_WORKER_INDEX) ? (workerIdx + 1) : 0u;
+	for(auto i = decltype(numWorkers) {0u}; i < numWorkers; ++i) {
+		auto victimIdx = (start + i) % numWorkers;
+		if(victimIdx == workerIdx)
+			continue;
+		if(auto *job = m_workers[victimIdx]->queue.Steal())
+			return job;
+	}
+	return nullptr;
+}
+
+pragma::JobSystem::Job *pragma::JobSystem::FindJob(uint32_t workerIdx, const JobCounter &counter, bool &outHasOtherJobs)
+{
+	// Jobs in the worker's own queue were scheduled from this thread, so executing them doesn't break thread affinity
+	if(workerIdx != INVALID_WORKER_INDEX) {
+		if(auto *job = m_workers[workerIdx]->queue.Pop())
+			return job;
+	}
+	// Jobs of other threads are only executed if they belong to the counter, everything else is put back into the queue
+	for(auto i = decltype(MAX_INJECTION_QUEUE_SCAN) {0u}; i < MAX_INJECTION_QUEUE_SCAN; ++i) {
+		auto *job = m_injectionQueue->Pop();
+		if(!job)
+			return nullptr;
+		if(job->GetRootCounter() == &counter)
+			return job;
+		outHasOtherJobs = true;
+		if(!m_injectionQueue->Push(job))
+			return job; // The queue has been filled up in the meantime, so the job has to be executed here
+		WakeWorkers();
+	}
+	return nullptr;
+}
+
+void pragma::JobSystem::Execute(Job *job)
+{
+	auto *prevJobSystem = g_currentJobSystem;
+	auto *prevJob = g_currentJob;
+	auto prevWorkerIdx = g_currentWorkerIndex;
+	if(prevJobSystem != this) {
+		// Jobs executed by a non-worker thread (e.g. while waiting) still need to be able to schedule child jobs
+		g_currentJobSystem = this;
+		g_currentWorkerIndex = INVALID_WORKER_INDEX;
+	}
+	g_currentJob = job;
+	try {
+		job->function();
+	}
+	catch(...) {
+		// The exception is rethrown by whoever is waiting for the job. The job still has to be completed, otherwise the waiting thread would never wake up.
+		auto *counter = job->GetRootCounter();
+		if(counter) {
+			if(!counter->m_hasException.exchange(true, std::memory_order_acq_rel))
+				counter->m_exception = std::current_exception();
+		}
+		else
+			Con::cwar << "Unhandled exception in job that has no job counter! Ignoring..." << Con::endl;
+	}
+	g_currentJob = prevJob;
+	g_currentJobSystem = prevJobSystem;
+	g_currentWorkerIndex = prevWorkerIdx;
+	Finish(job);
+}
+
+void pragma::JobSystem::Finish(Job *job)
+{
+	while(job) {
+		if(job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return;
+		auto *parent = job->parent;
+		if(auto *counter = job->counter) {
+			// Note: The counter may be destroyed by a waiting thread as soon as it has reached zero, so
+			// waiters are notified through the job system instead.
+			if(counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				m_completionEpoch.fetch_add(1);
+				m_completionEpoch.notify_all();
+			}
+		}
+		FreeJob(job);
+		job = parent;
+	}
+}
+
+void pragma::JobSystem::Wait(JobCounter &counter)
+{
+	auto workerIdx = GetCurrentWorkerIndex();
+	for(;;) {
+		auto epoch = m_completionEpoch.load();
+		if(counter.IsComplete())
+			break;
+		auto hasOtherJobs = false;
+		if(auto *job = FindJob(workerIdx, counter, hasOtherJobs)) {
+			Execute(job);
+			continue;
+		}
+		if(hasOtherJobs) {
+			// Jobs of the counter may still be queued behind jobs of other threads
+			std::this_thread::yield();
+			continue;
+		}
+		// Nothing left to help with, the remaining jobs are already being executed
+		m_completionEpoch.wait(epoch);
+	}
+	if(counter.m_hasException.load(std::memory_order_acquire)) {
+		auto exception = counter.m_exception;
+		counter.m_exception = nullptr;
+		counter.m_hasException = false;
+		std::rethrow_exception(exception);
+	}
+}
+
+void pragma::JobSystem::RunWorker(uint32_t workerIdx)
+{
+	g_currentJobSystem = this;
+	g_currentWorkerIndex = workerIdx;
+	constexpr uint32_t NUM_SPIN_ITERATIONS = 64;
+	uint32_t numIdleIterations = 0;
+	while(m_running.load(std::memory_order_relaxed)) {
+		if(auto *job = FindJob(workerIdx)) {
+			Execute(job);
+			numIdleIterations = 0;
+			continue;
+		}
+		if(++numIdleIterations < NUM_SPIN_ITERATIONS) {
+			std::this_thread::yield();
+			continue;
+		}
+		// The epoch has to be read before checking for work one last time, otherwise a wake-up
+		// that happens in between could be missed
+		++m_numSleepingWorkers;
+		auto epoch = m_wakeEpoch.load();
+		if(auto *job = FindJob(workerIdx)) {
+			--m_numSleepingWorkers;
+			Execute(job);
+			numIdleIterations = 0;
+			continue;
+		}
+		if(m_running.load(std::memory_order_relaxed))
+			m_wakeEpoch.wait(epoch);
+		--m_numSleepingWorkers;
+		numIdleIterations = 0;
+	}
+}
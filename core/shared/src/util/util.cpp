@@ -172,6 +172,27 @@ Bool Game::Sweep(const TraceData &data, std::vector<TraceResult> *optOutResults)
 		return false;
 	return physEnv->Sweep(data, optOutResults);
 }
+void Game::OverlapBatch(pragma::physics::TraceBatch &batch, pragma::physics::TraceBatchFlags flags) const
+{
+	auto *physEnv = GetPhysicsEnvironment();
+	if(physEnv == nullptr)
+		return;
+	physEnv->OverlapBatch(batch, flags);
+}
+void Game::RayCastBatch(pragma::physics::TraceBatch &batch, pragma::physics::TraceBatchFlags flags) const
+{
+	auto *physEnv = GetPhysicsEnvironment();
+	if(physEnv == nullptr)
+		return;
+	physEnv->RayCastBatch(batch, flags);
+}
+void Game::SweepBatch(pragma::physics::TraceBatch &batch, pragma::physics::TraceBatchFlags flags) const
+{
+	auto *physEnv = GetPhysicsEnvironment();
+	if(physEnv == nullptr)
+		return;
+	physEnv->SweepBatch(batch, flags);
+}
 TraceResult Game::Overlap(const TraceData &data) const
 {
 	std::vector<TraceResult> results {};